@@ -1,5 +1,5 @@
 #include "Asm6502.h"
-#include <algorithm>
+#include "Kpatch.h"
 #include <cassert>
 #include <format>
 #include <stdexcept>
@@ -540,14 +540,12 @@ void klib::Asm6502::dw(word p_word) {
 	emit_word(p_word);
 }
 
-void klib::Asm6502::apply_hack(std::vector<byte>& p_rom, byte p_bank_no,
+void klib::Asm6502::apply_hack(klib::RomImage& p_rom, byte p_bank_no,
 	word p_cpu_addr, word p_cpu_min_addr) const {
-	const std::size_t file_offset = get_file_offset(p_bank_no, p_cpu_addr, p_cpu_min_addr);
-	assert(file_offset + m_bytes.size() <= p_rom.size());
-	std::copy(m_bytes.begin(), m_bytes.end(), p_rom.begin() + file_offset);
+	klib::patch::write(p_rom, get_file_offset(p_bank_no, p_cpu_addr, p_cpu_min_addr), m_bytes);
 }
 
-std::size_t klib::Asm6502::apply_hack_and_clear(std::vector<byte>& p_rom, byte p_bank_no,
+std::size_t klib::Asm6502::apply_hack_and_clear(klib::RomImage& p_rom, byte p_bank_no,
 	word p_cpu_addr, word p_cpu_min_addr) {
 	resolve_labels(p_cpu_addr);
 	std::size_t result{ size() };
@@ -556,74 +554,86 @@ std::size_t klib::Asm6502::apply_hack_and_clear(std::vector<byte>& p_rom, byte p
 	return result;
 }
 
-std::size_t klib::Asm6502::apply_hack_and_clear(std::vector<byte>& p_rom, byte p_bank_no,
+std::size_t klib::Asm6502::apply_hack_and_clear(klib::RomImage& p_rom, byte p_bank_no,
 	word p_cpu_addr) {
 	return apply_hack_and_clear(p_rom, p_bank_no, p_cpu_addr, get_cpu_min_addr(p_bank_no));
 }
 
-void klib::Asm6502::apply_byte(std::vector<byte>& p_rom, byte p_byte,
+void klib::Asm6502::apply_byte(klib::RomImage& p_rom, byte p_byte,
 	byte p_bank_no, word p_cpu_addr, word p_cpu_min_addr) {
-	p_rom.at(get_file_offset(p_bank_no, p_cpu_addr, p_cpu_min_addr)) = p_byte;
+	const byte bytes[]{ p_byte };
+
+	klib::patch::write(p_rom, get_file_offset(p_bank_no, p_cpu_addr, p_cpu_min_addr), bytes);
 }
 
-void klib::Asm6502::apply_byte(std::vector<byte>& p_rom, byte p_byte,
+void klib::Asm6502::apply_byte(klib::RomImage& p_rom, byte p_byte,
 	byte p_bank_no, word p_cpu_addr) {
 	apply_byte(p_rom, p_byte, p_bank_no, p_cpu_addr, get_cpu_min_addr(p_bank_no));
 }
 
-std::size_t klib::Asm6502::apply_bytes(std::vector<byte>& p_rom, const std::vector<byte>& p_bytes,
+std::size_t klib::Asm6502::apply_bytes(klib::RomImage& p_rom, const std::vector<byte>& p_bytes,
 	byte p_bank_no, word p_cpu_addr, word p_cpu_min_addr) {
-	std::copy(p_bytes.begin(), p_bytes.end(), p_rom.begin() + get_file_offset(p_bank_no, p_cpu_addr, p_cpu_min_addr));
+	klib::patch::write(p_rom, get_file_offset(p_bank_no, p_cpu_addr, p_cpu_min_addr), p_bytes);
 
 	return p_bytes.size();
 }
 
-std::size_t klib::Asm6502::apply_bytes(std::vector<byte>& p_rom, const std::vector<byte>& p_bytes,
+std::size_t klib::Asm6502::apply_bytes(klib::RomImage& p_rom, const std::vector<byte>& p_bytes,
 	byte p_bank_no, word p_cpu_addr) {
 	return apply_bytes(p_rom, p_bytes, p_bank_no, p_cpu_addr, get_cpu_min_addr(p_bank_no));
 }
 
-void klib::Asm6502::apply_word(std::vector<byte>& p_rom, word p_word,
+void klib::Asm6502::apply_word(klib::RomImage& p_rom, word p_word,
 	byte p_bank_no, word p_cpu_addr) {
-	std::size_t file_offset{ get_file_offset(p_bank_no, p_cpu_addr) };
+	const byte bytes[]{ static_cast<byte>(p_word % 256), static_cast<byte>(p_word / 256) };
 
-	p_rom.at(file_offset) = static_cast<byte>(p_word % 256);
-	p_rom.at(file_offset + 1) = static_cast<byte>(p_word / 256);
+	klib::patch::write(p_rom, get_file_offset(p_bank_no, p_cpu_addr), bytes);
 }
 
-std::size_t klib::Asm6502::apply_words(std::vector<byte>& p_rom, const std::vector<word>& p_words,
+std::size_t klib::Asm6502::apply_words(klib::RomImage& p_rom, const std::vector<word>& p_words,
 	byte p_bank_no, word p_cpu_addr, word p_cpu_min_addr) {
+	std::vector<byte> bytes;
+	bytes.reserve(2 * p_words.size());
 
-	for (std::size_t i{ 0 }; i < p_words.size(); ++i)
-		apply_word(p_rom, p_words[i], p_bank_no, static_cast<word>(p_cpu_addr + 2 * i));
+	for (word w : p_words) {
+		bytes.push_back(static_cast<byte>(w % 256));
+		bytes.push_back(static_cast<byte>(w / 256));
+	}
 
-	return 2 * p_words.size();
+	return apply_bytes(p_rom, bytes, p_bank_no, p_cpu_addr, p_cpu_min_addr);
 }
 
-std::size_t klib::Asm6502::apply_words(std::vector<byte>& p_rom, const std::vector<word>& p_words,
+std::size_t klib::Asm6502::apply_words(klib::RomImage& p_rom, const std::vector<word>& p_words,
 	byte p_bank_no, word p_cpu_addr) {
 	return apply_words(p_rom, p_words, p_bank_no, p_cpu_addr, get_cpu_min_addr(p_bank_no));
 }
 
-std::size_t klib::Asm6502::apply_words_as_split_table(std::vector<byte>& p_rom, const std::vector<word>& p_words,
+std::size_t klib::Asm6502::apply_words_as_split_table(klib::RomImage& p_rom, const std::vector<word>& p_words,
 	byte p_bank_no, word p_cpu_addr, word p_cpu_min_addr) {
 	std::size_t lo_offset{ get_file_offset(p_bank_no, p_cpu_addr, p_cpu_min_addr) };
 	std::size_t hi_offset{ get_file_offset(p_bank_no, p_cpu_addr + static_cast<word>(p_words.size()), p_cpu_min_addr) };
 
-	for (std::size_t i{ 0 }; i < p_words.size(); ++i) {
-		p_rom.at(hi_offset + i) = static_cast<byte>(p_words[i] / 256);
-		p_rom.at(lo_offset + i) = static_cast<byte>(p_words[i] % 256);
+	std::vector<byte> lo_bytes, hi_bytes;
+	lo_bytes.reserve(p_words.size());
+	hi_bytes.reserve(p_words.size());
+
+	for (word w : p_words) {
+		lo_bytes.push_back(static_cast<byte>(w % 256));
+		hi_bytes.push_back(static_cast<byte>(w / 256));
 	}
 
+	klib::patch::write(p_rom, lo_offset, lo_bytes);
+	klib::patch::write(p_rom, hi_offset, hi_bytes);
+
 	return 2 * p_words.size();
 }
 
-std::size_t klib::Asm6502::apply_words_as_split_table(std::vector<byte>& p_rom, const std::vector<word>& p_words,
+std::size_t klib::Asm6502::apply_words_as_split_table(klib::RomImage& p_rom, const std::vector<word>& p_words,
 	byte p_bank_no, word p_cpu_addr) {
 	return apply_words_as_split_table(p_rom, p_words, p_bank_no, p_cpu_addr, get_cpu_min_addr(p_bank_no));
 }
 
-word klib::Asm6502::read_word(const std::vector<byte>& p_rom, byte p_bank_no, word p_cpu_addr) {
+word klib::Asm6502::read_word(klib::RomView p_rom, byte p_bank_no, word p_cpu_addr) {
 	const auto file_offset{ get_file_offset(p_bank_no, p_cpu_addr) };
 
 	return static_cast<word>(p_rom.at(file_offset) | p_rom.at(file_offset + 1) << 8);
@@ -6,6 +6,7 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "Krom.h"
 
 using byte = std::uint8_t;
 using sbyte = std::int8_t;
@@ -43,7 +44,7 @@ namespace klib {
 		void resolve_labels(word p_base_cpu_addr);
 		void branch(byte p_opcode, const std::string& p_label);
 
-		void apply_hack(std::vector<byte>& p_rom, byte p_bank_no,
+		void apply_hack(klib::RomImage& p_rom, byte p_bank_no,
 			word p_cpu_addr, word p_cpu_min_addr) const;
 
 	public:
@@ -57,31 +58,31 @@ namespace klib {
 		void label(const std::string& p_name);
 
 		void clear(void);
-		std::size_t apply_hack_and_clear(std::vector<byte>& p_rom, byte p_bank_no,
+		std::size_t apply_hack_and_clear(klib::RomImage& p_rom, byte p_bank_no,
 			word p_cpu_addr, word p_cpu_min_addr);
-		std::size_t apply_hack_and_clear(std::vector<byte>& p_rom, byte p_bank_no,
+		std::size_t apply_hack_and_clear(klib::RomImage& p_rom, byte p_bank_no,
 			word p_cpu_addr);
-		static void apply_byte(std::vector<byte>& p_rom, byte p_byte,
+		static void apply_byte(klib::RomImage& p_rom, byte p_byte,
 			byte p_bank_no, word p_cpu_addr, word p_cpu_min_addr);
-		static void apply_byte(std::vector<byte>& p_rom, byte p_byte,
+		static void apply_byte(klib::RomImage& p_rom, byte p_byte,
 			byte p_bank_no, word p_cpu_addr);
-		static std::size_t apply_bytes(std::vector<byte>& p_rom, const std::vector<byte>& p_bytes,
+		static std::size_t apply_bytes(klib::RomImage& p_rom, const std::vector<byte>& p_bytes,
 			byte p_bank_no, word p_cpu_addr, word p_cpu_min_addr);
-		static std::size_t apply_bytes(std::vector<byte>& p_rom, const std::vector<byte>& p_bytes,
+		static std::size_t apply_bytes(klib::RomImage& p_rom, const std::vector<byte>& p_bytes,
 			byte p_bank_no, word p_cpu_addr);
 
-		static void apply_word(std::vector<byte>& p_rom, word p_word,
+		static void apply_word(klib::RomImage& p_rom, word p_word,
 			byte p_bank_no, word p_cpu_addr);
-		static std::size_t apply_words(std::vector<byte>& p_rom, const std::vector<word>& p_words,
+		static std::size_t apply_words(klib::RomImage& p_rom, const std::vector<word>& p_words,
 			byte p_bank_no, word p_cpu_addr, word p_cpu_min_addr);
-		static std::size_t apply_words(std::vector<byte>& p_rom, const std::vector<word>& p_words,
+		static std::size_t apply_words(klib::RomImage& p_rom, const std::vector<word>& p_words,
 			byte p_bank_no, word p_cpu_addr);
-		static std::size_t apply_words_as_split_table(std::vector<byte>& p_rom, const std::vector<word>& p_words,
+		static std::size_t apply_words_as_split_table(klib::RomImage& p_rom, const std::vector<word>& p_words,
 			byte p_bank_no, word p_cpu_addr, word p_cpu_min_addr);
-		static std::size_t apply_words_as_split_table(std::vector<byte>& p_rom, const std::vector<word>& p_words,
+		static std::size_t apply_words_as_split_table(klib::RomImage& p_rom, const std::vector<word>& p_words,
 			byte p_bank_no, word p_cpu_addr);
 
-		static word read_word(const std::vector<byte>& p_rom, byte p_bank_no, word p_cpu_addr);
+		static word read_word(klib::RomView p_rom, byte p_bank_no, word p_cpu_addr);
 
 		// jumps and calls
 		void jmp(word p_addr);
@@ -1,33 +1,367 @@
 #include "Kfile.h"
+#include "Kprofile.h"
+#include <algorithm>
+#include <format>
 #include <fstream>
+#include <iostream>
+#include <random>
 #include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+	constexpr std::size_t STREAM_CHUNK_SIZE{ 0x10000 };
+
+	// reads until the end of the stream, so pipes work as well as files
+	std::vector<byte> read_stream(std::istream& p_stream, const std::string& p_filename,
+		std::size_t p_size_hint) {
+		std::vector<byte> result;
+		result.reserve(p_size_hint);
+
+		while (p_stream) {
+			const std::size_t l_size{ result.size() };
+			result.resize(l_size + STREAM_CHUNK_SIZE);
+			p_stream.read(reinterpret_cast<char*>(result.data() + l_size), STREAM_CHUNK_SIZE);
+			result.resize(l_size + static_cast<std::size_t>(p_stream.gcount()));
+		}
+
+		if (p_stream.bad())
+			throw std::runtime_error("Failed to read file: " + p_filename);
+
+		return result;
+	}
+
+	std::vector<byte> read_stdin(void) {
+#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+#endif
+		return read_stream(std::cin, "standard input", 0);
+	}
+
+	void write_stdout(const byte* p_data, std::size_t p_size, bool p_binary) {
+#ifdef _WIN32
+		if (p_binary)
+			_setmode(_fileno(stdout), _O_BINARY);
+#else
+		static_cast<void>(p_binary);
+#endif
+		std::cout.write(reinterpret_cast<const char*>(p_data), p_size);
+		std::cout.flush();
+
+		if (!std::cout)
+			throw std::runtime_error("Failed to write to standard output");
+	}
+
+	void write_whole_file(const byte* p_data, std::size_t p_size, const std::string& p_filename) {
+		std::ofstream file(p_filename, std::ios::binary);
+		if (!file) {
+			throw std::runtime_error("Failed to open file: " + p_filename);
+		}
+
+		file.write(reinterpret_cast<const char*>(p_data), p_size);
+		file.close();
+
+		if (!file)
+			throw std::runtime_error("Failed to write file: " + p_filename);
+	}
+
+	bool has_content(const byte* p_data, std::size_t p_size, const std::string& p_filename) {
+		std::error_code ec;
+		const auto l_file_size{ std::filesystem::file_size(p_filename, ec) };
+
+		if (ec || l_file_size != p_size)
+			return false;
+		else if (p_size == 0)
+			return true;
+
+		const klib::file::MappedFile l_old(p_filename);
+		return std::equal(p_data, p_data + p_size, l_old.bytes().data());
+	}
+
+	// writes a temporary file with p_write_temp(temp filename, target filename) and
+	// renames it over the target, so the target is never left partially written;
+	// symlinks are followed, so the file behind them is replaced and keeps its permissions
+	template<class WriteTemp>
+	void replace_file(const std::string& p_filename, WriteTemp p_write_temp) {
+		std::error_code ec;
+		const auto l_target{ std::filesystem::weakly_canonical(p_filename, ec) };
+		const std::string l_target_filename{ ec ? p_filename : l_target.string() };
+
+		const auto l_status{ std::filesystem::status(l_target_filename, ec) };
+		const bool l_exists{ !ec && std::filesystem::exists(l_status) };
+
+		// a rename only needs access to the directory, so check that the file itself
+		// could be written, like a truncating write would
+		if (l_exists) {
+			std::ofstream l_probe(l_target_filename, std::ios::binary | std::ios::app);
+			if (!l_probe)
+				throw std::runtime_error("Failed to open file: " + p_filename);
+		}
+
+		// a private name per writer, so concurrent jobs and readers never see a partial file
+		std::random_device l_random;
+		const auto l_tmp_filename{ std::format("{}.{:08x}{:08x}.tmp", l_target_filename,
+			l_random(), l_random()) };
+
+		try {
+			p_write_temp(l_tmp_filename, l_target_filename);
+			if (l_exists)
+				std::filesystem::permissions(l_tmp_filename, l_status.permissions());
+			std::filesystem::rename(l_tmp_filename, l_target_filename);
+		}
+		catch (const std::exception&) {
+			std::filesystem::remove(l_tmp_filename, ec);
+			throw std::runtime_error("Failed to write file: " + p_filename);
+		}
+	}
+
+	// returns false if the file already had this content
+	bool write_file_atomically(const byte* p_data, std::size_t p_size, const std::string& p_filename) {
+		klib::prof::Scope l_prof("file write", p_filename);
+
+		if (klib::file::is_stdio(p_filename)) {
+			l_prof.count("bytes", p_size);
+			write_stdout(p_data, p_size, true);
+			return true;
+		}
+
+		if (has_content(p_data, p_size, p_filename)) {
+			l_prof.count("unchanged", 1);
+			return false;
+		}
+
+		replace_file(p_filename, [p_data, p_size](const std::string& p_tmp_filename, const std::string&) {
+			write_whole_file(p_data, p_size, p_tmp_filename);
+			});
+
+		l_prof.count("bytes", p_size);
+		return true;
+	}
+
+	// true if the file holds p_data in all the ranges
+	bool has_range_content(std::span<const byte> p_data,
+		const std::map<std::size_t, std::size_t>& p_ranges, const std::string& p_filename) {
+		std::ifstream file(p_filename, std::ios::binary);
+		std::vector<char> l_old;
+
+		for (const auto& [l_start, l_end] : p_ranges) {
+			l_old.resize(l_end - l_start);
+			file.seekg(static_cast<std::streamoff>(l_start));
+			file.read(l_old.data(), static_cast<std::streamsize>(l_old.size()));
+
+			if (!file || !std::equal(begin(l_old), end(l_old),
+				reinterpret_cast<const char*>(p_data.data() + l_start)))
+				return false;
+		}
+
+		return true;
+	}
+
+	// the temporary file starts as a copy of the target, which the file system
+	// may share instead of copying, and only the ranges are written into it
+	void write_ranges(std::span<const byte> p_data,
+		const std::map<std::size_t, std::size_t>& p_ranges,
+		const std::string& p_tmp_filename, const std::string& p_target_filename) {
+		std::filesystem::copy_file(p_target_filename, p_tmp_filename,
+			std::filesystem::copy_options::overwrite_existing);
+
+		std::fstream file(p_tmp_filename, std::ios::binary | std::ios::in | std::ios::out);
+		if (!file)
+			throw std::runtime_error("Failed to open file: " + p_tmp_filename);
+
+		for (const auto& [start, end] : p_ranges) {
+			file.seekp(static_cast<std::streamoff>(start));
+			file.write(reinterpret_cast<const char*>(p_data.data() + start),
+				static_cast<std::streamsize>(end - start));
+		}
+		file.close();
+
+		if (!file)
+			throw std::runtime_error("Failed to write file: " + p_tmp_filename);
+	}
+
+}
+
+klib::file::MappedFile::MappedFile(const std::string& p_filename, bool p_copy_on_write) :
+	m_data{ nullptr },
+	m_size{ 0 },
+	m_copy_on_write{ p_copy_on_write }
+{
+	klib::prof::Scope l_prof("file map", p_filename);
+
+	if (is_stdio(p_filename)) {
+		m_buffer = read_stdin();
+		m_data = m_buffer.data();
+		m_size = m_buffer.size();
+		l_prof.count("bytes", m_size);
+		return;
+	}
+
+	// the view keeps the mapping alive, so the handles can be closed right away
+#ifdef _WIN32
+	HANDLE l_file{ CreateFileA(p_filename.c_str(), GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+	if (l_file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Failed to open file: " + p_filename);
+
+	LARGE_INTEGER l_size;
+	if (!GetFileSizeEx(l_file, &l_size)) {
+		CloseHandle(l_file);
+		throw std::runtime_error("Failed to determine file size: " + p_filename);
+	}
+	m_size = static_cast<std::size_t>(l_size.QuadPart);
+
+	if (m_size != 0) {
+		HANDLE l_mapping{ CreateFileMappingA(l_file, nullptr,
+			m_copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr) };
+		if (l_mapping != nullptr) {
+			m_data = static_cast<const byte*>(MapViewOfFile(l_mapping,
+				m_copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+			CloseHandle(l_mapping);
+		}
+	}
+	CloseHandle(l_file);
+#else
+	int l_fd{ open(p_filename.c_str(), O_RDONLY) };
+	if (l_fd < 0)
+		throw std::runtime_error("Failed to open file: " + p_filename);
+
+	struct stat l_stat;
+	if (fstat(l_fd, &l_stat) != 0) {
+		close(l_fd);
+		throw std::runtime_error("Failed to determine file size: " + p_filename);
+	}
+	else if (!S_ISREG(l_stat.st_mode)) {
+		// pipes and devices cannot be mapped
+		close(l_fd);
+		m_buffer = read_file_as_bytes(p_filename);
+		m_data = m_buffer.data();
+		m_size = m_buffer.size();
+		l_prof.count("bytes", m_size);
+		return;
+	}
+	m_size = static_cast<std::size_t>(l_stat.st_size);
+
+	if (m_size != 0) {
+		void* l_view{ mmap(nullptr, m_size,
+			m_copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, l_fd, 0) };
+		if (l_view != MAP_FAILED)
+			m_data = static_cast<const byte*>(l_view);
+	}
+	close(l_fd);
+#endif
+
+	if (m_size != 0 && m_data == nullptr)
+		throw std::runtime_error("Failed to map file: " + p_filename);
+
+	l_prof.count("bytes", m_size);
+}
+
+klib::file::MappedFile::~MappedFile(void) {
+	unmap();
+}
+
+klib::file::MappedFile::MappedFile(MappedFile&& p_other) noexcept :
+	m_data{ std::exchange(p_other.m_data, nullptr) },
+	m_size{ std::exchange(p_other.m_size, 0) },
+	m_buffer{ std::move(p_other.m_buffer) },
+	m_copy_on_write{ p_other.m_copy_on_write }
+{
+}
+
+klib::file::MappedFile& klib::file::MappedFile::operator=(MappedFile&& p_other) noexcept {
+	if (this != &p_other) {
+		unmap();
+		m_data = std::exchange(p_other.m_data, nullptr);
+		m_size = std::exchange(p_other.m_size, 0);
+		m_buffer = std::move(p_other.m_buffer);
+		m_copy_on_write = p_other.m_copy_on_write;
+	}
+
+	return *this;
+}
+
+void klib::file::MappedFile::unmap(void) {
+	if (m_data == nullptr || !m_buffer.empty())
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+#else
+	munmap(const_cast<byte*>(m_data), m_size);
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
+bool klib::file::is_stdio(const std::string& p_filename) {
+	return p_filename == STDIO_FILENAME;
+}
+
+std::span<const byte> klib::file::MappedFile::bytes(void) const {
+	return std::span<const byte>(m_data, m_size);
+}
+
+std::span<byte> klib::file::MappedFile::writable_bytes(void) {
+	if (!m_copy_on_write)
+		throw std::logic_error("File is mapped read-only");
+
+	// owned buffers are ours to write as well
+	return std::span<byte>(const_cast<byte*>(m_data), m_size);
+}
+
+klib::RomImage klib::file::map_rom_image(const std::string& p_filename) {
+	auto l_file{ std::make_shared<klib::file::MappedFile>(p_filename, true) };
+	const auto l_bytes{ l_file->writable_bytes() };
+
+	return klib::RomImage(l_bytes, std::move(l_file));
+}
 
 std::vector<byte> klib::file::read_file_as_bytes(const std::string& p_filename) {
+	klib::prof::Scope l_prof("file read", p_filename);
+
+	if (is_stdio(p_filename)) {
+		auto result{ read_stdin() };
+		l_prof.count("bytes", result.size());
+		return result;
+	}
+
 	std::ifstream file(p_filename, std::ios::binary);
 	if (!file)
 		throw std::runtime_error("Failed to open file: " + p_filename);
 
-	// Seek to end to determine size
-	file.seekg(0, std::ios::end);
-	std::streamsize size = file.tellg();
-	if (size < 0)
-		throw std::runtime_error("Failed to determine file size: " + p_filename);
-	file.seekg(0, std::ios::beg);
+	// the size is only a hint, since pipes and devices have none
+	std::error_code ec;
+	const auto l_size{ std::filesystem::file_size(p_filename, ec) };
 
-	std::vector<unsigned char> buffer(static_cast<std::size_t>(size));
-	if (!file.read(reinterpret_cast<char*>(buffer.data()), size))
-		throw std::runtime_error("Failed to read file: " + p_filename);
+	auto result{ read_stream(file, p_filename, ec ? 0 : static_cast<std::size_t>(l_size)) };
+	l_prof.count("bytes", result.size());
 
-	return buffer;
+	return result;
 }
 
 std::vector<std::string> klib::file::read_file_as_strings(const std::string& p_filename) {
+	klib::prof::Scope l_prof("file read", p_filename);
 	std::vector<std::string> result;
 	std::ifstream input_file(p_filename);
 
 	if (input_file.is_open()) {
 		std::string line;
 		while (std::getline(input_file, line)) {
+			l_prof.count("bytes", line.size() + 1);
 			result.push_back(line);
 		}
 		input_file.close();
@@ -38,24 +372,73 @@ std::vector<std::string> klib::file::read_file_as_strings(const std::string& p_f
 }
 
 bool klib::file::file_exists(const std::string& p_filename) {
+	if (is_stdio(p_filename))
+		return false;
+
 	std::ifstream file(p_filename);
 	return file.good();
 }
 
-void klib::file::write_bytes_to_file(const std::vector<byte>& p_data, const std::string& p_filename) {
-	std::ofstream file(p_filename, std::ios::binary);
-	if (!file) {
-		throw std::runtime_error("Failed to open file: " + p_filename);
+std::filesystem::file_time_type klib::file::last_write_time(const std::string& p_filename) {
+	std::error_code ec;
+	auto result{ std::filesystem::last_write_time(p_filename, ec) };
+
+	return ec ? std::filesystem::file_time_type::min() : result;
+}
+
+bool klib::file::write_bytes_to_file(std::span<const byte> p_data, const std::string& p_filename) {
+	return write_file_atomically(p_data.data(), p_data.size(), p_filename);
+}
+
+bool klib::file::write_ranges_to_file(std::span<const byte> p_data,
+	const std::map<std::size_t, std::size_t>& p_ranges, const std::string& p_filename) {
+	std::error_code ec;
+	const auto l_file_size{ std::filesystem::file_size(p_filename, ec) };
+
+	// without the rest of the content in place, the whole file has to be written
+	if (is_stdio(p_filename) || ec || l_file_size != p_data.size())
+		return write_file_atomically(p_data.data(), p_data.size(), p_filename);
+
+	klib::prof::Scope l_prof("file write", p_filename);
+
+	if (has_range_content(p_data, p_ranges, p_filename)) {
+		l_prof.count("unchanged", 1);
+		return false;
 	}
 
-	file.write(reinterpret_cast<const char*>(p_data.data()), p_data.size());
+	replace_file(p_filename, [p_data, &p_ranges](const std::string& p_tmp_filename,
+		const std::string& p_target_filename) {
+			write_ranges(p_data, p_ranges, p_tmp_filename, p_target_filename);
+		});
+
+	std::size_t l_bytes{ 0 };
+	for (const auto& [start, end] : p_ranges)
+		l_bytes += end - start;
+
+	l_prof.count("bytes", l_bytes);
+	l_prof.count("ranges", p_ranges.size());
+	return true;
 }
+bool klib::file::write_string_to_file(const std::string& p_data, const std::string& p_filename) {
+	if (is_stdio(p_filename)) {
+		klib::prof::Scope l_prof("file write", p_filename);
+		l_prof.count("bytes", p_data.size());
+		write_stdout(reinterpret_cast<const byte*>(p_data.data()), p_data.size(), false);
+		return true;
+	}
 
-void klib::file::write_string_to_file(const std::string& p_data, const std::string& p_filename) {
-	std::ofstream outputFile(p_filename);
+#ifdef _WIN32
+	// expand line endings like a text mode stream would, so we compare against what is on disk
+	std::string l_data;
+	l_data.reserve(p_data.size() + p_data.size() / 16);
+	for (char c : p_data) {
+		if (c == '\n')
+			l_data += '\r';
+		l_data += c;
+	}
 
-	if (!outputFile.is_open())
-		throw std::runtime_error("Failed to open file: " + p_filename);
-	else
-		outputFile << p_data;
+	return write_file_atomically(reinterpret_cast<const byte*>(l_data.data()), l_data.size(), p_filename);
+#else
+	return write_file_atomically(reinterpret_cast<const byte*>(p_data.data()), p_data.size(), p_filename);
+#endif
 }
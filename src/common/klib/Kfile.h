@@ -1,8 +1,13 @@
 #ifndef KLIB_KFILE_H
 #define KLIB_KFILE_H
 
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <span>
 #include <string>
 #include <vector>
+#include "Krom.h"
 
 using byte = unsigned char;
 
@@ -10,12 +15,56 @@ namespace klib {
 
 	namespace file {
 
+		// reads from this name come from stdin, writes go to stdout
+		constexpr char STDIO_FILENAME[]{ "-" };
+
+		bool is_stdio(const std::string& p_filename);
+
+		// a whole file mapped read-only into memory; empty files map to an empty span.
+		// stdin and other streams that cannot be mapped are read into an owned buffer.
+		// a copy-on-write mapping can be written to: the pages written are copied,
+		// and the changes never reach the file
+		class MappedFile {
+			const byte* m_data;
+			std::size_t m_size;
+			std::vector<byte> m_buffer;
+			bool m_copy_on_write;
+
+			void unmap(void);
+
+		public:
+			explicit MappedFile(const std::string& p_filename, bool p_copy_on_write = false);
+			~MappedFile(void);
+			MappedFile(MappedFile&& p_other) noexcept;
+			MappedFile& operator=(MappedFile&& p_other) noexcept;
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			std::span<const byte> bytes(void) const;
+			// throws std::logic_error unless mapped copy-on-write
+			std::span<byte> writable_bytes(void);
+		};
+
+		// a ROM image over a copy-on-write mapping of the file, so only the pages a
+		// build writes to are copied
+		klib::RomImage map_rom_image(const std::string& p_filename);
+
 		std::vector<byte> read_file_as_bytes(const std::string& p_filename);
 		std::vector<std::string> read_file_as_strings(const std::string& p_filename);
 
+		// always false for stdin/stdout
 		bool file_exists(const std::string& p_filename);
-		void write_bytes_to_file(const std::vector<byte>& p_data, const std::string& p_filename);
-		void write_string_to_file(const std::string& p_data, const std::string& p_filename);
+		// file_time_type::min() if the file does not exist
+		std::filesystem::file_time_type last_write_time(const std::string& p_filename);
+		// replace the file atomically via a temporary file and a rename; a file that
+		// already has this content is left untouched. returns false in that case
+		bool write_bytes_to_file(std::span<const byte> p_data, const std::string& p_filename);
+		bool write_string_to_file(const std::string& p_data, const std::string& p_filename);
+		// like write_bytes_to_file, for a file that already holds p_data outside the
+		// given [start, end) ranges; only the ranges are compared and written, and the
+		// rest of the temporary file is cloned from the existing one
+		bool write_ranges_to_file(std::span<const byte> p_data,
+			const std::map<std::size_t, std::size_t>& p_ranges, const std::string& p_filename);
 	}
 
 }
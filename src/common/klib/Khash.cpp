@@ -0,0 +1,86 @@
+#include "Khash.h"
+#include <array>
+
+namespace {
+
+	using Crc32Tables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+	// table k advances the checksum by one byte followed by k zero bytes
+	constexpr Crc32Tables make_crc32_tables(void) {
+		constexpr std::uint32_t CRC32_POLYNOMIAL{ 0xedb88320 };
+
+		Crc32Tables result{};
+
+		for (std::uint32_t i{ 0 }; i < 256; ++i) {
+			std::uint32_t crc{ i };
+			for (int bit{ 0 }; bit < 8; ++bit)
+				crc = (crc & 1) ? (crc >> 1) ^ CRC32_POLYNOMIAL : crc >> 1;
+			result[0][i] = crc;
+		}
+
+		for (std::size_t k{ 1 }; k < 8; ++k)
+			for (std::size_t i{ 0 }; i < 256; ++i)
+				result[k][i] = (result[k - 1][i] >> 8) ^ result[0][result[k - 1][i] & 0xff];
+
+		return result;
+	}
+
+	constexpr Crc32Tables CRC32_TABLES{ make_crc32_tables() };
+
+	std::uint32_t read_u32_le(const byte* p_data) {
+		return static_cast<std::uint32_t>(p_data[0]) |
+			static_cast<std::uint32_t>(p_data[1]) << 8 |
+			static_cast<std::uint32_t>(p_data[2]) << 16 |
+			static_cast<std::uint32_t>(p_data[3]) << 24;
+	}
+
+}
+
+std::uint64_t klib::hash::fnv1a_64(const byte* p_data, std::size_t p_size,
+	std::uint64_t p_seed) {
+	constexpr std::uint64_t FNV1A_64_PRIME{ 0x100000001b3 };
+
+	std::uint64_t result{ p_seed };
+
+	for (std::size_t i{ 0 }; i < p_size; ++i) {
+		result ^= p_data[i];
+		result *= FNV1A_64_PRIME;
+	}
+
+	return result;
+}
+
+std::uint64_t klib::hash::fnv1a_64(const std::vector<byte>& p_data,
+	std::uint64_t p_seed) {
+	return fnv1a_64(p_data.data(), p_data.size(), p_seed);
+}
+
+std::uint64_t klib::hash::fnv1a_64(std::string_view p_data,
+	std::uint64_t p_seed) {
+	return fnv1a_64(reinterpret_cast<const byte*>(p_data.data()), p_data.size(), p_seed);
+}
+
+std::uint32_t klib::hash::crc32(const byte* p_data, std::size_t p_size, std::uint32_t p_crc) {
+	const auto& t{ CRC32_TABLES };
+	std::uint32_t crc{ ~p_crc };
+
+	// eight bytes per step, with independent table lookups
+	for (; p_size >= 8; p_data += 8, p_size -= 8) {
+		const std::uint32_t lo{ crc ^ read_u32_le(p_data) };
+		const std::uint32_t hi{ read_u32_le(p_data + 4) };
+
+		crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+			t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+			t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^
+			t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+	}
+
+	for (; p_size > 0; ++p_data, --p_size)
+		crc = t[0][(crc ^ *p_data) & 0xff] ^ (crc >> 8);
+
+	return ~crc;
+}
+
+std::uint32_t klib::hash::crc32(const std::vector<byte>& p_data, std::uint32_t p_crc) {
+	return crc32(p_data.data(), p_data.size(), p_crc);
+}
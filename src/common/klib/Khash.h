@@ -0,0 +1,33 @@
+#ifndef KLIB_KHASH_H
+#define KLIB_KHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+using byte = unsigned char;
+
+namespace klib {
+
+	namespace hash {
+
+		constexpr std::uint64_t FNV1A_64_OFFSET{ 0xcbf29ce484222325 };
+
+		// 64-bit FNV-1a; pass a previous result as seed to hash several inputs in sequence
+		std::uint64_t fnv1a_64(const byte* p_data, std::size_t p_size,
+			std::uint64_t p_seed = FNV1A_64_OFFSET);
+		std::uint64_t fnv1a_64(const std::vector<byte>& p_data,
+			std::uint64_t p_seed = FNV1A_64_OFFSET);
+		std::uint64_t fnv1a_64(std::string_view p_data,
+			std::uint64_t p_seed = FNV1A_64_OFFSET);
+
+		// CRC-32 (IEEE, as used by zip and IPS/ROM databases), slice-by-8;
+		// pass a previous result to continue a checksum
+		std::uint32_t crc32(const byte* p_data, std::size_t p_size, std::uint32_t p_crc = 0);
+		std::uint32_t crc32(const std::vector<byte>& p_data, std::uint32_t p_crc = 0);
+	}
+
+}
+
+#endif
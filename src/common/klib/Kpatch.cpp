@@ -0,0 +1,295 @@
+#include "Kpatch.h"
+#include "Khash.h"
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+	thread_local klib::patch::Journal* g_active_journal{ nullptr };
+
+	// changed runs closer than an IPS record header are cheaper to emit as one
+	constexpr std::size_t MERGE_GAP{ 5 };
+
+	constexpr std::size_t IPS_MAX_OFFSET{ 0xffffff };
+	constexpr std::size_t IPS_MAX_RECORD_SIZE{ 0xffff };
+	// a record at this offset would read as the end marker
+	constexpr std::size_t IPS_EOF_OFFSET{ 0x454f46 };
+
+	constexpr std::size_t BPS_SOURCE_READ{ 0 };
+	constexpr std::size_t BPS_TARGET_READ{ 1 };
+
+	// [offset, size) of every byte run that has to go into the patch
+	std::vector<std::pair<std::size_t, std::size_t>> get_changed_runs(
+		std::span<const byte> p_source, std::span<const byte> p_target,
+		const klib::patch::Journal& p_journal) {
+		std::vector<std::pair<std::size_t, std::size_t>> result;
+
+		const auto add_byte{ [&result](std::size_t p_offset) {
+			if (!result.empty() &&
+				p_offset <= result.back().first + result.back().second + MERGE_GAP)
+				result.back().second = p_offset + 1 - result.back().first;
+			else
+				result.push_back(std::make_pair(p_offset, 1));
+		} };
+
+		const std::size_t l_common_size{ std::min(p_source.size(), p_target.size()) };
+
+		for (const auto& [start, end] : p_journal.ranges())
+			for (std::size_t i{ start }; i < end && i < l_common_size; ++i)
+				if (p_source[i] != p_target[i])
+					add_byte(i);
+
+		// a target that grew always carries its whole tail
+		if (p_target.size() > p_source.size()) {
+			if (!result.empty() &&
+				p_source.size() <= result.back().first + result.back().second + MERGE_GAP)
+				result.back().second = p_target.size() - result.back().first;
+			else
+				result.push_back(std::make_pair(p_source.size(), p_target.size() - p_source.size()));
+		}
+
+		return result;
+	}
+
+	// merges [p_start, p_end) into ranges that overlap or touch it
+	void add_range(std::map<std::size_t, std::size_t>& p_ranges,
+		std::size_t p_start, std::size_t p_end) {
+		auto iter{ p_ranges.upper_bound(p_start) };
+		if (iter != begin(p_ranges)) {
+			auto prev{ std::prev(iter) };
+			if (prev->second >= p_start) {
+				p_start = prev->first;
+				p_end = std::max(p_end, prev->second);
+				iter = p_ranges.erase(prev);
+			}
+		}
+
+		while (iter != end(p_ranges) && iter->first <= p_end) {
+			p_end = std::max(p_end, iter->second);
+			iter = p_ranges.erase(iter);
+		}
+
+		p_ranges.insert(std::make_pair(p_start, p_end));
+	}
+
+	void check_rom_range(const klib::RomImage& p_rom, std::size_t p_offset, std::size_t p_size) {
+		if (p_offset > p_rom.size() || p_size > p_rom.size() - p_offset)
+			throw std::out_of_range(std::format("ROM write of {} bytes at offset 0x{:x} is out of bounds (ROM size is 0x{:x})",
+				p_size, p_offset, p_rom.size()));
+	}
+
+	void append_string(std::vector<byte>& p_out, std::string_view p_value) {
+		for (char c : p_value)
+			p_out.push_back(static_cast<byte>(c));
+	}
+
+	void append_u24_be(std::vector<byte>& p_out, std::size_t p_value) {
+		p_out.push_back(static_cast<byte>(p_value >> 16));
+		p_out.push_back(static_cast<byte>(p_value >> 8));
+		p_out.push_back(static_cast<byte>(p_value));
+	}
+
+	void append_u32_le(std::vector<byte>& p_out, std::uint32_t p_value) {
+		for (int i{ 0 }; i < 4; ++i)
+			p_out.push_back(static_cast<byte>(p_value >> (8 * i)));
+	}
+
+	// beat's variable-length number encoding
+	void append_bps_number(std::vector<byte>& p_out, std::size_t p_value) {
+		while (true) {
+			byte l_bits{ static_cast<byte>(p_value & 0x7f) };
+			p_value >>= 7;
+			if (p_value == 0) {
+				p_out.push_back(0x80 | l_bits);
+				break;
+			}
+			p_out.push_back(l_bits);
+			--p_value;
+		}
+	}
+
+}
+
+void klib::patch::Journal::add(std::size_t p_offset, std::size_t p_size, bool p_claim) {
+	if (p_size == 0)
+		return;
+
+	const std::size_t l_end{ p_offset + p_size };
+	add_range(m_ranges, p_offset, l_end);
+
+	if (!p_claim || m_stage_ranges.empty())
+		return;
+
+	const std::size_t l_stage{ m_stage_ranges.size() - 1 };
+
+	for (std::size_t i{ 0 }; i < l_stage; ++i) {
+		const auto& l_ranges{ m_stage_ranges[i] };
+
+		auto iter{ l_ranges.upper_bound(p_offset) };
+		if (iter != begin(l_ranges) && std::prev(iter)->second > p_offset)
+			--iter;
+
+		for (; iter != end(l_ranges) && iter->first < l_end; ++iter)
+			add_range(m_overlaps[std::make_pair(i, l_stage)],
+				std::max(p_offset, iter->first), std::min(l_end, iter->second));
+	}
+
+	add_range(m_stage_ranges.back(), p_offset, l_end);
+}
+
+void klib::patch::Journal::begin_stage(void) {
+	m_stage_ranges.push_back(std::map<std::size_t, std::size_t>());
+}
+
+void klib::patch::Journal::clear(void) {
+	m_ranges.clear();
+	m_stage_ranges.clear();
+	m_overlaps.clear();
+}
+
+const std::map<std::size_t, std::size_t>& klib::patch::Journal::ranges(void) const {
+	return m_ranges;
+}
+
+std::vector<klib::patch::Overlap> klib::patch::Journal::overlaps(void) const {
+	std::vector<klib::patch::Overlap> result;
+
+	for (const auto& [stages, ranges] : m_overlaps) {
+		std::size_t l_size{ 0 };
+		for (const auto& [start, end] : ranges)
+			l_size += end - start;
+
+		result.push_back(klib::patch::Overlap{ stages.first, stages.second,
+			begin(ranges)->first, ranges.size(), l_size });
+	}
+
+	return result;
+}
+
+std::size_t klib::patch::Journal::size(void) const {
+	std::size_t result{ 0 };
+	for (const auto& [start, end] : m_ranges)
+		result += end - start;
+	return result;
+}
+
+klib::patch::Recording::Recording(klib::patch::Journal& p_journal) :
+	m_previous{ g_active_journal }
+{
+	g_active_journal = &p_journal;
+}
+
+klib::patch::Recording::~Recording(void) {
+	g_active_journal = m_previous;
+}
+
+void klib::patch::record(std::size_t p_offset, std::size_t p_size) {
+	if (g_active_journal != nullptr)
+		g_active_journal->add(p_offset, p_size);
+}
+
+void klib::patch::write(klib::RomImage& p_rom, std::size_t p_offset,
+	std::span<const byte> p_bytes) {
+	check_rom_range(p_rom, p_offset, p_bytes.size());
+	if (p_bytes.empty())
+		return;
+
+	std::memcpy(p_rom.data() + p_offset, p_bytes.data(), p_bytes.size());
+	record(p_offset, p_bytes.size());
+}
+
+void klib::patch::fill(klib::RomImage& p_rom, std::size_t p_offset,
+	std::size_t p_size, byte p_value) {
+	check_rom_range(p_rom, p_offset, p_size);
+	if (p_size == 0)
+		return;
+
+	std::memset(p_rom.data() + p_offset, p_value, p_size);
+	record(p_offset, p_size);
+}
+
+void klib::patch::copy(klib::RomImage& p_rom, std::size_t p_source_offset,
+	std::size_t p_target_offset, std::size_t p_size) {
+	check_rom_range(p_rom, p_source_offset, p_size);
+	check_rom_range(p_rom, p_target_offset, p_size);
+	if (p_size == 0)
+		return;
+
+	std::memmove(p_rom.data() + p_target_offset, p_rom.data() + p_source_offset, p_size);
+	if (g_active_journal != nullptr)
+		g_active_journal->add(p_target_offset, p_size, false);
+}
+
+std::vector<byte> klib::patch::create_ips(std::span<const byte> p_source,
+	std::span<const byte> p_target, const klib::patch::Journal& p_journal) {
+	std::vector<byte> result;
+	append_string(result, "PATCH");
+
+	for (auto [offset, size] : get_changed_runs(p_source, p_target, p_journal)) {
+		while (size > 0) {
+			if (offset == IPS_EOF_OFFSET) {
+				--offset;
+				++size;
+			}
+
+			if (offset > IPS_MAX_OFFSET)
+				throw std::runtime_error(std::format("IPS patches cannot address offset 0x{:x}", offset));
+
+			const std::size_t l_record_size{ std::min(size, IPS_MAX_RECORD_SIZE) };
+
+			append_u24_be(result, offset);
+			result.push_back(static_cast<byte>(l_record_size >> 8));
+			result.push_back(static_cast<byte>(l_record_size));
+			result.insert(end(result), begin(p_target) + offset,
+				begin(p_target) + offset + l_record_size);
+
+			offset += l_record_size;
+			size -= l_record_size;
+		}
+	}
+
+	append_string(result, "EOF");
+
+	// truncation extension
+	if (p_target.size() < p_source.size())
+		append_u24_be(result, p_target.size());
+
+	return result;
+}
+
+std::vector<byte> klib::patch::create_bps(std::span<const byte> p_source,
+	std::span<const byte> p_target, const klib::patch::Journal& p_journal) {
+	std::vector<byte> result;
+	append_string(result, "BPS1");
+	append_bps_number(result, p_source.size());
+	append_bps_number(result, p_target.size());
+	// no metadata
+	append_bps_number(result, 0);
+
+	std::size_t l_output_offset{ 0 };
+
+	for (const auto& [offset, size] : get_changed_runs(p_source, p_target, p_journal)) {
+		// unchanged bytes always lie within the source, so they can be read from it
+		if (offset > l_output_offset)
+			append_bps_number(result, ((offset - l_output_offset - 1) << 2) | BPS_SOURCE_READ);
+
+		append_bps_number(result, ((size - 1) << 2) | BPS_TARGET_READ);
+		result.insert(end(result), begin(p_target) + offset, begin(p_target) + offset + size);
+
+		l_output_offset = offset + size;
+	}
+
+	if (l_output_offset < p_target.size())
+		append_bps_number(result, ((p_target.size() - l_output_offset - 1) << 2) | BPS_SOURCE_READ);
+
+	append_u32_le(result, klib::hash::crc32(p_source.data(), p_source.size()));
+	append_u32_le(result, klib::hash::crc32(p_target.data(), p_target.size()));
+	append_u32_le(result, klib::hash::crc32(result.data(), result.size()));
+
+	return result;
+}
@@ -0,0 +1,79 @@
+#ifndef KLIB_KPATCH_H
+#define KLIB_KPATCH_H
+
+#include <cstddef>
+#include <map>
+#include <span>
+#include <utility>
+#include <vector>
+#include "Krom.h"
+
+using byte = unsigned char;
+
+namespace klib {
+
+	namespace patch {
+
+		// bytes written by two different build stages
+		struct Overlap {
+			std::size_t first_stage, second_stage;
+			// lowest overlapping offset, and the number of overlapping ranges and bytes
+			std::size_t offset, range_count, size;
+		};
+
+		// the file offset ranges a build wrote to, merged and ordered
+		class Journal {
+			// start -> end (exclusive)
+			std::map<std::size_t, std::size_t> m_ranges;
+			// the ranges claimed by each stage, indexed by stage
+			std::vector<std::map<std::size_t, std::size_t>> m_stage_ranges;
+			// (earlier stage, later stage) -> overlapping ranges
+			std::map<std::pair<std::size_t, std::size_t>, std::map<std::size_t, std::size_t>> m_overlaps;
+
+		public:
+			// unclaimed writes go into the patch, but are not checked for overlaps
+			void add(std::size_t p_offset, std::size_t p_size, bool p_claim = true);
+			// claimed writes after this belong to a new stage, and are checked
+			// against the ranges claimed by all earlier stages
+			void begin_stage(void);
+			void clear(void);
+			const std::map<std::size_t, std::size_t>& ranges(void) const;
+			// one entry per pair of overlapping stages
+			std::vector<klib::patch::Overlap> overlaps(void) const;
+			// total bytes covered by all ranges
+			std::size_t size(void) const;
+		};
+
+		// while alive, every ROM write on this thread is added to the given journal
+		class Recording {
+			klib::patch::Journal* m_previous;
+
+		public:
+			explicit Recording(klib::patch::Journal& p_journal);
+			~Recording(void);
+			Recording(const Recording&) = delete;
+			Recording& operator=(const Recording&) = delete;
+		};
+
+		// called by the ROM write primitives; does nothing outside a Recording
+		void record(std::size_t p_offset, std::size_t p_size);
+
+		// bulk ROM writes; the whole range is bounds-checked once, and recorded
+		void write(klib::RomImage& p_rom, std::size_t p_offset, std::span<const byte> p_bytes);
+		void fill(klib::RomImage& p_rom, std::size_t p_offset, std::size_t p_size, byte p_value);
+		// the target is recorded but not claimed, since it only repeats data written elsewhere
+		void copy(klib::RomImage& p_rom, std::size_t p_source_offset,
+			std::size_t p_target_offset, std::size_t p_size);
+
+		// only journaled bytes that differ from the source end up in a patch;
+		// bytes past the end of the source are always included
+		std::vector<byte> create_ips(std::span<const byte> p_source,
+			std::span<const byte> p_target, const klib::patch::Journal& p_journal);
+		std::vector<byte> create_bps(std::span<const byte> p_source,
+			std::span<const byte> p_target, const klib::patch::Journal& p_journal);
+
+	}
+
+}
+
+#endif
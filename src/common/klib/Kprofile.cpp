@@ -0,0 +1,216 @@
+#include "Kprofile.h"
+#include "Kstring.h"
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <mutex>
+
+namespace {
+
+	std::atomic<bool> g_enabled{ false };
+	std::mutex g_mutex;
+	std::vector<klib::prof::Span> g_spans;
+
+	struct PhaseTotal {
+		std::string name;
+		std::size_t calls{ 0 };
+		klib::prof::clock::duration duration{ 0 };
+		std::vector<std::pair<std::string, std::size_t>> counters;
+	};
+
+	double to_ms(klib::prof::clock::duration p_duration) {
+		return std::chrono::duration<double, std::milli>(p_duration).count();
+	}
+
+	void add_counter(std::vector<std::pair<std::string, std::size_t>>& p_counters,
+		std::string_view p_counter, std::size_t p_value) {
+		for (auto& counter : p_counters)
+			if (counter.first == p_counter) {
+				counter.second += p_value;
+				return;
+			}
+
+		p_counters.push_back(std::make_pair(std::string(p_counter), p_value));
+	}
+
+	// aggregate all spans by name, ordered by the first time each phase started
+	std::vector<PhaseTotal> get_phase_totals(klib::prof::clock::duration& p_wall_time) {
+		auto spans{ klib::prof::get_spans() };
+		std::stable_sort(begin(spans), end(spans),
+			[](const klib::prof::Span& a, const klib::prof::Span& b) {
+				return a.start < b.start;
+			});
+
+		std::vector<PhaseTotal> result;
+		p_wall_time = klib::prof::clock::duration(0);
+
+		if (spans.empty())
+			return result;
+
+		auto l_end{ spans.front().start };
+
+		for (const auto& span : spans) {
+			auto iter{ std::find_if(begin(result), end(result),
+				[&span](const PhaseTotal& p) { return p.name == span.name; }) };
+
+			if (iter == end(result)) {
+				result.push_back(PhaseTotal{ span.name });
+				iter = end(result) - 1;
+			}
+
+			++iter->calls;
+			iter->duration += span.duration;
+			for (const auto& counter : span.counters)
+				add_counter(iter->counters, counter.first, counter.second);
+
+			l_end = std::max(l_end, span.start + span.duration);
+		}
+
+		p_wall_time = l_end - spans.front().start;
+
+		return result;
+	}
+
+}
+
+void klib::prof::set_enabled(bool p_enabled) {
+	g_enabled = p_enabled;
+}
+
+bool klib::prof::is_enabled(void) {
+	return g_enabled;
+}
+
+std::vector<klib::prof::Span> klib::prof::get_spans(void) {
+	std::lock_guard<std::mutex> lock(g_mutex);
+	return g_spans;
+}
+
+void klib::prof::clear(void) {
+	std::lock_guard<std::mutex> lock(g_mutex);
+	g_spans.clear();
+}
+
+std::string klib::prof::summary_table(void) {
+	klib::prof::clock::duration l_wall_time;
+	const auto totals{ get_phase_totals(l_wall_time) };
+
+	std::string result{ std::format("{:<48} {:>7} {:>12}  {}\n",
+		"Phase", "Calls", "Time (ms)", "Counters") };
+
+	for (const auto& total : totals) {
+		result += std::format("{:<48} {:>7} {:>12.3f}",
+			total.name, total.calls, to_ms(total.duration));
+
+		for (std::size_t i{ 0 }; i < total.counters.size(); ++i)
+			result += std::format("{}{}={}", i == 0 ? "  " : " ",
+				total.counters[i].first, total.counters[i].second);
+
+		result += "\n";
+	}
+
+	// phases nest, so their times do not add up to the wall time
+	result += std::format("\nTotal wall time: {:.3f} ms\n", to_ms(l_wall_time));
+
+	return result;
+}
+
+std::string klib::prof::summary_json(void) {
+	klib::prof::clock::duration l_wall_time;
+	const auto totals{ get_phase_totals(l_wall_time) };
+
+	std::string result{ std::format("{{\n  \"wall_ms\": {:.3f},\n  \"phases\": [", to_ms(l_wall_time)) };
+
+	for (std::size_t i{ 0 }; i < totals.size(); ++i) {
+		const auto& total{ totals[i] };
+
+		result += std::format("{}\n    {{ \"name\": \"{}\", \"calls\": {}, \"ms\": {:.3f}, \"counters\": {{",
+			i == 0 ? "" : ",", klib::str::json_escape(total.name), total.calls, to_ms(total.duration));
+
+		for (std::size_t j{ 0 }; j < total.counters.size(); ++j)
+			result += std::format("{} \"{}\": {}", j == 0 ? "" : ",",
+				klib::str::json_escape(total.counters[j].first), total.counters[j].second);
+
+		result += total.counters.empty() ? "} }" : " } }";
+	}
+
+	result += "\n  ]\n}\n";
+
+	return result;
+}
+
+std::string klib::prof::trace_json(void) {
+	auto spans{ klib::prof::get_spans() };
+	std::stable_sort(begin(spans), end(spans),
+		[](const klib::prof::Span& a, const klib::prof::Span& b) {
+			return a.start < b.start;
+		});
+
+	// number the threads in the order they started working; the first one is the main thread
+	std::vector<std::thread::id> threads;
+	for (const auto& span : spans)
+		if (std::find(begin(threads), end(threads), span.thread) == end(threads))
+			threads.push_back(span.thread);
+
+	std::string result{ "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [" };
+
+	for (std::size_t i{ 0 }; i < threads.size(); ++i)
+		result += std::format("{}\n    {{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": {}, \"args\": {{ \"name\": \"{}\" }} }}",
+			i == 0 ? "" : ",", i + 1, i == 0 ? "main" : std::format("worker {}", i));
+
+	const auto l_origin{ spans.empty() ? klib::prof::clock::time_point() : spans.front().start };
+
+	for (const auto& span : spans) {
+		const auto l_tid{ std::find(begin(threads), end(threads), span.thread) - begin(threads) + 1 };
+
+		result += std::format(",\n    {{ \"name\": \"{}\", \"ph\": \"X\", \"pid\": 1, \"tid\": {}, \"ts\": {:.3f}, \"dur\": {:.3f}, \"args\": {{",
+			klib::str::json_escape(span.name), l_tid,
+			std::chrono::duration<double, std::micro>(span.start - l_origin).count(),
+			std::chrono::duration<double, std::micro>(span.duration).count());
+
+		bool l_first{ true };
+
+		if (!span.detail.empty()) {
+			result += std::format(" \"detail\": \"{}\"", klib::str::json_escape(span.detail));
+			l_first = false;
+		}
+
+		for (const auto& counter : span.counters) {
+			result += std::format("{} \"{}\": {}", l_first ? "" : ",",
+				klib::str::json_escape(counter.first), counter.second);
+			l_first = false;
+		}
+
+		result += l_first ? "} }" : " } }";
+	}
+
+	result += "\n  ]\n}\n";
+
+	return result;
+}
+
+klib::prof::Scope::Scope(std::string_view p_name, std::string_view p_detail) :
+	m_active{ g_enabled }
+{
+	if (m_active) {
+		m_span.name = std::string(p_name);
+		m_span.detail = std::string(p_detail);
+		m_span.thread = std::this_thread::get_id();
+		m_span.start = klib::prof::clock::now();
+	}
+}
+
+klib::prof::Scope::~Scope(void) {
+	if (!m_active)
+		return;
+
+	m_span.duration = klib::prof::clock::now() - m_span.start;
+
+	std::lock_guard<std::mutex> lock(g_mutex);
+	g_spans.push_back(std::move(m_span));
+}
+
+void klib::prof::Scope::count(std::string_view p_counter, std::size_t p_value) {
+	if (m_active)
+		add_counter(m_span.counters, p_counter, p_value);
+}
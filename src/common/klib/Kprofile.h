@@ -0,0 +1,69 @@
+#ifndef KLIB_KPROFILE_H
+#define KLIB_KPROFILE_H
+
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace klib {
+
+	namespace prof {
+
+		using clock = std::chrono::steady_clock;
+
+		// one timed phase, recorded when its scope ends
+		struct Span {
+			// spans are aggregated by name; the detail only shows in traces
+			std::string name, detail;
+			std::thread::id thread;
+			clock::time_point start;
+			clock::duration duration;
+			std::vector<std::pair<std::string, std::size_t>> counters;
+		};
+
+		// process-wide switch; nothing is recorded while disabled
+		void set_enabled(bool p_enabled);
+		bool is_enabled(void);
+
+		std::vector<klib::prof::Span> get_spans(void);
+		void clear(void);
+
+		// per-phase totals (calls, wall time, summed counters) in first-seen order
+		std::string summary_table(void);
+		std::string summary_json(void);
+
+		// every span as a Chrome trace event, one lane per thread
+		std::string trace_json(void);
+
+		// times the enclosing block as one phase
+		class Scope {
+			bool m_active;
+			klib::prof::Span m_span;
+
+		public:
+			Scope(std::string_view p_name, std::string_view p_detail = {});
+			~Scope(void);
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+			// add to a named counter of this phase
+			void count(std::string_view p_counter, std::size_t p_value);
+
+			// only formatted while profiling
+			template<class... Args>
+			void detail(std::format_string<Args...> p_fmt, Args&&... p_args) {
+				if (m_active)
+					m_span.detail = std::format(p_fmt, std::forward<Args>(p_args)...);
+			}
+		};
+
+	}
+
+}
+
+#endif
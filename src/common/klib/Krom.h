@@ -0,0 +1,169 @@
+#ifndef KLIB_KROM_H
+#define KLIB_KROM_H
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using byte = unsigned char;
+
+namespace klib {
+
+	// non-owning, read-only view of a ROM image, shared by the loaders instead of
+	// copying the image; the viewed buffer or mapping must outlive it
+	class RomView {
+		std::span<const byte> m_data;
+
+	public:
+		RomView(void) = default;
+		RomView(std::span<const byte> p_data) :
+			m_data{ p_data }
+		{
+		}
+		RomView(const std::vector<byte>& p_data) :
+			m_data{ p_data }
+		{
+		}
+
+		// bounds-checked like std::vector::at
+		byte at(std::size_t p_offset) const {
+			if (p_offset >= m_data.size())
+				throw std::out_of_range("ROM read out of bounds");
+			return m_data[p_offset];
+		}
+
+		byte operator[](std::size_t p_offset) const {
+			return m_data[p_offset];
+		}
+
+		std::size_t size(void) const {
+			return m_data.size();
+		}
+
+		const byte* data(void) const {
+			return m_data.data();
+		}
+
+		std::span<const byte>::iterator begin(void) const {
+			return m_data.begin();
+		}
+
+		std::span<const byte>::iterator end(void) const {
+			return m_data.end();
+		}
+
+		std::span<const byte> bytes(void) const {
+			return m_data;
+		}
+	};
+
+	// a ROM image that builds write to; it either owns its bytes, or writes into
+	// storage kept alive by an owner, like a copy-on-write mapping of the ROM file.
+	// copies always own their bytes, so they never share writes with the original
+	class RomImage {
+		std::vector<byte> m_buffer;
+		std::shared_ptr<void> m_storage;
+		std::span<byte> m_data;
+
+	public:
+		RomImage(void) = default;
+		explicit RomImage(std::vector<byte> p_bytes) :
+			m_buffer{ std::move(p_bytes) },
+			m_data{ m_buffer }
+		{
+		}
+		RomImage(std::span<byte> p_data, std::shared_ptr<void> p_storage) :
+			m_storage{ std::move(p_storage) },
+			m_data{ p_data }
+		{
+		}
+		RomImage(const RomImage& p_other) :
+			m_buffer(p_other.m_data.begin(), p_other.m_data.end()),
+			m_data{ m_buffer }
+		{
+		}
+		// a moved vector keeps its heap buffer, so the span stays valid
+		RomImage(RomImage&& p_other) noexcept :
+			m_buffer{ std::move(p_other.m_buffer) },
+			m_storage{ std::move(p_other.m_storage) },
+			m_data{ std::exchange(p_other.m_data, std::span<byte>()) }
+		{
+		}
+		RomImage& operator=(const RomImage& p_other) {
+			if (this != &p_other)
+				*this = RomImage(p_other);
+			return *this;
+		}
+		RomImage& operator=(RomImage&& p_other) noexcept {
+			if (this != &p_other) {
+				m_buffer = std::move(p_other.m_buffer);
+				m_storage = std::move(p_other.m_storage);
+				m_data = std::exchange(p_other.m_data, std::span<byte>());
+			}
+			return *this;
+		}
+
+		// bounds-checked like std::vector::at
+		byte& at(std::size_t p_offset) {
+			if (p_offset >= m_data.size())
+				throw std::out_of_range("ROM access out of bounds");
+			return m_data[p_offset];
+		}
+
+		byte at(std::size_t p_offset) const {
+			if (p_offset >= m_data.size())
+				throw std::out_of_range("ROM access out of bounds");
+			return m_data[p_offset];
+		}
+
+		byte& operator[](std::size_t p_offset) {
+			return m_data[p_offset];
+		}
+
+		byte operator[](std::size_t p_offset) const {
+			return m_data[p_offset];
+		}
+
+		std::size_t size(void) const {
+			return m_data.size();
+		}
+
+		byte* data(void) {
+			return m_data.data();
+		}
+
+		const byte* data(void) const {
+			return m_data.data();
+		}
+
+		std::span<byte>::iterator begin(void) {
+			return m_data.begin();
+		}
+
+		std::span<byte>::iterator end(void) {
+			return m_data.end();
+		}
+
+		std::span<const byte>::iterator begin(void) const {
+			return bytes().begin();
+		}
+
+		std::span<const byte>::iterator end(void) const {
+			return bytes().end();
+		}
+
+		std::span<const byte> bytes(void) const {
+			return m_data;
+		}
+
+		operator klib::RomView(void) const {
+			return klib::RomView(bytes());
+		}
+	};
+
+}
+
+#endif
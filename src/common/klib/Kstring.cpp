@@ -5,6 +5,28 @@
 
 using byte = unsigned char;
 
+klib::str::ParseError::ParseError(const std::string& p_message, std::size_t p_line, std::size_t p_column) :
+	std::runtime_error(p_column == 0 ?
+		std::format("{} (line {})", p_message, p_line) :
+		std::format("{} (line {} col {})", p_message, p_line, p_column)),
+	m_message{ p_message },
+	m_line{ p_line },
+	m_column{ p_column }
+{
+}
+
+const std::string& klib::str::ParseError::message(void) const {
+	return m_message;
+}
+
+std::size_t klib::str::ParseError::line(void) const {
+	return m_line;
+}
+
+std::size_t klib::str::ParseError::column(void) const {
+	return m_column;
+}
+
 int klib::str::parse_numeric(const std::string& token) {
 	if (token.empty())
 		throw std::runtime_error("Empty index token");
@@ -245,6 +267,21 @@ std::string klib::str::to_binary(byte b) {
 	return s;
 }
 
+std::string klib::str::json_escape(const std::string& p_value) {
+	std::string result;
+
+	for (char c : p_value) {
+		if (c == '"' || c == '\\')
+			result += std::format("\\{}", c);
+		else if (static_cast<unsigned char>(c) < 0x20)
+			result += std::format("\\u{:04x}", static_cast<int>(c));
+		else
+			result += c;
+	}
+
+	return result;
+}
+
 bool klib::str::parse_bool_ci(const std::string& p_str) {
 	const std::string str{ to_lower(trim(p_str)) };
 
@@ -14,6 +14,20 @@ namespace klib {
 
 	namespace str {
 
+		// an input error tied to a position in the source file; line and column
+		// are 1-based, and 0 when unknown
+		class ParseError : public std::runtime_error {
+			std::string m_message;
+			std::size_t m_line, m_column;
+
+		public:
+			ParseError(const std::string& p_message, std::size_t p_line, std::size_t p_column = 0);
+			// the message without the position
+			const std::string& message(void) const;
+			std::size_t line(void) const;
+			std::size_t column(void) const;
+		};
+
 		std::string strip_comment(const std::string& line, char p_comment_char = ';');
 		bool str_begins_with(const std::string& p_line, const std::string& p_start);
 		bool str_equals_icase(const std::string& p_str_a, const std::string& p_str_b);
@@ -30,6 +44,7 @@ namespace klib {
 
 		std::pair<std::string, std::string> parse_define(const std::string& str);
 		std::string to_binary(byte b);
+		std::string json_escape(const std::string& p_value);
 
 		int parse_numeric(const std::string& token);
 
@@ -0,0 +1,68 @@
+#include "Kverify.h"
+#include <format>
+#include <stdexcept>
+
+klib::verify::CodeWalker::CodeWalker(klib::RomView p_rom,
+	std::vector<std::pair<std::size_t, std::size_t>> p_regions) :
+	m_rom{ p_rom },
+	m_regions{ std::move(p_regions) }
+{
+}
+
+void klib::verify::CodeWalker::add_instruction(std::size_t p_offset, std::size_t p_size) {
+	m_index.insert(std::make_pair(p_offset, m_instructions.size()));
+	m_instructions.push_back(std::make_pair(p_offset, p_size));
+	m_visited.push_back(false);
+}
+
+std::size_t klib::verify::CodeWalker::instruction_count(void) const {
+	return m_instructions.size();
+}
+
+bool klib::verify::CodeWalker::in_region(std::size_t p_offset, std::size_t p_size) const {
+	for (const auto& [start, end] : m_regions)
+		if (p_offset >= start && p_offset + p_size <= end)
+			return true;
+	return false;
+}
+
+byte klib::verify::CodeWalker::read_byte(std::size_t p_offset) const {
+	if (p_offset >= m_rom.size())
+		throw std::runtime_error(std::format("ROM offset 0x{:06x} is past the end of the ROM", p_offset));
+	return m_rom[p_offset];
+}
+
+std::size_t klib::verify::CodeWalker::read_short(std::size_t p_offset) const {
+	return static_cast<std::size_t>(read_byte(p_offset)) +
+		256 * static_cast<std::size_t>(read_byte(p_offset + 1));
+}
+
+std::optional<std::size_t> klib::verify::CodeWalker::find(std::size_t p_offset) const {
+	auto iter{ m_index.find(p_offset) };
+	if (iter == end(m_index))
+		return std::nullopt;
+	return iter->second;
+}
+
+std::size_t klib::verify::CodeWalker::jump(std::size_t p_from, std::size_t p_target) {
+	auto l_index{ find(p_target) };
+	if (!l_index.has_value())
+		throw std::runtime_error(std::format("Jump at ROM offset 0x{:06x} targets 0x{:06x}, which is not the start of an instruction",
+			p_from, p_target));
+
+	m_worklist.push_back(l_index.value());
+	return l_index.value();
+}
+
+void klib::verify::CodeWalker::check_region(std::size_t p_index) const {
+	const auto& [offset, size] { m_instructions[p_index] };
+	if (!in_region(offset, size))
+		throw std::runtime_error(std::format("Instruction at ROM offset 0x{:06x} lies outside the script data regions", offset));
+}
+
+void klib::verify::CodeWalker::check_fall_through(std::size_t p_index) const {
+	const auto& [offset, size] { m_instructions[p_index] };
+	if (p_index + 1 == m_instructions.size() ||
+		m_instructions[p_index + 1].first != offset + size)
+		throw std::runtime_error(std::format("Code path does not end after the instruction at ROM offset 0x{:06x}", offset));
+}
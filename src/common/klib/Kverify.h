@@ -0,0 +1,82 @@
+#ifndef KLIB_KVERIFY_H
+#define KLIB_KVERIFY_H
+
+#include "Krom.h"
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace klib {
+
+	namespace verify {
+
+		// walks the code paths of linked script instructions through the ROM they
+		// were written to; every instruction is visited at most once, and all
+		// problems are thrown as std::runtime_error naming a ROM offset
+		class CodeWalker {
+			klib::RomView m_rom;
+			// [start, end) ROM offsets the script data may occupy
+			std::vector<std::pair<std::size_t, std::size_t>> m_regions;
+			// (ROM offset, size) of each instruction, in link order
+			std::vector<std::pair<std::size_t, std::size_t>> m_instructions;
+			// ROM offset -> instruction index
+			std::unordered_map<std::size_t, std::size_t> m_index;
+			std::vector<bool> m_visited;
+			// instruction indexes reached by jumps, still to be walked
+			std::vector<std::size_t> m_worklist;
+
+			// throws unless the instruction lies inside a region
+			void check_region(std::size_t p_index) const;
+			// throws unless the next instruction directly follows this one
+			void check_fall_through(std::size_t p_index) const;
+
+		public:
+			CodeWalker(klib::RomView p_rom,
+				std::vector<std::pair<std::size_t, std::size_t>> p_regions);
+
+			// instructions must be added in link order
+			void add_instruction(std::size_t p_offset, std::size_t p_size);
+			std::size_t instruction_count(void) const;
+
+			bool in_region(std::size_t p_offset, std::size_t p_size) const;
+			// bounds-checked ROM reads, throwing std::runtime_error
+			byte read_byte(std::size_t p_offset) const;
+			std::size_t read_short(std::size_t p_offset) const;
+
+			// index of the instruction starting at the ROM offset, if any
+			std::optional<std::size_t> find(std::size_t p_offset) const;
+			// queues the jump target and returns its index; throws if the jump at
+			// p_from does not land on the start of an instruction
+			std::size_t jump(std::size_t p_from, std::size_t p_target);
+
+			// walks every path from the instruction at p_index, including queued jumps;
+			// p_step(index) is called the first time an instruction is reached, and
+			// returns false if the path ends there
+			template<class Step>
+			void walk(std::size_t p_index, Step&& p_step) {
+				m_worklist.push_back(p_index);
+
+				while (!m_worklist.empty()) {
+					std::size_t l_index{ m_worklist.back() };
+					m_worklist.pop_back();
+
+					for (; !m_visited[l_index]; ++l_index) {
+						m_visited[l_index] = true;
+						check_region(l_index);
+
+						if (!p_step(l_index))
+							break;
+
+						check_fall_through(l_index);
+					}
+				}
+			}
+		};
+
+	}
+
+}
+
+#endif
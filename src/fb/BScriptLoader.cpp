@@ -1,11 +1,12 @@
 #include "BScriptLoader.h"
 #include "fb_constants.h"
 #include "BScriptOpcode.h"
+#include "./../common/klib/Kprofile.h"
 #include <format>
 #include <stdexcept>
 
 fb::BScriptLoader::BScriptLoader(const fe::Config& p_config,
-	const std::vector<byte>& p_rom) :
+	klib::RomView p_rom) :
 	m_rom{ p_rom },
 	m_bscript_ptr{ p_config.pointer(c::ID_BSCRIPT_PTR) },
 	m_bscript_count{ p_config.constant(c::ID_SPRITE_COUNT) },
@@ -21,8 +22,11 @@ fb::BScriptLoader::BScriptLoader(const fe::Config& p_config,
 }
 
 void fb::BScriptLoader::parse_rom(void) {
-	for (std::size_t ep : m_ptr_table)
-		parse_blob_from_entrypoint(ep, m_bscript_ptr.second);
+	for (std::size_t i{ 0 }; i < m_ptr_table.size(); ++i) {
+		klib::prof::Scope l_prof("BScriptLoader::parse_blob_from_entrypoint");
+		l_prof.detail("sprite {}", i);
+		parse_blob_from_entrypoint(m_ptr_table[i], m_bscript_ptr.second);
+	}
 }
 
 void fb::BScriptLoader::parse_blob_from_entrypoint(std::size_t offset, std::size_t p_zero_addr) {
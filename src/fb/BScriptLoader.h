@@ -6,6 +6,7 @@
 #include <set>
 #include <vector>
 #include "./../fe/Config.h"
+#include "./../common/klib/Krom.h"
 #include "BScriptOpcode.h"
 
 using byte = unsigned char;
@@ -15,7 +16,7 @@ namespace fb {
 	class BScriptLoader {
 		// TODO: Change visibility
 	public:
-		std::vector<byte> m_rom;
+		klib::RomView m_rom;
 		std::size_t m_bscript_count;
 		std::pair<std::size_t, std::size_t> m_bscript_ptr;
 		std::vector<std::size_t> m_ptr_table;
@@ -34,7 +35,7 @@ namespace fb {
 
 	public:
 		BScriptLoader(const fe::Config& p_config,
-			const std::vector<byte>& p_rom);
+			klib::RomView p_rom);
 		void parse_rom(void);
 
 	};
@@ -1,7 +1,9 @@
 #include "BScriptReader.h"
 #include "fb_constants.h"
 #include "./../common/klib/Kfile.h"
+#include "./../common/klib/Kprofile.h"
 #include "./../common/klib/Kstring.h"
+#include "./../common/klib/Kverify.h"
 #include <format>
 #include <stdexcept>
 
@@ -12,20 +14,34 @@ fb::BScriptReader::BScriptReader(const fe::Config& p_config) :
 	bscript_count{ p_config.constant(c::ID_SPRITE_COUNT) },
 	rg_1_end{ p_config.constant(c::ID_BSCRIPT_RG1_END) },
 	rg_2_start{ p_config.constant(c::ID_BSCRIPT_RG2_START) },
-	rg_2_end{ p_config.constant(c::ID_BSCRIPT_RG2_END) }
+	rg_2_end{ p_config.constant(c::ID_BSCRIPT_RG2_END) },
+	source_line_no{ 0 }
 {
 }
 
 void fb::BScriptReader::read_asm_file(const std::string& p_filename,
 	const fe::Config& p_config) {
+	try {
+		parse_asm_file(p_filename, p_config);
+	}
+	catch (const std::runtime_error& ex) {
+		if (source_line_no == 0)
+			throw;
+		throw klib::str::ParseError(ex.what(), source_line_no);
+	}
+}
 
-	std::map<fb::SectionType, std::vector<std::string>> sections;
+void fb::BScriptReader::parse_asm_file(const std::string& p_filename,
+	const fe::Config& p_config) {
+
+	// (line number, line) for each non-empty line in a section
+	std::map<fb::SectionType, std::vector<std::pair<std::size_t, std::string>>> sections;
 
 	auto l_lines{ klib::file::read_file_as_strings(p_filename) };
 	fb::SectionType currentSection{ fb::SectionType::Defines };
 
-	for (auto& line : l_lines) {
-		line = klib::str::trim(klib::str::strip_comment(line));
+	for (std::size_t i{ 0 }; i < l_lines.size(); ++i) {
+		const auto line{ klib::str::trim(klib::str::strip_comment(l_lines[i])) };
 
 		if (line == c::SECTION_DEFINES) {
 			currentSection = fb::SectionType::Defines;
@@ -34,15 +50,17 @@ void fb::BScriptReader::read_asm_file(const std::string& p_filename,
 			currentSection = fb::SectionType::BScript;
 		}
 		else if (!line.empty())
-			sections[currentSection].push_back(line);
+			sections[currentSection].push_back(std::make_pair(i + 1, line));
 	}
 
 	// populate defines
 	if (sections.contains(fb::SectionType::Defines))
-		for (const std::string& s : sections[fb::SectionType::Defines]) {
+		for (const auto& [s_line_no, s] : sections[fb::SectionType::Defines]) {
+			source_line_no = s_line_no;
 			const auto def{ klib::str::parse_define(s) };
 			defines.insert(std::make_pair(def.first, klib::str::parse_numeric(def.second)));
 		}
+	source_line_no = 0;
 
 	if (!sections.contains(fb::SectionType::BScript))
 		throw std::runtime_error(std::format("File {} is missing section {}", p_filename, c::SECTION_BSCRIPT));
@@ -135,7 +153,8 @@ void fb::BScriptReader::read_asm_file(const std::string& p_filename,
 	std::size_t offset{ 0 };
 
 	for (std::size_t line_no{ 0 }; line_no < sections.at(fb::SectionType::BScript).size(); ++line_no) {
-		std::string line{ sections.at(fb::SectionType::BScript).at(line_no) };
+		source_line_no = sections.at(fb::SectionType::BScript).at(line_no).first;
+		std::string line{ sections.at(fb::SectionType::BScript).at(line_no).second };
 		auto rawargs{ klib::str::split_string(line, '=') };
 		for (auto& str : rawargs)
 			str = klib::str::trim(str);
@@ -213,6 +232,7 @@ void fb::BScriptReader::read_asm_file(const std::string& p_filename,
 			offset += instr.size();
 		}
 	}
+	source_line_no = 0;
 
 	// patch all unresolved jump targets
 	// and make them point to the correct instruction index
@@ -412,3 +432,63 @@ std::pair<std::vector<byte>, std::vector<byte>> fb::BScriptReader::to_bytes(void
 
 	return std::make_pair(result_a, result_b);
 }
+
+// walks every code path of the patched ROM once, checking it against the
+// linked instruction offsets instead of disassembling the ROM again
+void fb::BScriptReader::verify_rom(klib::RomView p_rom) const {
+	klib::prof::Scope l_prof("BScriptReader::verify_rom");
+
+	const std::size_t l_zero_addr{ bscript_ptr.second };
+
+	klib::verify::CodeWalker walker(p_rom, {
+		{ bscript_ptr.first + 2 * bscript_count, rg_1_end },
+		{ rg_2_start, rg_2_end }
+		});
+
+	for (const auto& instr : instructions)
+		walker.add_instruction(instr.byte_offset.value() + l_zero_addr, instr.size());
+
+	const auto step{ [&](std::size_t instr_no) {
+		const auto& instr{ instructions[instr_no] };
+		const std::size_t offset{ instr.byte_offset.value() + l_zero_addr };
+
+		if (walker.read_byte(offset) != instr.opcode_byte ||
+			(instr.behavior_byte.has_value() && walker.read_byte(offset + 1) != instr.behavior_byte.value()))
+			throw std::runtime_error(std::format("ROM bytes at offset 0x{:06x} do not match the linked opcode", offset));
+
+		const auto& ops{ instr.behavior_byte.has_value() ? behavior_ops : opcodes };
+		const auto op_iter{ ops.find(instr.behavior_byte.value_or(instr.opcode_byte)) };
+		if (op_iter == end(ops))
+			throw std::runtime_error(std::format("Undefined opcode at ROM offset 0x{:06x}", offset));
+		const auto& opcode{ op_iter->second };
+
+		// follow all jump arguments
+		std::size_t arg_offset{ offset + (instr.behavior_byte.has_value() ? 2 : 1) };
+		for (const auto& templarg : opcode.args) {
+			if (templarg.domain == fb::ArgDomain::Addr ||
+				templarg.domain == fb::ArgDomain::TrueAddr ||
+				templarg.domain == fb::ArgDomain::FalseAddr)
+				walker.jump(offset, walker.read_short(arg_offset) + l_zero_addr);
+
+			arg_offset += templarg.data_type == fb::ArgDataType::Byte ? 1 : 2;
+		}
+
+		return opcode.flow != fb::Flow::End && opcode.flow != fb::Flow::Jump;
+	} };
+
+	for (std::size_t i{ 0 }; i < ptr_table.size(); ++i) {
+		std::size_t ptr{ walker.read_short(bscript_ptr.first + 2 * i) };
+		if (ptr != ptr_table[i])
+			throw std::runtime_error(std::format("Pointer table entry {} reads 0x{:04x}, but was linked as 0x{:04x}",
+				i, ptr, ptr_table[i]));
+
+		const auto instr_no{ walker.find(ptr + l_zero_addr) };
+		if (!instr_no.has_value())
+			throw std::runtime_error(std::format("Pointer table entry {} points to ROM offset 0x{:06x}, which is not the start of an instruction",
+				i, ptr + l_zero_addr));
+
+		walker.walk(instr_no.value(), step);
+	}
+
+	l_prof.count("instructions", instructions.size());
+}
@@ -1,6 +1,7 @@
 #ifndef FB_BSCRIPTREADER_H
 #define FB_BSCRIPTREADER_H
 
+#include "./../common/klib/Krom.h"
 #include "./../fe/Config.h"
 #include "BScriptOpcode.h"
 #include <map>
@@ -22,6 +23,8 @@ namespace fb {
 		std::map<std::string, int> defines;
 		std::vector<fb::BScriptInstruction> instructions;
 		std::vector<std::size_t> ptr_table;
+		// the source line being parsed, or 0 between lines
+		std::size_t source_line_no;
 
 		bool is_label(const std::string& p_asm, const std::vector<std::string>& p_line) const;
 		std::string get_label(const std::vector<std::string>& p_line) const;
@@ -42,12 +45,18 @@ namespace fb {
 		int get_default_value(const std::string& p_asm, fb::ArgDomain domain) const;
 
 		std::size_t find_split_index(std::size_t region1_capacity_bytes) const;
+		void parse_asm_file(const std::string& p_filename,
+			const fe::Config& p_config);
 
 	public:
 		BScriptReader(const fe::Config& p_config);
+		// errors on a specific line are thrown as klib::str::ParseError
 		void read_asm_file(const std::string& p_filename,
 			const fe::Config& p_config);
 		std::pair<std::vector<byte>, std::vector<byte>> to_bytes(void) const;
+		// checks the patched ROM against the linked instructions: every code path
+		// ends inside a script data region and every jump lands on an instruction
+		void verify_rom(klib::RomView p_rom) const;
 	};
 
 }
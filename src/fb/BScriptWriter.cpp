@@ -32,22 +32,23 @@ fb::BScriptWriter::BScriptWriter(const fe::Config& p_config) {
 }
 
 std::string fb::BScriptWriter::get_label_name(std::size_t p_ptr_table_idx, std::size_t p_address) const {
-	static std::map<std::size_t, std::string> ls_addr_to_label;
-	static std::map<std::size_t, int> ls_local_counter;
-
-	if (ls_addr_to_label.contains(p_address))
-		return ls_addr_to_label.at(p_address);
+	if (m_addr_to_label.contains(p_address))
+		return m_addr_to_label.at(p_address);
 	else {
-		++ls_local_counter[p_ptr_table_idx];
-		std::string label{ std::format("@label_{}_{}", p_ptr_table_idx, ls_local_counter[p_ptr_table_idx]) };
-		ls_addr_to_label.insert(std::make_pair(p_address, label));
+		++m_local_label_counter[p_ptr_table_idx];
+		std::string label{ std::format("@label_{}_{}", p_ptr_table_idx, m_local_label_counter[p_ptr_table_idx]) };
+		m_addr_to_label.insert(std::make_pair(p_address, label));
 		return label;
 	}
 
 }
 
-void fb::BScriptWriter::write_asm(const std::string& p_filename,
+bool fb::BScriptWriter::write_asm(const std::string& p_filename,
 	const fb::BScriptLoader& loader) const {
+	return klib::file::write_string_to_file(get_asm_string(loader), p_filename);
+}
+
+std::string fb::BScriptWriter::get_asm_string(const fb::BScriptLoader& loader) const {
 	bool rg2_marked{ false };
 
 	std::string af{
@@ -104,7 +105,7 @@ void fb::BScriptWriter::write_asm(const std::string& p_filename,
 		}
 	}
 
-	klib::file::write_string_to_file(af, p_filename);
+	return af;
 }
 
 void fb::BScriptWriter::emit_operand(std::string& p_asm, std::size_t p_value,
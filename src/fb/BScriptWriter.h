@@ -17,6 +17,10 @@ namespace fb {
 		std::map<fb::ArgDomain, std::map<byte, std::string>> defines;
 		std::map<std::size_t, std::string> ram_defines;
 
+		// labels assigned so far, per writer instance
+		mutable std::map<std::size_t, std::string> m_addr_to_label;
+		mutable std::map<std::size_t, int> m_local_label_counter;
+
 		void add_defines(std::string& p_asm) const;
 		void add_defines(std::string& p_asm, const std::string& p_type,
 			fb::ArgDomain p_domain) const;
@@ -29,8 +33,9 @@ namespace fb {
 
 	public:
 		BScriptWriter(const fe::Config& p_config);
-		void write_asm(const std::string& p_filename,
+		bool write_asm(const std::string& p_filename,
 			const fb::BScriptLoader& loader) const;
+		std::string get_asm_string(const fb::BScriptLoader& loader) const;
 
 	};
 
@@ -5,6 +5,7 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include "./../fe/ConfigKey.h"
 
 using byte = unsigned char;
 
@@ -31,19 +32,19 @@ namespace fb {
 	namespace c {
 		constexpr byte OPCODE_BEHAVIOR{ 0x00 };
 
-		constexpr char ID_BSCRIPT_PTR[]{ "bscript_ptr" };
-		constexpr char ID_BSCRIPT_RG1_END[]{ "bscript_data_rg1_end" };
-		constexpr char ID_BSCRIPT_RG2_START[]{ "bscript_data_rg2_start" };
-		constexpr char ID_BSCRIPT_RG2_END[]{ "bscript_data_rg2_end" };
-		constexpr char ID_SPRITE_COUNT[]{ "sprite_count" };
-		constexpr char ID_BSCRIPT_OPCODES[]{ "bscript_opcodes" };
-		constexpr char ID_BSCRIPT_BEHAVIORS[]{ "bscript_behaviors" };
-		constexpr char ID_SPRITE_LABELS[]{ "sprite_labels" };
+		inline const fe::ConfigKey ID_BSCRIPT_PTR{ "bscript_ptr" };
+		inline const fe::ConfigKey ID_BSCRIPT_RG1_END{ "bscript_data_rg1_end" };
+		inline const fe::ConfigKey ID_BSCRIPT_RG2_START{ "bscript_data_rg2_start" };
+		inline const fe::ConfigKey ID_BSCRIPT_RG2_END{ "bscript_data_rg2_end" };
+		inline const fe::ConfigKey ID_SPRITE_COUNT{ "sprite_count" };
+		inline const fe::ConfigKey ID_BSCRIPT_OPCODES{ "bscript_opcodes" };
+		inline const fe::ConfigKey ID_BSCRIPT_BEHAVIORS{ "bscript_behaviors" };
+		inline const fe::ConfigKey ID_SPRITE_LABELS{ "sprite_labels" };
 
-		constexpr char ID_BSCRIPT_DEF_ACTIONS[]{ "bscript_defines_actions" };
-		constexpr char ID_BSCRIPT_DEF_HOPMODES[]{ "bscript_defines_hopmodes" };
-		constexpr char ID_BSCRIPT_DEF_DIRECTIONS[]{ "bscript_defines_directions" };
-		constexpr char ID_BSCRIPT_DEF_RAM[]{ "bscript_defines_ram" };
+		inline const fe::ConfigKey ID_BSCRIPT_DEF_ACTIONS{ "bscript_defines_actions" };
+		inline const fe::ConfigKey ID_BSCRIPT_DEF_HOPMODES{ "bscript_defines_hopmodes" };
+		inline const fe::ConfigKey ID_BSCRIPT_DEF_DIRECTIONS{ "bscript_defines_directions" };
+		inline const fe::ConfigKey ID_BSCRIPT_DEF_RAM{ "bscript_defines_ram" };
 
 		constexpr char SECTION_DEFINES[]{ "[defines]" };
 		constexpr char SECTION_BSCRIPT[]{ "[bscript]" };
@@ -1,23 +1,171 @@
 #include "Config.h"
 #include "./xml/Xml_helper.h"
+#include "./../common/klib/Khash.h"
+#include "./../common/klib/Kprofile.h"
 #include <algorithm>
 #include <format>
 #include <stdexcept>
 
+fe::Config::Config(const fe::Config& p_config) :
+	m_region_defs{ p_config.m_region_defs },
+	m_builtin_match{ p_config.m_builtin_match },
+	m_xml_hash{ p_config.m_xml_hash },
+	m_region{ p_config.m_region },
+	m_constants{ p_config.m_constants },
+	m_pointers{ p_config.m_pointers },
+	m_sets{ p_config.m_sets },
+	m_byte_maps{ p_config.m_byte_maps },
+	m_string_maps{ p_config.m_string_maps },
+	m_bools{ p_config.m_bools },
+	m_bool_conditions{ p_config.m_bool_conditions },
+	m_cache_dir{ p_config.m_cache_dir }
+{
+	build_key_index();
+}
+
+fe::Config& fe::Config::operator=(const fe::Config& p_config) {
+	if (this != &p_config) {
+		m_region_defs = p_config.m_region_defs;
+		m_builtin_match = p_config.m_builtin_match;
+		m_xml_hash = p_config.m_xml_hash;
+		m_region = p_config.m_region;
+		m_constants = p_config.m_constants;
+		m_pointers = p_config.m_pointers;
+		m_sets = p_config.m_sets;
+		m_byte_maps = p_config.m_byte_maps;
+		m_string_maps = p_config.m_string_maps;
+		m_bools = p_config.m_bools;
+		m_bool_conditions = p_config.m_bool_conditions;
+		m_cache_dir = p_config.m_cache_dir;
+		build_key_index();
+	}
+
+	return *this;
+}
+
 void fe::Config::load_definitions(const std::string& p_config_xml,
 	const std::string& p_config_override_xml) {
+	if (!m_cache_dir.empty()) {
+		m_xml_hash = hash_xml_files(p_config_xml, p_config_override_xml);
+
+		if (load_cached_definitions(m_xml_hash.value()))
+			return;
+	}
+
 	m_region_defs = xml::load_region_defs(p_config_override_xml, false);
-	auto base_defs{ xml::load_region_defs(p_config_xml) };
-	m_region_defs.insert(end(m_region_defs), begin(base_defs), end(base_defs));
+
+	if (builtin_matches(p_config_xml))
+		load_builtin_definitions();
+	else {
+		auto base_defs{ xml::load_region_defs(p_config_xml) };
+		m_region_defs.insert(end(m_region_defs), begin(base_defs), end(base_defs));
+	}
+
+	if (!m_cache_dir.empty())
+		save_cached_definitions(m_xml_hash.value());
 }
 
 void fe::Config::load_config_data(const std::string& p_config_xml,
 	const std::string& p_config_override_xml,
-	const std::vector<byte>& p_rom) {
+	klib::RomView p_rom) {
+	std::uint64_t l_key{ 0 };
+
+	if (!m_cache_dir.empty()) {
+		// hashed by load_definitions, unless the cache was enabled in between
+		if (!m_xml_hash.has_value())
+			m_xml_hash = hash_xml_files(p_config_xml, p_config_override_xml);
+
+		l_key = klib::hash::fnv1a_64(m_region.region, m_xml_hash.value());
+
+		if (load_cached_config_data(l_key)) {
+			evaluate_bool_conditions(p_rom);
+			build_key_index();
+			return;
+		}
+	}
+
 	xml::load_configuration(p_config_override_xml, m_region, m_constants,
-		m_pointers, m_sets, m_byte_maps, m_string_maps, m_bools, p_rom, false);
-	xml::load_configuration(p_config_xml, m_region, m_constants,
-		m_pointers, m_sets, m_byte_maps, m_string_maps, m_bools, p_rom);
+		m_pointers, m_sets, m_byte_maps, m_string_maps, m_bools, m_bool_conditions, false);
+	if (!builtin_matches(p_config_xml) || !load_builtin_config_data())
+		xml::load_configuration(p_config_xml, m_region, m_constants,
+			m_pointers, m_sets, m_byte_maps, m_string_maps, m_bools, m_bool_conditions);
+
+	if (!m_cache_dir.empty())
+		save_cached_config_data(l_key);
+
+	evaluate_bool_conditions(p_rom);
+	build_key_index();
+}
+
+void fe::Config::evaluate_bool_conditions(klib::RomView p_rom) {
+	for (const auto& kv : xml::evaluate_bool_conditions(p_rom, m_bool_conditions))
+		m_bools.insert_or_assign(kv.first, kv.second);
+}
+
+void fe::Config::set_cache_dir(const std::string& p_cache_dir) {
+	m_cache_dir = p_cache_dir;
+}
+
+namespace {
+
+	template<class T>
+	void index_by_key(const std::map<std::string, T>& p_map, std::vector<const T*>& p_index) {
+		p_index.clear();
+
+		for (const auto& kv : p_map) {
+			const std::size_t l_handle{ fe::intern_config_key(kv.first) };
+
+			if (l_handle >= p_index.size())
+				p_index.resize(l_handle + 1, nullptr);
+			p_index[l_handle] = &kv.second;
+		}
+	}
+
+	template<class T>
+	const T* find_by_handle(const std::vector<const T*>& p_index, std::uint32_t p_handle) {
+		return p_handle < p_index.size() ? p_index[p_handle] : nullptr;
+	}
+
+	template<class T>
+	const T* find_by_key(const std::vector<const T*>& p_index, const fe::ConfigKey& p_key) {
+		return find_by_handle(p_index, p_key.handle());
+	}
+
+	// past the end of every index, so it never has an entry
+	constexpr std::uint32_t NO_HANDLE{ 0xffffffff };
+
+	// every loaded name is interned when the index is built, so lookups by name
+	// only need to find it; unknown names are not added to the global table
+	std::uint32_t handle(const std::string& p_id) {
+		return fe::find_config_key(p_id).value_or(NO_HANDLE);
+	}
+
+	// build a view on first request; the caller holds the view mutex
+	template<class T, class F>
+	const T& get_view(std::optional<T>& p_view, F p_build) {
+		if (!p_view.has_value())
+			p_view = p_build();
+
+		return p_view.value();
+	}
+
+	const std::vector<byte> EMPTY_SET;
+	const std::map<byte, std::string> EMPTY_BMAP;
+	const std::map<std::string, std::string> EMPTY_STR_MAP;
+
+}
+
+void fe::Config::build_key_index(void) {
+	index_by_key(m_constants, m_constant_index);
+	index_by_key(m_pointers, m_pointer_index);
+	index_by_key(m_sets, m_set_index);
+	index_by_key(m_byte_maps, m_byte_map_index);
+	index_by_key(m_string_maps, m_string_map_index);
+	index_by_key(m_bools, m_bool_index);
+
+	std::lock_guard<std::mutex> lock(m_view_mutex);
+	m_byte_map_views.clear();
+	m_set_views.clear();
 }
 
 std::size_t fe::Config::constant(const std::string& p_id) const {
@@ -42,138 +190,323 @@ std::pair<std::size_t, std::size_t> fe::Config::pointer(const std::string& p_id)
 }
 
 const std::vector<byte>& fe::Config::vset(const std::string& p_id) const {
-	static const std::vector<byte> empty_vec;
-
 	if (m_sets.find(p_id) == end(m_sets))
-		return empty_vec;
+		return EMPTY_SET;
 	else
 		return m_sets.at(p_id);
 }
 
-std::set<byte> fe::Config::vset_as_set(const std::string& p_id) const {
-	std::set<byte> result;
-	const auto& vec{ vset(p_id) };
+const std::map<byte, std::string>& fe::Config::bmap(const std::string& p_id) const {
+	if (m_byte_maps.find(p_id) == end(m_byte_maps))
+		return EMPTY_BMAP;
+	else
+		return m_byte_maps.at(p_id);
+}
 
-	for (byte b : vec)
-		result.insert(b);
+const std::map<std::string, std::string>& fe::Config::str_map(const std::string& p_id) const {
+	if (m_string_maps.find(p_id) == end(m_string_maps))
+		return EMPTY_STR_MAP;
+	else
+		return m_string_maps.at(p_id);
+}
 
-	return result;
+bool fe::Config::boolean(const std::string& p_id) const {
+	if (m_bools.find(p_id) == end(m_bools))
+		throw std::runtime_error(std::format("Configuration Boolean '{}' not found", p_id));
+	else
+		return m_bools.at(p_id);
 }
 
-const std::map<byte, std::string>& fe::Config::bmap(const std::string& p_id) const {
-	static const std::map<byte, std::string> empty_map;
+bool fe::Config::boolean_or(const std::string& p_id, bool p_default) const {
+	if (m_bools.find(p_id) == end(m_bools))
+		return p_default;
+	else
+		return m_bools.at(p_id);
+}
 
-	if (m_byte_maps.find(p_id) == end(m_byte_maps))
-		return empty_map;
+std::size_t fe::Config::constant(const fe::ConfigKey& p_key) const {
+	const auto l_value{ find_by_key(m_constant_index, p_key) };
+	if (l_value == nullptr)
+		throw std::runtime_error(std::format("Constant '{}' not found", p_key.name()));
 	else
-		return m_byte_maps.at(p_id);
+		return *l_value;
 }
 
-const std::map<byte, std::size_t> fe::Config::bmap_numeric(const std::string& p_id) const {
-	std::map<byte, std::size_t> result;
-	const auto& l_bmap{ bmap(p_id) };
+std::size_t fe::Config::constant_or(const fe::ConfigKey& p_key, std::size_t p_default) const {
+	const auto l_value{ find_by_key(m_constant_index, p_key) };
+	return l_value == nullptr ? p_default : *l_value;
+}
 
-	for (const auto& kv : l_bmap)
-		result.insert(std::make_pair(kv.first, xml::parse_numeric(kv.second)));
+std::pair<std::size_t, std::size_t> fe::Config::pointer(const fe::ConfigKey& p_key) const {
+	const auto l_value{ find_by_key(m_pointer_index, p_key) };
+	if (l_value == nullptr)
+		throw std::runtime_error(std::format("Pointer '{}' not found", p_key.name()));
+	else
+		return *l_value;
+}
 
-	return result;
+const std::vector<byte>& fe::Config::vset(const fe::ConfigKey& p_key) const {
+	return vset(p_key.handle());
 }
 
-std::map<std::string, byte> fe::Config::bmap_reverse(const std::string& p_id) const {
-	std::map<std::string, byte> result;
-	const auto& l_bmap{ bmap(p_id) };
+const std::map<byte, std::string>& fe::Config::bmap(const fe::ConfigKey& p_key) const {
+	return bmap(p_key.handle());
+}
 
-	for (const auto& kv : l_bmap)
-		result.insert(std::make_pair(kv.second, kv.first));
+const std::map<std::string, std::string>& fe::Config::str_map(const fe::ConfigKey& p_key) const {
+	const auto l_value{ find_by_key(m_string_map_index, p_key) };
+	return l_value == nullptr ? EMPTY_STR_MAP : *l_value;
+}
 
-	return result;
+bool fe::Config::boolean(const fe::ConfigKey& p_key) const {
+	const auto l_value{ find_by_key(m_bool_index, p_key) };
+	if (l_value == nullptr)
+		throw std::runtime_error(std::format("Configuration Boolean '{}' not found", p_key.name()));
+	else
+		return *l_value;
 }
 
-std::map<std::size_t, byte> fe::Config::bmap_numeric_reverse(const std::string& p_id) const {
-	std::map<std::size_t, byte> result;
-	const auto& l_bmap{ bmap(p_id) };
+bool fe::Config::boolean_or(const fe::ConfigKey& p_key, bool p_default) const {
+	const auto l_value{ find_by_key(m_bool_index, p_key) };
+	return l_value == nullptr ? p_default : *l_value;
+}
 
-	for (const auto& kv : l_bmap)
-		result.insert(std::make_pair(xml::parse_numeric(kv.second), kv.first));
+// derived views by name and by key
 
-	return result;
+const std::set<byte>& fe::Config::vset_as_set(const std::string& p_id) const {
+	return vset_as_set(handle(p_id));
+}
+
+const fe::ByteTable<const std::string*>& fe::Config::bmap_table(const std::string& p_id) const {
+	return bmap_table(handle(p_id));
+}
+
+const fe::ByteTable<std::optional<std::size_t>>& fe::Config::bmap_numeric(const std::string& p_id) const {
+	return bmap_numeric(handle(p_id));
+}
+
+const std::map<std::string, byte>& fe::Config::bmap_reverse(const std::string& p_id) const {
+	return bmap_reverse(handle(p_id));
+}
+
+const std::map<std::size_t, byte>& fe::Config::bmap_numeric_reverse(const std::string& p_id) const {
+	return bmap_numeric_reverse(handle(p_id));
 }
 
-std::vector<std::string> fe::Config::bmap_as_vec(const std::string& p_id,
+const std::vector<std::string>& fe::Config::bmap_as_vec(const std::string& p_id,
 	std::size_t p_size) const {
-	const auto& l_map{ bmap(p_id) };
+	return bmap_as_vec(handle(p_id), p_id, p_size);
+}
+
+const std::vector<std::size_t>& fe::Config::bmap_as_numeric_vec(const std::string& p_id,
+	std::size_t p_size) const {
+	return bmap_as_numeric_vec(handle(p_id), p_id, p_size);
+}
+
+const std::map<byte, std::vector<byte>>& fe::Config::bmap_as_numeric_vectors(const std::string& p_id) const {
+	return bmap_as_numeric_vectors(handle(p_id));
+}
+
+const std::map<byte, std::string>& fe::Config::bmap_dense(const std::string& p_id) const {
+	return bmap_dense(handle(p_id));
+}
+
+const std::set<byte>& fe::Config::vset_as_set(const fe::ConfigKey& p_key) const {
+	return vset_as_set(p_key.handle());
+}
+
+const fe::ByteTable<const std::string*>& fe::Config::bmap_table(const fe::ConfigKey& p_key) const {
+	return bmap_table(p_key.handle());
+}
+
+const fe::ByteTable<std::optional<std::size_t>>& fe::Config::bmap_numeric(const fe::ConfigKey& p_key) const {
+	return bmap_numeric(p_key.handle());
+}
+
+const std::map<std::string, byte>& fe::Config::bmap_reverse(const fe::ConfigKey& p_key) const {
+	return bmap_reverse(p_key.handle());
+}
+
+const std::map<std::size_t, byte>& fe::Config::bmap_numeric_reverse(const fe::ConfigKey& p_key) const {
+	return bmap_numeric_reverse(p_key.handle());
+}
+
+const std::vector<std::string>& fe::Config::bmap_as_vec(const fe::ConfigKey& p_key,
+	std::size_t p_size) const {
+	return bmap_as_vec(p_key.handle(), p_key.name(), p_size);
+}
+
+const std::vector<std::size_t>& fe::Config::bmap_as_numeric_vec(const fe::ConfigKey& p_key,
+	std::size_t p_size) const {
+	return bmap_as_numeric_vec(p_key.handle(), p_key.name(), p_size);
+}
+
+const std::map<byte, std::vector<byte>>& fe::Config::bmap_as_numeric_vectors(const fe::ConfigKey& p_key) const {
+	return bmap_as_numeric_vectors(p_key.handle());
+}
+
+const std::map<byte, std::string>& fe::Config::bmap_dense(const fe::ConfigKey& p_key) const {
+	return bmap_dense(p_key.handle());
+}
+
+// by handle
+
+const std::vector<byte>& fe::Config::vset(std::uint32_t p_handle) const {
+	const auto l_value{ find_by_handle(m_set_index, p_handle) };
+	return l_value == nullptr ? EMPTY_SET : *l_value;
+}
+
+const std::map<byte, std::string>& fe::Config::bmap(std::uint32_t p_handle) const {
+	const auto l_value{ find_by_handle(m_byte_map_index, p_handle) };
+	return l_value == nullptr ? EMPTY_BMAP : *l_value;
+}
+
+const std::set<byte>& fe::Config::vset_as_set(std::uint32_t p_handle) const {
+	std::lock_guard<std::mutex> lock(m_view_mutex);
+
+	auto iter{ m_set_views.find(p_handle) };
+	if (iter == end(m_set_views)) {
+		const auto& l_vset{ vset(p_handle) };
+		iter = m_set_views.insert(std::make_pair(p_handle,
+			std::set<byte>(begin(l_vset), end(l_vset)))).first;
+	}
+
+	return iter->second;
+}
+
+const fe::ByteTable<const std::string*>& fe::Config::bmap_table(std::uint32_t p_handle) const {
+	std::lock_guard<std::mutex> lock(m_view_mutex);
+
+	return get_view(m_byte_map_views[p_handle].table,
+		[&]() {
+			fe::ByteTable<const std::string*> result;
+			result.fill(nullptr);
+
+			for (const auto& kv : bmap(p_handle))
+				result[kv.first] = &kv.second;
+
+			return result;
+		});
+}
+
+const fe::ByteTable<std::optional<std::size_t>>& fe::Config::bmap_numeric(std::uint32_t p_handle) const {
+	std::lock_guard<std::mutex> lock(m_view_mutex);
+
+	return get_view(m_byte_map_views[p_handle].numeric,
+		[&]() {
+			fe::ByteTable<std::optional<std::size_t>> result;
 
+			for (const auto& kv : bmap(p_handle))
+				result[kv.first] = xml::parse_numeric(kv.second);
+
+			return result;
+		});
+}
+
+const std::map<std::string, byte>& fe::Config::bmap_reverse(std::uint32_t p_handle) const {
+	std::lock_guard<std::mutex> lock(m_view_mutex);
+
+	return get_view(m_byte_map_views[p_handle].reverse,
+		[&]() {
+			std::map<std::string, byte> result;
+
+			for (const auto& kv : bmap(p_handle))
+				result.insert(std::make_pair(kv.second, kv.first));
+
+			return result;
+		});
+}
+
+const std::map<std::size_t, byte>& fe::Config::bmap_numeric_reverse(std::uint32_t p_handle) const {
+	std::lock_guard<std::mutex> lock(m_view_mutex);
+
+	return get_view(m_byte_map_views[p_handle].numeric_reverse,
+		[&]() {
+			std::map<std::size_t, byte> result;
+
+			for (const auto& kv : bmap(p_handle))
+				result.insert(std::make_pair(xml::parse_numeric(kv.second), kv.first));
+
+			return result;
+		});
+}
+
+const std::vector<std::string>& fe::Config::bmap_as_vec(std::uint32_t p_handle,
+	const std::string& p_id, std::size_t p_size) const {
+	std::lock_guard<std::mutex> lock(m_view_mutex);
+
+	auto& l_views{ m_byte_map_views[p_handle].as_vec };
+	auto iter{ l_views.find(p_size) };
+	if (iter != end(l_views))
+		return iter->second;
+
+	const auto& l_map{ bmap(p_handle) };
 	std::vector<std::string> result;
 
 	for (std::size_t i{ 0 }; i < (p_size > 0 ? p_size : 256); ++i) {
-		auto iter{ l_map.find(static_cast<byte>(i)) };
-		if (iter == end(l_map))
+		auto map_iter{ l_map.find(static_cast<byte>(i)) };
+		if (map_iter == end(l_map))
 			throw std::runtime_error(std::format("Map with ID '{}' is missing value for index {}",
 				p_id, i));
 		else
-			result.push_back(iter->second);
+			result.push_back(map_iter->second);
 	}
 
-	return result;
+	return l_views.insert(std::make_pair(p_size, std::move(result))).first->second;
 }
 
-std::vector<std::size_t> fe::Config::bmap_as_numeric_vec(const std::string& p_id,
-	std::size_t p_size) const {
-	const auto vec{ bmap_as_vec(p_id, p_size) };
+const std::vector<std::size_t>& fe::Config::bmap_as_numeric_vec(std::uint32_t p_handle,
+	const std::string& p_id, std::size_t p_size) const {
+	const auto& vec{ bmap_as_vec(p_handle, p_id, p_size) };
+
+	std::lock_guard<std::mutex> lock(m_view_mutex);
+
+	auto& l_views{ m_byte_map_views[p_handle].as_numeric_vec };
+	auto iter{ l_views.find(p_size) };
+	if (iter != end(l_views))
+		return iter->second;
+
 	std::vector<std::size_t> result;
 	for (const auto& str : vec)
 		result.push_back(xml::parse_numeric(str));
 
-	return result;
+	return l_views.insert(std::make_pair(p_size, std::move(result))).first->second;
 }
 
-std::map<byte, std::vector<byte>> fe::Config::bmap_as_numeric_vectors(const std::string& p_id) const {
-	std::map<byte, std::vector<byte>> result;
-	const auto btovec{ bmap(p_id) };
+const std::map<byte, std::vector<byte>>& fe::Config::bmap_as_numeric_vectors(std::uint32_t p_handle) const {
+	std::lock_guard<std::mutex> lock(m_view_mutex);
 
-	for (const auto& kv : btovec)
-		result.insert(std::make_pair(kv.first,
-			xml::parse_byte_list(kv.second)));
+	return get_view(m_byte_map_views[p_handle].as_numeric_vectors,
+		[&]() {
+			std::map<byte, std::vector<byte>> result;
 
-	return result;
-}
+			for (const auto& kv : bmap(p_handle))
+				result.insert(std::make_pair(kv.first,
+					xml::parse_byte_list(kv.second)));
 
-std::map<byte, std::string> fe::Config::bmap_dense(const std::string& p_id) const {
-	std::map<byte, std::string> result;
-	const auto& l_bmap{ bmap(p_id) };
+			return result;
+		});
+}
 
-	byte curval{ 0 };
+const std::map<byte, std::string>& fe::Config::bmap_dense(std::uint32_t p_handle) const {
+	std::lock_guard<std::mutex> lock(m_view_mutex);
 
-	for (const auto& kv : l_bmap)
-		result.emplace(curval++, kv.second);
+	return get_view(m_byte_map_views[p_handle].dense,
+		[&]() {
+			std::map<byte, std::string> result;
 
-	return result;
-}
+			byte curval{ 0 };
 
-const std::map<std::string, std::string>& fe::Config::str_map(const std::string& p_id) const {
-	static const std::map<std::string, std::string> empty_map;
+			for (const auto& kv : bmap(p_handle))
+				result.emplace(curval++, kv.second);
 
-	if (m_string_maps.find(p_id) == end(m_string_maps))
-		return empty_map;
-	else
-		return m_string_maps.at(p_id);
-}
-
-bool fe::Config::boolean(const std::string& p_id) const {
-	if (m_bools.find(p_id) == end(m_bools))
-		throw std::runtime_error(std::format("Configuration Boolean '{}' not found", p_id));
-	else
-		return m_bools.at(p_id);
+			return result;
+		});
 }
 
-bool fe::Config::boolean_or(const std::string& p_id, bool p_default) const {
-	if (m_bools.find(p_id) == end(m_bools))
-		return p_default;
-	else
-		return m_bools.at(p_id);
-}
+void fe::Config::determine_region(klib::RomView p_rom) {
+	klib::prof::Scope l_prof("Config::determine_region");
 
-void fe::Config::determine_region(const std::vector<byte>& p_rom) {
 	for (const auto& reg : m_region_defs) {
 		if (reg.m_filesize.has_value() && (reg.m_filesize.value() != p_rom.size()))
 			continue;
@@ -225,18 +558,36 @@ void fe::Config::clear(void) {
 	m_region.region.clear();
 	m_region.compatible_regions.clear();
 	m_region_defs.clear();
+	m_builtin_match.reset();
+	m_xml_hash.reset();
 	m_byte_maps.clear();
 	m_constants.clear();
 	m_pointers.clear();
 	m_sets.clear();
 	m_string_maps.clear();
 	m_bools.clear();
+	m_bool_conditions.clear();
+
+	m_constant_index.clear();
+	m_pointer_index.clear();
+	m_set_index.clear();
+	m_byte_map_index.clear();
+	m_string_map_index.clear();
+	m_bool_index.clear();
+
+	std::lock_guard<std::mutex> lock(m_view_mutex);
+	m_byte_map_views.clear();
+	m_set_views.clear();
 }
 
 bool fe::Config::has_constant(const std::string& p_id) const {
 	return m_constants.contains(p_id);
 }
 
+bool fe::Config::has_constant(const fe::ConfigKey& p_key) const {
+	return find_by_key(m_constant_index, p_key) != nullptr;
+}
+
 std::string fe::Config::to_string(void) const {
 	std::string result{ std::format("Region: '{}'\n", m_region.region) };
 
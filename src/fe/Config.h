@@ -1,18 +1,26 @@
 #ifndef FE_CONFIG_H
 #define FE_CONFIG_H
 
+#include <array>
+#include <cstdint>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string>
 #include <unordered_set>
 #include <utility>
 #include <vector>
+#include "./ConfigKey.h"
 #include "./xml/Xml_helper.h"
 
 using byte = unsigned char;
 
 namespace fe {
 
+	// one entry per byte value
+	template<class T>
+	using ByteTable = std::array<T, 256>;
+
 	struct ConfigRegion {
 		std::string region;
 		std::unordered_set<std::string> compatible_regions;
@@ -20,6 +28,10 @@ namespace fe {
 
 	class Config {
 		std::vector<RegionDefinition> m_region_defs;
+		// whether the built-in tables match the xml file, once known
+		mutable std::optional<bool> m_builtin_match;
+		// hash of the xml files, read once per load when caching
+		std::optional<std::uint64_t> m_xml_hash;
 		ConfigRegion m_region;
 
 		// actual config data
@@ -29,9 +41,83 @@ namespace fe {
 		std::map<std::string, std::map<byte, std::string>> m_byte_maps;
 		std::map<std::string, std::map<std::string, std::string>> m_string_maps;
 		std::map<std::string, bool> m_bools;
+		// conditional booleans, kept so they can be evaluated against each ROM
+		std::map<std::string, std::string> m_bool_conditions;
+
+		// lookup tables indexed by ConfigKey handle, pointing into the maps above;
+		// nullptr where the handle has no entry
+		std::vector<const std::size_t*> m_constant_index;
+		std::vector<const std::pair<std::size_t, std::size_t>*> m_pointer_index;
+		std::vector<const std::vector<byte>*> m_set_index;
+		std::vector<const std::map<byte, std::string>*> m_byte_map_index;
+		std::vector<const std::map<std::string, std::string>*> m_string_map_index;
+		std::vector<const bool*> m_bool_index;
+
+		// derived views of a byte map, each built on first request
+		struct ByteMapViews {
+			std::optional<fe::ByteTable<const std::string*>> table;
+			std::optional<fe::ByteTable<std::optional<std::size_t>>> numeric;
+			std::optional<std::map<std::string, byte>> reverse;
+			std::optional<std::map<std::size_t, byte>> numeric_reverse;
+			// keyed by requested size
+			std::map<std::size_t, std::vector<std::string>> as_vec;
+			std::map<std::size_t, std::vector<std::size_t>> as_numeric_vec;
+			std::optional<std::map<byte, std::vector<byte>>> as_numeric_vectors;
+			std::optional<std::map<byte, std::string>> dense;
+		};
+
+		// keyed by ConfigKey handle; entries are never modified once built, so
+		// references to them stay valid until the config is cleared or reloaded
+		mutable std::mutex m_view_mutex;
+		mutable std::map<std::uint32_t, ByteMapViews> m_byte_map_views;
+		mutable std::map<std::uint32_t, std::set<byte>> m_set_views;
+
+		// binary cache of the parsed xml files, disabled if empty
+		std::string m_cache_dir;
+
+		void evaluate_bool_conditions(klib::RomView p_rom);
+		void build_key_index(void);
+
+		// by ConfigKey handle; p_id is only used in error messages
+		const std::vector<byte>& vset(std::uint32_t p_handle) const;
+		const std::map<byte, std::string>& bmap(std::uint32_t p_handle) const;
+		const std::set<byte>& vset_as_set(std::uint32_t p_handle) const;
+		const fe::ByteTable<const std::string*>& bmap_table(std::uint32_t p_handle) const;
+		const fe::ByteTable<std::optional<std::size_t>>& bmap_numeric(std::uint32_t p_handle) const;
+		const std::map<std::string, byte>& bmap_reverse(std::uint32_t p_handle) const;
+		const std::map<std::size_t, byte>& bmap_numeric_reverse(std::uint32_t p_handle) const;
+		const std::vector<std::string>& bmap_as_vec(std::uint32_t p_handle,
+			const std::string& p_id, std::size_t p_size) const;
+		const std::vector<std::size_t>& bmap_as_numeric_vec(std::uint32_t p_handle,
+			const std::string& p_id, std::size_t p_size) const;
+		const std::map<byte, std::vector<byte>>& bmap_as_numeric_vectors(std::uint32_t p_handle) const;
+		const std::map<byte, std::string>& bmap_dense(std::uint32_t p_handle) const;
+
+		// built-in tables generated from eoe_config.xml (ConfigBuiltin.cpp)
+		std::optional<std::uint64_t> builtin_xml_hash(void) const;
+		std::size_t builtin_xml_size(void) const;
+		// true if the built-in tables can stand in for this xml file; worked out
+		// once per load, since it may have to read and hash the file
+		bool builtin_matches(const std::string& p_config_xml) const;
+		void load_builtin_definitions(void);
+		// false if the region is not built in
+		bool load_builtin_config_data(void);
+
+		// cache (ConfigCache.cpp)
+		std::uint64_t hash_xml_files(const std::string& p_config_xml,
+			const std::string& p_config_override_xml) const;
+		std::string get_cache_filename(const std::string& p_kind, std::uint64_t p_key) const;
+		bool load_cached_definitions(std::uint64_t p_key);
+		void save_cached_definitions(std::uint64_t p_key) const;
+		bool load_cached_config_data(std::uint64_t p_key);
+		void save_cached_config_data(std::uint64_t p_key) const;
+		void write_cache_file(const std::string& p_filename, const std::vector<byte>& p_data) const;
 
 	public:
 		Config(void) = default;
+		// copies rebuild the key index, which points into our own maps
+		Config(const Config& p_config);
+		Config& operator=(const Config& p_config);
 		std::string to_string(void) const;
 
 		std::string get_region(void) const;
@@ -40,31 +126,59 @@ namespace fe {
 		void clear(void);
 
 		bool has_constant(const std::string& p_id) const;
+		bool has_constant(const fe::ConfigKey& p_key) const;
+
+		// directory for the binary config cache; empty disables caching
+		void set_cache_dir(const std::string& p_cache_dir);
 
 		// first, load all definitions from xml
 		void load_definitions(const std::string& p_config_xml, const std::string& p_config_override_xml);
 		// then, determine the region for our ROM
-		void determine_region(const std::vector<byte>& p_rom);
+		void determine_region(klib::RomView p_rom);
 		// finally load all the data for our region
 		void load_config_data(const std::string& p_config_xml, const std::string& p_config_override_xml,
-			const std::vector<byte>& p_rom);
+			klib::RomView p_rom);
 
+		// by name; the ConfigKey overloads below are plain array reads
 		std::size_t constant(const std::string& p_id) const;
 		std::size_t constant_or(const std::string& p_id, std::size_t p_default) const;
 		std::pair<std::size_t, std::size_t> pointer(const std::string& p_id) const;
 		const std::vector<byte>& vset(const std::string& p_id) const;
-		std::set<byte> vset_as_set(const std::string& p_id) const;
 		const std::map<byte, std::string>& bmap(const std::string& p_id) const;
-		const std::map<byte, std::size_t> bmap_numeric(const std::string& p_id) const;
-		std::map<std::string, byte> bmap_reverse(const std::string& p_id) const;
-		std::map<std::size_t, byte> bmap_numeric_reverse(const std::string& p_id) const;
-		std::vector<std::string> bmap_as_vec(const std::string& p_id, std::size_t p_size) const;
-		std::vector<std::size_t> bmap_as_numeric_vec(const std::string& p_id, std::size_t p_size) const;
-		std::map<byte, std::vector<byte>> bmap_as_numeric_vectors(const std::string& p_id) const;
-		std::map<byte, std::string> bmap_dense(const std::string& p_id) const;
 		const std::map<std::string, std::string>& str_map(const std::string& p_id) const;
 		bool boolean(const std::string& p_id) const;
 		bool boolean_or(const std::string& p_id, bool p_default) const;
+
+		std::size_t constant(const fe::ConfigKey& p_key) const;
+		std::size_t constant_or(const fe::ConfigKey& p_key, std::size_t p_default) const;
+		std::pair<std::size_t, std::size_t> pointer(const fe::ConfigKey& p_key) const;
+		const std::vector<byte>& vset(const fe::ConfigKey& p_key) const;
+		const std::map<byte, std::string>& bmap(const fe::ConfigKey& p_key) const;
+		const std::map<std::string, std::string>& str_map(const fe::ConfigKey& p_key) const;
+		bool boolean(const fe::ConfigKey& p_key) const;
+		bool boolean_or(const fe::ConfigKey& p_key, bool p_default) const;
+
+		// derived views, built once per map and kept until the config is cleared or reloaded
+		const std::set<byte>& vset_as_set(const std::string& p_id) const;
+		// the map as a lookup table, nullptr where the map has no value
+		const fe::ByteTable<const std::string*>& bmap_table(const std::string& p_id) const;
+		const fe::ByteTable<std::optional<std::size_t>>& bmap_numeric(const std::string& p_id) const;
+		const std::map<std::string, byte>& bmap_reverse(const std::string& p_id) const;
+		const std::map<std::size_t, byte>& bmap_numeric_reverse(const std::string& p_id) const;
+		const std::vector<std::string>& bmap_as_vec(const std::string& p_id, std::size_t p_size) const;
+		const std::vector<std::size_t>& bmap_as_numeric_vec(const std::string& p_id, std::size_t p_size) const;
+		const std::map<byte, std::vector<byte>>& bmap_as_numeric_vectors(const std::string& p_id) const;
+		const std::map<byte, std::string>& bmap_dense(const std::string& p_id) const;
+
+		const std::set<byte>& vset_as_set(const fe::ConfigKey& p_key) const;
+		const fe::ByteTable<const std::string*>& bmap_table(const fe::ConfigKey& p_key) const;
+		const fe::ByteTable<std::optional<std::size_t>>& bmap_numeric(const fe::ConfigKey& p_key) const;
+		const std::map<std::string, byte>& bmap_reverse(const fe::ConfigKey& p_key) const;
+		const std::map<std::size_t, byte>& bmap_numeric_reverse(const fe::ConfigKey& p_key) const;
+		const std::vector<std::string>& bmap_as_vec(const fe::ConfigKey& p_key, std::size_t p_size) const;
+		const std::vector<std::size_t>& bmap_as_numeric_vec(const fe::ConfigKey& p_key, std::size_t p_size) const;
+		const std::map<byte, std::vector<byte>>& bmap_as_numeric_vectors(const fe::ConfigKey& p_key) const;
+		const std::map<byte, std::string>& bmap_dense(const fe::ConfigKey& p_key) const;
 	};
 
 }
@@ -0,0 +1,181 @@
+#include "Config.h"
+#include "ConfigBuiltin.h"
+#include "./../common/klib/Kfile.h"
+#include "./../common/klib/Khash.h"
+#include "./../common/klib/Kprofile.h"
+#include <filesystem>
+#include <system_error>
+
+#ifdef FE_BUILTIN_CONFIG
+#include "eoe_config_builtin.h"
+#endif
+
+/*
+ built-in configuration
+
+ CMake builds embed eoe_config.xml as tables generated at build time. they
+ stand in for the xml file when it is missing, or byte-for-byte identical to
+ the file they were made from; an override file is still parsed on top of
+ them. builds without the generated header always parse the xml
+*/
+
+#ifdef FE_BUILTIN_CONFIG
+
+std::optional<std::uint64_t> fe::Config::builtin_xml_hash(void) const {
+	return fe::builtin::XML_HASH;
+}
+
+std::size_t fe::Config::builtin_xml_size(void) const {
+	return fe::builtin::XML_SIZE;
+}
+
+void fe::Config::load_builtin_definitions(void) {
+	klib::prof::Scope l_prof("builtin region definitions");
+
+	for (const auto& def : fe::builtin::REGION_DEFINITIONS) {
+		fe::RegionDefinition l_region;
+
+		l_region.m_name = def.name;
+		if (def.has_file_size)
+			l_region.m_filesize = def.file_size;
+
+		for (std::size_t i{ 0 }; i < def.compatible_regions.count; ++i)
+			l_region.m_compatible_regions.insert(
+				fe::builtin::NAMES[def.compatible_regions.start + i]);
+
+		for (std::size_t i{ 0 }; i < def.signatures.count; ++i) {
+			const auto& sig{ fe::builtin::SIGNATURES[def.signatures.start + i] };
+			const auto l_values{ begin(fe::builtin::BYTES) + sig.values.start };
+
+			l_region.m_defs.push_back(std::make_pair(sig.offset,
+				std::vector<byte>(l_values, l_values + sig.values.count)));
+		}
+
+		m_region_defs.push_back(l_region);
+	}
+
+	l_prof.count("regions", fe::builtin::REGION_DEFINITIONS.size());
+}
+
+bool fe::Config::load_builtin_config_data(void) {
+	// the tables were resolved with the compatible regions of the built-in
+	// definition; an override may have redefined the region
+	const fe::builtin::RegionData* l_data{ nullptr };
+
+	for (std::size_t i{ 0 }; i < fe::builtin::REGIONS.size(); ++i) {
+		const auto& def{ fe::builtin::REGION_DEFINITIONS[i] };
+		if (m_region.region != def.name)
+			continue;
+
+		std::unordered_set<std::string> l_compatible;
+		for (std::size_t j{ 0 }; j < def.compatible_regions.count; ++j)
+			l_compatible.insert(fe::builtin::NAMES[def.compatible_regions.start + j]);
+
+		if (l_compatible == m_region.compatible_regions)
+			l_data = &fe::builtin::REGIONS[i];
+		break;
+	}
+
+	if (l_data == nullptr)
+		return false;
+
+	klib::prof::Scope l_prof("builtin config data", m_region.region);
+
+	// entries already loaded from the override file take precedence
+
+	for (std::size_t i{ 0 }; i < l_data->constants.count; ++i) {
+		const auto& entry{ fe::builtin::CONSTANTS[l_data->constants.start + i] };
+		m_constants.insert(std::make_pair(entry.name, entry.value));
+	}
+
+	for (std::size_t i{ 0 }; i < l_data->pointers.count; ++i) {
+		const auto& entry{ fe::builtin::POINTERS[l_data->pointers.start + i] };
+		m_pointers.insert(std::make_pair(entry.name,
+			std::make_pair(entry.offset, entry.zero_addr)));
+	}
+
+	for (std::size_t i{ 0 }; i < l_data->sets.count; ++i) {
+		const auto& entry{ fe::builtin::SETS[l_data->sets.start + i] };
+		const auto l_values{ begin(fe::builtin::BYTES) + entry.values.start };
+
+		m_sets.insert(std::make_pair(entry.name,
+			std::vector<byte>(l_values, l_values + entry.values.count)));
+	}
+
+	for (std::size_t i{ 0 }; i < l_data->byte_maps.count; ++i) {
+		const auto& entry{ fe::builtin::BYTE_MAPS[l_data->byte_maps.start + i] };
+		if (m_byte_maps.contains(entry.name))
+			continue;
+
+		auto& l_map{ m_byte_maps[entry.name] };
+		for (std::size_t j{ 0 }; j < entry.entries.count; ++j) {
+			const auto& kv{ fe::builtin::BYTE_MAP_ENTRIES[entry.entries.start + j] };
+			l_map.insert(std::make_pair(kv.key, kv.value));
+		}
+	}
+
+	for (std::size_t i{ 0 }; i < l_data->string_maps.count; ++i) {
+		const auto& entry{ fe::builtin::STRING_MAPS[l_data->string_maps.start + i] };
+		if (m_string_maps.contains(entry.name))
+			continue;
+
+		auto& l_map{ m_string_maps[entry.name] };
+		for (std::size_t j{ 0 }; j < entry.entries.count; ++j) {
+			const auto& kv{ fe::builtin::STRING_MAP_ENTRIES[entry.entries.start + j] };
+			l_map.insert(std::make_pair(kv.key, kv.value));
+		}
+	}
+
+	// a boolean is defined once, by value or by condition
+	for (std::size_t i{ 0 }; i < l_data->bools.count; ++i) {
+		const auto& entry{ fe::builtin::BOOLS[l_data->bools.start + i] };
+		if (!m_bool_conditions.contains(entry.name))
+			m_bools.insert(std::make_pair(entry.name, entry.value));
+	}
+
+	for (std::size_t i{ 0 }; i < l_data->bool_conditions.count; ++i) {
+		const auto& entry{ fe::builtin::BOOL_CONDITIONS[l_data->bool_conditions.start + i] };
+		if (!m_bools.contains(entry.name))
+			m_bool_conditions.insert(std::make_pair(entry.name, entry.condition));
+	}
+
+	return true;
+}
+
+#else
+
+std::optional<std::uint64_t> fe::Config::builtin_xml_hash(void) const {
+	return std::nullopt;
+}
+
+std::size_t fe::Config::builtin_xml_size(void) const {
+	return 0;
+}
+
+void fe::Config::load_builtin_definitions(void) {
+}
+
+bool fe::Config::load_builtin_config_data(void) {
+	return false;
+}
+
+#endif
+
+bool fe::Config::builtin_matches(const std::string& p_config_xml) const {
+	if (m_builtin_match.has_value())
+		return m_builtin_match.value();
+
+	const auto l_hash{ builtin_xml_hash() };
+	std::error_code ec;
+
+	if (!l_hash.has_value())
+		m_builtin_match = false;
+	else if (!klib::file::file_exists(p_config_xml))
+		m_builtin_match = true;
+	else if (std::filesystem::file_size(p_config_xml, ec) != builtin_xml_size() || ec)
+		m_builtin_match = false;
+	else
+		m_builtin_match = klib::hash::fnv1a_64(klib::file::read_file_as_bytes(p_config_xml)) == l_hash.value();
+
+	return m_builtin_match.value();
+}
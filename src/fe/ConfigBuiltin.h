@@ -0,0 +1,95 @@
+#ifndef FE_CONFIG_BUILTIN_H
+#define FE_CONFIG_BUILTIN_H
+
+#include <cstddef>
+#include <cstdint>
+
+using byte = unsigned char;
+
+/*
+ layout of the built-in configuration, generated from eoe_config.xml at build
+ time (see src/fe/gen/ConfigGen.cpp). variable length data lives in shared
+ pools, referenced by ranges
+*/
+
+namespace fe {
+
+	namespace builtin {
+
+		struct Range {
+			std::size_t start, count;
+		};
+
+		struct Constant {
+			const char* name;
+			std::size_t value;
+		};
+
+		struct Pointer {
+			const char* name;
+			std::size_t offset, zero_addr;
+		};
+
+		// range into the byte pool
+		struct Set {
+			const char* name;
+			fe::builtin::Range values;
+		};
+
+		struct ByteMapEntry {
+			byte key;
+			const char* value;
+		};
+
+		struct ByteMap {
+			const char* name;
+			fe::builtin::Range entries;
+		};
+
+		struct StringMapEntry {
+			const char* key;
+			const char* value;
+		};
+
+		struct StringMap {
+			const char* name;
+			fe::builtin::Range entries;
+		};
+
+		struct Bool {
+			const char* name;
+			bool value;
+		};
+
+		struct BoolCondition {
+			const char* name;
+			const char* condition;
+		};
+
+		// range into the byte pool
+		struct Signature {
+			std::size_t offset;
+			fe::builtin::Range values;
+		};
+
+		// compatible regions is a range into the name pool
+		struct RegionDefinition {
+			const char* name;
+			bool has_file_size;
+			std::size_t file_size;
+			fe::builtin::Range compatible_regions;
+			fe::builtin::Range signatures;
+		};
+
+		// the config data as resolved for one region, first match wins
+		struct RegionData {
+			const char* region;
+			fe::builtin::Range constants, pointers, sets, byte_maps, string_maps,
+				bools, bool_conditions;
+		};
+
+	}
+
+}
+
+#endif
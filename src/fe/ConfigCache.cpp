@@ -0,0 +1,364 @@
+#include "Config.h"
+#include "./../common/klib/Kfile.h"
+#include "./../common/klib/Khash.h"
+#include "./../common/klib/Kprofile.h"
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+
+/*
+ binary cache of the parsed xml configuration
+
+ region definitions are cached per pair of xml files, and the config data
+ per (region, xml files). conditional booleans are stored unevaluated, since
+ they depend on the ROM. any file that cannot be read back is ignored, and
+ failing to write a cache file never fails the command
+*/
+
+namespace {
+
+	constexpr char CACHE_MAGIC[]{ "FXCC" };
+	// bump whenever the layout below changes
+	constexpr std::uint64_t CACHE_FORMAT_VERSION{ 1 };
+
+	class CacheWriter {
+		std::vector<byte> m_data;
+
+	public:
+		CacheWriter(std::uint64_t p_key) {
+			for (std::size_t i{ 0 }; i < 4; ++i)
+				m_data.push_back(static_cast<byte>(CACHE_MAGIC[i]));
+			number(CACHE_FORMAT_VERSION);
+			number(p_key);
+		}
+
+		void number(std::uint64_t p_value) {
+			for (std::size_t i{ 0 }; i < 8; ++i)
+				m_data.push_back(static_cast<byte>(p_value >> (8 * i)));
+		}
+
+		void bytes(const std::vector<byte>& p_value) {
+			number(p_value.size());
+			m_data.insert(end(m_data), begin(p_value), end(p_value));
+		}
+
+		void string(const std::string& p_value) {
+			number(p_value.size());
+			m_data.insert(end(m_data), begin(p_value), end(p_value));
+		}
+
+		const std::vector<byte>& data(void) const {
+			return m_data;
+		}
+	};
+
+	class CacheReader {
+		const std::vector<byte>& m_data;
+		std::size_t m_pos;
+
+		void require(std::size_t p_size) {
+			if (m_data.size() - m_pos < p_size)
+				throw std::runtime_error("Truncated config cache file");
+		}
+
+	public:
+		CacheReader(const std::vector<byte>& p_data) :
+			m_data{ p_data },
+			m_pos{ 0 }
+		{
+		}
+
+		// false if the header does not match this format version and key
+		bool header(std::uint64_t p_key) {
+			require(4);
+			for (std::size_t i{ 0 }; i < 4; ++i)
+				if (m_data[m_pos++] != static_cast<byte>(CACHE_MAGIC[i]))
+					return false;
+
+			return number() == CACHE_FORMAT_VERSION && number() == p_key;
+		}
+
+		std::uint64_t number(void) {
+			require(8);
+			std::uint64_t result{ 0 };
+			for (std::size_t i{ 0 }; i < 8; ++i)
+				result |= static_cast<std::uint64_t>(m_data[m_pos++]) << (8 * i);
+			return result;
+		}
+
+		std::size_t size(void) {
+			const auto result{ number() };
+			require(result);
+			return static_cast<std::size_t>(result);
+		}
+
+		std::vector<byte> bytes(void) {
+			const std::size_t l_size{ size() };
+			std::vector<byte> result(begin(m_data) + m_pos, begin(m_data) + m_pos + l_size);
+			m_pos += l_size;
+			return result;
+		}
+
+		std::string string(void) {
+			const std::size_t l_size{ size() };
+			std::string result(begin(m_data) + m_pos, begin(m_data) + m_pos + l_size);
+			m_pos += l_size;
+			return result;
+		}
+
+		bool at_end(void) const {
+			return m_pos == m_data.size();
+		}
+	};
+
+}
+
+std::uint64_t fe::Config::hash_xml_files(const std::string& p_config_xml,
+	const std::string& p_config_override_xml) const {
+	// when the built-in tables stand in for the base file, they share its hash
+	std::uint64_t result{ builtin_matches(p_config_xml) ?
+		builtin_xml_hash().value() :
+		klib::hash::fnv1a_64(klib::file::read_file_as_bytes(p_config_xml)) };
+
+	// a missing override file must not hash like an empty one
+	if (klib::file::file_exists(p_config_override_xml))
+		result = klib::hash::fnv1a_64(klib::file::read_file_as_bytes(p_config_override_xml),
+			klib::hash::fnv1a_64("override", result));
+
+	return result;
+}
+
+std::string fe::Config::get_cache_filename(const std::string& p_kind,
+	std::uint64_t p_key) const {
+	return (std::filesystem::path(m_cache_dir) /
+		std::format("{}-{:016x}.bin", p_kind, p_key)).string();
+}
+
+bool fe::Config::load_cached_definitions(std::uint64_t p_key) {
+	klib::prof::Scope l_prof("config cache read");
+
+	const auto l_filename{ get_cache_filename("regions", p_key) };
+	if (!klib::file::file_exists(l_filename))
+		return false;
+
+	try {
+		const auto l_data{ klib::file::read_file_as_bytes(l_filename) };
+		CacheReader reader(l_data);
+
+		if (!reader.header(p_key))
+			return false;
+
+		std::vector<fe::RegionDefinition> l_region_defs(reader.size());
+
+		for (auto& def : l_region_defs) {
+			def.m_name = reader.string();
+			if (reader.number() != 0)
+				def.m_filesize = static_cast<std::size_t>(reader.number());
+
+			for (std::size_t i{ reader.size() }; i > 0; --i)
+				def.m_compatible_regions.insert(reader.string());
+
+			for (std::size_t i{ reader.size() }; i > 0; --i) {
+				const auto l_offset{ static_cast<std::size_t>(reader.number()) };
+				def.m_defs.push_back(std::make_pair(l_offset, reader.bytes()));
+			}
+		}
+
+		if (!reader.at_end())
+			return false;
+
+		m_region_defs = std::move(l_region_defs);
+		l_prof.count("regions", m_region_defs.size());
+
+		return true;
+	}
+	catch (const std::exception&) {
+		return false;
+	}
+}
+
+void fe::Config::save_cached_definitions(std::uint64_t p_key) const {
+	CacheWriter writer(p_key);
+
+	writer.number(m_region_defs.size());
+	for (const auto& def : m_region_defs) {
+		writer.string(def.m_name);
+		writer.number(def.m_filesize.has_value() ? 1 : 0);
+		if (def.m_filesize.has_value())
+			writer.number(def.m_filesize.value());
+
+		writer.number(def.m_compatible_regions.size());
+		for (const auto& reg : def.m_compatible_regions)
+			writer.string(reg);
+
+		writer.number(def.m_defs.size());
+		for (const auto& sig : def.m_defs) {
+			writer.number(sig.first);
+			writer.bytes(sig.second);
+		}
+	}
+
+	write_cache_file(get_cache_filename("regions", p_key), writer.data());
+}
+
+bool fe::Config::load_cached_config_data(std::uint64_t p_key) {
+	klib::prof::Scope l_prof("config cache read");
+
+	const auto l_filename{ get_cache_filename("config", p_key) };
+	if (!klib::file::file_exists(l_filename))
+		return false;
+
+	try {
+		const auto l_data{ klib::file::read_file_as_bytes(l_filename) };
+		CacheReader reader(l_data);
+
+		// the key hash covers the region name, but guard against collisions
+		if (!reader.header(p_key) || reader.string() != m_region.region)
+			return false;
+
+		decltype(m_constants) l_constants;
+		for (std::size_t i{ reader.size() }; i > 0; --i) {
+			auto l_name{ reader.string() };
+			l_constants.insert(std::make_pair(std::move(l_name),
+				static_cast<std::size_t>(reader.number())));
+		}
+
+		decltype(m_pointers) l_pointers;
+		for (std::size_t i{ reader.size() }; i > 0; --i) {
+			auto l_name{ reader.string() };
+			const auto l_offset{ static_cast<std::size_t>(reader.number()) };
+			l_pointers.insert(std::make_pair(std::move(l_name),
+				std::make_pair(l_offset, static_cast<std::size_t>(reader.number()))));
+		}
+
+		decltype(m_sets) l_sets;
+		for (std::size_t i{ reader.size() }; i > 0; --i) {
+			auto l_name{ reader.string() };
+			l_sets.insert(std::make_pair(std::move(l_name), reader.bytes()));
+		}
+
+		decltype(m_byte_maps) l_byte_maps;
+		for (std::size_t i{ reader.size() }; i > 0; --i) {
+			auto& l_map{ l_byte_maps[reader.string()] };
+
+			for (std::size_t j{ reader.size() }; j > 0; --j) {
+				const auto l_key{ static_cast<byte>(reader.number()) };
+				l_map.insert(std::make_pair(l_key, reader.string()));
+			}
+		}
+
+		decltype(m_string_maps) l_string_maps;
+		for (std::size_t i{ reader.size() }; i > 0; --i) {
+			auto& l_map{ l_string_maps[reader.string()] };
+
+			for (std::size_t j{ reader.size() }; j > 0; --j) {
+				auto l_key{ reader.string() };
+				l_map.insert(std::make_pair(std::move(l_key), reader.string()));
+			}
+		}
+
+		decltype(m_bools) l_bools;
+		for (std::size_t i{ reader.size() }; i > 0; --i) {
+			auto l_name{ reader.string() };
+			l_bools.insert(std::make_pair(std::move(l_name), reader.number() != 0));
+		}
+
+		decltype(m_bool_conditions) l_bool_conditions;
+		for (std::size_t i{ reader.size() }; i > 0; --i) {
+			auto l_name{ reader.string() };
+			l_bool_conditions.insert(std::make_pair(std::move(l_name), reader.string()));
+		}
+
+		if (!reader.at_end())
+			return false;
+
+		m_constants = std::move(l_constants);
+		m_pointers = std::move(l_pointers);
+		m_sets = std::move(l_sets);
+		m_byte_maps = std::move(l_byte_maps);
+		m_string_maps = std::move(l_string_maps);
+		m_bools = std::move(l_bools);
+		m_bool_conditions = std::move(l_bool_conditions);
+
+		l_prof.count("bytes", l_data.size());
+
+		return true;
+	}
+	catch (const std::exception&) {
+		return false;
+	}
+}
+
+void fe::Config::save_cached_config_data(std::uint64_t p_key) const {
+	CacheWriter writer(p_key);
+	writer.string(m_region.region);
+
+	writer.number(m_constants.size());
+	for (const auto& kv : m_constants) {
+		writer.string(kv.first);
+		writer.number(kv.second);
+	}
+
+	writer.number(m_pointers.size());
+	for (const auto& kv : m_pointers) {
+		writer.string(kv.first);
+		writer.number(kv.second.first);
+		writer.number(kv.second.second);
+	}
+
+	writer.number(m_sets.size());
+	for (const auto& kv : m_sets) {
+		writer.string(kv.first);
+		writer.bytes(kv.second);
+	}
+
+	writer.number(m_byte_maps.size());
+	for (const auto& kv : m_byte_maps) {
+		writer.string(kv.first);
+		writer.number(kv.second.size());
+		for (const auto& kkv : kv.second) {
+			writer.number(kkv.first);
+			writer.string(kkv.second);
+		}
+	}
+
+	writer.number(m_string_maps.size());
+	for (const auto& kv : m_string_maps) {
+		writer.string(kv.first);
+		writer.number(kv.second.size());
+		for (const auto& kkv : kv.second) {
+			writer.string(kkv.first);
+			writer.string(kkv.second);
+		}
+	}
+
+	writer.number(m_bools.size());
+	for (const auto& kv : m_bools) {
+		writer.string(kv.first);
+		writer.number(kv.second ? 1 : 0);
+	}
+
+	writer.number(m_bool_conditions.size());
+	for (const auto& kv : m_bool_conditions) {
+		writer.string(kv.first);
+		writer.string(kv.second);
+	}
+
+	write_cache_file(get_cache_filename("config", p_key), writer.data());
+}
+
+void fe::Config::write_cache_file(const std::string& p_filename,
+	const std::vector<byte>& p_data) const {
+	klib::prof::Scope l_prof("config cache write");
+
+	try {
+		std::error_code ec;
+		std::filesystem::create_directories(m_cache_dir, ec);
+
+		// replaced atomically, so concurrent jobs never see a partial file
+		klib::file::write_bytes_to_file(p_data, p_filename);
+	}
+	catch (const std::exception&) {
+		// the cache is an optimization only
+	}
+}
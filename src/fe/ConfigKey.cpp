@@ -0,0 +1,53 @@
+#include "ConfigKey.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+	std::mutex g_mutex;
+	std::unordered_map<std::string, std::uint32_t> g_handles;
+
+}
+
+const char* fe::ConfigKey::name(void) const {
+	return m_name;
+}
+
+std::uint32_t fe::ConfigKey::handle(void) const {
+	std::uint32_t l_handle{ m_handle.load(std::memory_order_acquire) };
+
+	if (l_handle == 0) {
+		l_handle = fe::intern_config_key(m_name) + 1;
+		m_handle.store(l_handle, std::memory_order_release);
+	}
+
+	return l_handle - 1;
+}
+
+std::uint32_t fe::intern_config_key(std::string_view p_name) {
+	std::lock_guard<std::mutex> lock(g_mutex);
+
+	auto iter{ g_handles.find(std::string(p_name)) };
+	if (iter != end(g_handles))
+		return iter->second;
+
+	const auto l_handle{ static_cast<std::uint32_t>(g_handles.size()) };
+	g_handles.insert(std::make_pair(std::string(p_name), l_handle));
+
+	return l_handle;
+}
+
+std::optional<std::uint32_t> fe::find_config_key(std::string_view p_name) {
+	std::lock_guard<std::mutex> lock(g_mutex);
+
+	auto iter{ g_handles.find(std::string(p_name)) };
+	if (iter == end(g_handles))
+		return std::nullopt;
+
+	return iter->second;
+}
+
+std::size_t fe::interned_config_key_count(void) {
+	std::lock_guard<std::mutex> lock(g_mutex);
+	return g_handles.size();
+}
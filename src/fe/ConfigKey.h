@@ -0,0 +1,39 @@
+#ifndef FE_CONFIG_KEY_H
+#define FE_CONFIG_KEY_H
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace fe {
+
+	// interned configuration identifier; resolved to a dense integer handle on first use
+	class ConfigKey {
+		const char* m_name;
+		// 0 until interned, otherwise handle + 1
+		mutable std::atomic<std::uint32_t> m_handle;
+
+	public:
+		explicit constexpr ConfigKey(const char* p_name) :
+			m_name{ p_name }, m_handle{ 0 }
+		{
+		}
+		ConfigKey(const ConfigKey&) = delete;
+		ConfigKey& operator=(const ConfigKey&) = delete;
+
+		const char* name(void) const;
+		std::uint32_t handle(void) const;
+	};
+
+	// process-wide; the same name always gets the same handle
+	std::uint32_t intern_config_key(std::string_view p_name);
+	// the handle of an interned name, without interning it
+	std::optional<std::uint32_t> find_config_key(std::string_view p_name);
+	// handles are dense, in [0, interned_config_key_count())
+	std::size_t interned_config_key_count(void);
+
+}
+
+#endif
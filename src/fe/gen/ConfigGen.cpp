@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "./../Config.h"
+#include "./../xml/Xml_helper.h"
+#include "./../../common/klib/Kfile.h"
+#include "./../../common/klib/Khash.h"
+
+/*
+ build-time generator for the built-in configuration
+
+ usage: faxiscripts_configgen <eoe_config.xml> <output header>
+
+ resolves the config data of every region defined in the xml file exactly the
+ way fe::Config would, and writes it as constexpr tables in the layout of
+ ConfigBuiltin.h
+*/
+
+namespace {
+
+	// escape as a C++ string literal; octal escapes cannot swallow following characters
+	std::string literal(const std::string& p_value) {
+		std::string result{ "\"" };
+
+		for (char c : p_value) {
+			const auto u{ static_cast<unsigned char>(c) };
+
+			if (c == '"' || c == '\\')
+				result += std::format("\\{}", c);
+			else if (u < 0x20 || u >= 0x7f || c == '?')
+				result += std::format("\\{:03o}", u);
+			else
+				result += c;
+		}
+
+		return result + "\"";
+	}
+
+	std::string range(std::size_t p_start, std::size_t p_count) {
+		return std::format("{{ {}, {} }}", p_start, p_count);
+	}
+
+	// one std::array per table
+	class Table {
+		std::string m_type, m_name;
+		std::size_t m_per_line;
+		std::vector<std::string> m_elements;
+
+	public:
+		Table(const std::string& p_type, const std::string& p_name, std::size_t p_per_line = 1) :
+			m_type{ p_type }, m_name{ p_name }, m_per_line{ p_per_line }
+		{
+		}
+
+		std::size_t size(void) const {
+			return m_elements.size();
+		}
+
+		void add(const std::string& p_element) {
+			m_elements.push_back(p_element);
+		}
+
+		std::string to_string(void) const {
+			std::string result{ std::format("\t\tconstexpr std::array<{}, {}> {}{{ {{\n",
+				m_type, m_elements.size(), m_name) };
+
+			for (std::size_t i{ 0 }; i < m_elements.size(); ++i)
+				result += std::format("{}{},{}",
+					i % m_per_line == 0 ? "\t\t\t" : " ", m_elements[i],
+					(i + 1) % m_per_line == 0 || i + 1 == m_elements.size() ? "\n" : "");
+
+			return result + "\t\t} };\n\n";
+		}
+	};
+
+	std::string generate(const std::string& p_config_xml) {
+		Table l_bytes("byte", "BYTES", 16);
+		Table l_names("const char*", "NAMES");
+		Table l_constants("fe::builtin::Constant", "CONSTANTS");
+		Table l_pointers("fe::builtin::Pointer", "POINTERS");
+		Table l_sets("fe::builtin::Set", "SETS");
+		Table l_byte_map_entries("fe::builtin::ByteMapEntry", "BYTE_MAP_ENTRIES");
+		Table l_byte_maps("fe::builtin::ByteMap", "BYTE_MAPS");
+		Table l_string_map_entries("fe::builtin::StringMapEntry", "STRING_MAP_ENTRIES");
+		Table l_string_maps("fe::builtin::StringMap", "STRING_MAPS");
+		Table l_bools("fe::builtin::Bool", "BOOLS");
+		Table l_bool_conditions("fe::builtin::BoolCondition", "BOOL_CONDITIONS");
+		Table l_signatures("fe::builtin::Signature", "SIGNATURES");
+		Table l_region_defs("fe::builtin::RegionDefinition", "REGION_DEFINITIONS");
+		Table l_regions("fe::builtin::RegionData", "REGIONS");
+
+		const auto add_bytes{ [&l_bytes](const std::vector<byte>& p_bytes) {
+			const std::size_t l_start{ l_bytes.size() };
+			for (byte b : p_bytes)
+				l_bytes.add(std::format("0x{:02x}", b));
+			return range(l_start, p_bytes.size());
+		} };
+
+		const auto region_defs{ fe::xml::load_region_defs(p_config_xml) };
+
+		for (const auto& def : region_defs) {
+			std::vector<std::string> l_compatible{ begin(def.m_compatible_regions),
+				end(def.m_compatible_regions) };
+			std::sort(begin(l_compatible), end(l_compatible));
+
+			const std::size_t l_names_start{ l_names.size() };
+			for (const auto& reg : l_compatible)
+				l_names.add(literal(reg));
+
+			const std::size_t l_sigs_start{ l_signatures.size() };
+			for (const auto& sig : def.m_defs)
+				l_signatures.add(std::format("{{ 0x{:x}, {} }}", sig.first, add_bytes(sig.second)));
+
+			l_region_defs.add(std::format("{{ {}, {}, {}, {}, {} }}",
+				literal(def.m_name),
+				def.m_filesize.has_value() ? "true" : "false",
+				def.m_filesize.value_or(0),
+				range(l_names_start, l_compatible.size()),
+				range(l_sigs_start, def.m_defs.size())));
+
+			// resolve the config data for this region
+			fe::ConfigRegion l_region{ def.m_name, def.m_compatible_regions };
+
+			std::map<std::string, std::size_t> l_const_map;
+			std::map<std::string, std::pair<std::size_t, std::size_t>> l_ptr_map;
+			std::map<std::string, std::vector<byte>> l_set_map;
+			std::map<std::string, std::map<byte, std::string>> l_bmap_map;
+			std::map<std::string, std::map<std::string, std::string>> l_smap_map;
+			std::map<std::string, bool> l_bool_map;
+			std::map<std::string, std::string> l_cond_map;
+
+			fe::xml::load_configuration(p_config_xml, l_region, l_const_map, l_ptr_map,
+				l_set_map, l_bmap_map, l_smap_map, l_bool_map, l_cond_map);
+
+			const std::size_t l_const_start{ l_constants.size() };
+			for (const auto& kv : l_const_map)
+				l_constants.add(std::format("{{ {}, 0x{:x} }}", literal(kv.first), kv.second));
+
+			const std::size_t l_ptr_start{ l_pointers.size() };
+			for (const auto& kv : l_ptr_map)
+				l_pointers.add(std::format("{{ {}, 0x{:x}, 0x{:x} }}", literal(kv.first),
+					kv.second.first, kv.second.second));
+
+			const std::size_t l_set_start{ l_sets.size() };
+			for (const auto& kv : l_set_map)
+				l_sets.add(std::format("{{ {}, {} }}", literal(kv.first), add_bytes(kv.second)));
+
+			const std::size_t l_bmap_start{ l_byte_maps.size() };
+			for (const auto& kv : l_bmap_map) {
+				const std::size_t l_entry_start{ l_byte_map_entries.size() };
+				for (const auto& kkv : kv.second)
+					l_byte_map_entries.add(std::format("{{ 0x{:02x}, {} }}", kkv.first, literal(kkv.second)));
+
+				l_byte_maps.add(std::format("{{ {}, {} }}", literal(kv.first),
+					range(l_entry_start, kv.second.size())));
+			}
+
+			const std::size_t l_smap_start{ l_string_maps.size() };
+			for (const auto& kv : l_smap_map) {
+				const std::size_t l_entry_start{ l_string_map_entries.size() };
+				for (const auto& kkv : kv.second)
+					l_string_map_entries.add(std::format("{{ {}, {} }}", literal(kkv.first), literal(kkv.second)));
+
+				l_string_maps.add(std::format("{{ {}, {} }}", literal(kv.first),
+					range(l_entry_start, kv.second.size())));
+			}
+
+			const std::size_t l_bool_start{ l_bools.size() };
+			for (const auto& kv : l_bool_map)
+				l_bools.add(std::format("{{ {}, {} }}", literal(kv.first), kv.second ? "true" : "false"));
+
+			const std::size_t l_cond_start{ l_bool_conditions.size() };
+			for (const auto& kv : l_cond_map)
+				l_bool_conditions.add(std::format("{{ {}, {} }}", literal(kv.first), literal(kv.second)));
+
+			l_regions.add(std::format("{{ {}, {}, {}, {}, {}, {}, {}, {} }}",
+				literal(def.m_name),
+				range(l_const_start, l_const_map.size()),
+				range(l_ptr_start, l_ptr_map.size()),
+				range(l_set_start, l_set_map.size()),
+				range(l_bmap_start, l_bmap_map.size()),
+				range(l_smap_start, l_smap_map.size()),
+				range(l_bool_start, l_bool_map.size()),
+				range(l_cond_start, l_cond_map.size())));
+		}
+
+		std::string result{ "// generated from eoe_config.xml by faxiscripts_configgen - do not edit\n\n" };
+		result += "#include <array>\n#include \"ConfigBuiltin.h\"\n\n";
+		result += "namespace fe {\n\n\tnamespace builtin {\n\n";
+
+		// the built-in tables stand in for an xml file only if it hashes the same;
+		// files of another size are rejected without reading them
+		const auto l_xml_bytes{ klib::file::read_file_as_bytes(p_config_xml) };
+		result += std::format("\t\tconstexpr std::uint64_t XML_HASH{{ 0x{:016x} }};\n",
+			klib::hash::fnv1a_64(l_xml_bytes));
+		result += std::format("\t\tconstexpr std::size_t XML_SIZE{{ {} }};\n\n", l_xml_bytes.size());
+
+		for (const auto& table : { &l_bytes, &l_names, &l_constants, &l_pointers, &l_sets,
+			&l_byte_map_entries, &l_byte_maps, &l_string_map_entries, &l_string_maps,
+			&l_bools, &l_bool_conditions, &l_signatures, &l_region_defs, &l_regions })
+			result += table->to_string();
+
+		return result + "\t}\n\n}\n";
+	}
+
+}
+
+int main(int argc, char** argv) try {
+	if (argc != 3) {
+		std::cerr << "Usage: faxiscripts_configgen <config xml> <output header>\n";
+		return 1;
+	}
+
+	klib::file::write_string_to_file(generate(argv[1]), argv[2]);
+
+	return 0;
+}
+catch (const std::exception& ex) {
+	std::cerr << "Runtime error: " << ex.what() << "\n";
+	return 1;
+}
@@ -1,31 +1,25 @@
 #include "Xml_helper.h"
 #include "Xml_constants.h"
 #include "./../Config.h"
+#include "./../../common/klib/Kprofile.h"
+#include <algorithm>
+#include <filesystem>
 #include <format>
+#include <mutex>
 #include <stdexcept>
 
 using byte = unsigned char;
 
-void fe::xml::load_configuration(const std::string& p_config_xml,
-	const fe::ConfigRegion& p_region,
-	std::map<std::string, std::size_t>& p_constants,
-	std::map<std::string, std::pair<std::size_t, std::size_t>>& p_pointers,
-	std::map<std::string, std::vector<byte>>& p_sets,
-	std::map<std::string, std::map<byte, std::string>>& p_byte_maps,
-	std::map<std::string, std::map<std::string, std::string>>& p_string_maps,
-	std::map<std::string, bool>& p_bools,
-	const std::vector<byte>& p_rom,
-	bool p_throw_on_file_not_exists) {
-	pugi::xml_document l_doc;
+fe::xml::ConfigDocument::ConfigDocument(const std::string& p_config_xml,
+	bool& p_file_found) {
+	klib::prof::Scope l_prof("xml parse", p_config_xml);
+
+	auto loadresult{ m_doc.load_file(p_config_xml.c_str()) };
+	p_file_found = (loadresult.status != pugi::status_file_not_found);
 
-	auto loadresult{ l_doc.load_file(p_config_xml.c_str()) };
 	if (!loadresult) {
-		if (loadresult.status == pugi::status_file_not_found) {
-			if (p_throw_on_file_not_exists)
-				throw std::runtime_error("File not found: " + p_config_xml);
-			else
-				return;
-		}
+		if (!p_file_found)
+			return;
 		else {
 			throw std::runtime_error(std::format(
 				"Could not parse XML file '{}': {} (offset {})",
@@ -36,229 +30,288 @@ void fe::xml::load_configuration(const std::string& p_config_xml,
 		}
 	}
 
-	auto n_root{ l_doc.child(c::TAG_CONFIG_ROOT) };
+	auto n_root{ m_doc.child(c::TAG_CONFIG_ROOT) };
+
 	if (!n_root)
 		throw std::runtime_error(std::format(
 			"Invalid XML file '{}': missing <{}> root element",
 			p_config_xml, c::TAG_CONFIG_ROOT
 		));
 
-	// constants
-	auto n_consts{ n_root.child(c::TAG_CONSTANTS) };
-	if (n_consts) {
-		for (auto n_const{ n_consts.child(c::TAG_CONSTANT) }; n_const;
-			n_const = n_const.next_sibling(c::TAG_CONSTANT)) {
+	auto n_regions{ n_root.child(c::TAG_REGIONS) };
 
-			if (matches_config_region(n_const, p_region)) {
+	if (n_regions) {
+		for (auto n_region{ n_regions.child(c::TAG_REGION) }; n_region;
+			n_region = n_region.next_sibling(c::TAG_REGION)) {
+			fe::RegionDefinition l_region;
 
-				std::string l_name{ n_const.attribute(c::ATTR_NAME).as_string() };
+			l_region.m_name = n_region.attribute(c::ATTR_NAME).as_string();
+			if (n_region.attribute(c::ATTR_FILE_SIZE))
+				l_region.m_filesize = parse_numeric(n_region.attribute(c::ATTR_FILE_SIZE).as_string());
 
-				if (p_constants.find(l_name) == end(p_constants))
-					p_constants.insert(std::make_pair(l_name,
-						parse_numeric(n_const.attribute(c::ATTR_VALUE).as_string())
-					));
+			if (n_region.attribute(c::ATTR_COMPATIBLE_REGIONS)) {
+
+				for (const auto& reg : split_csv(n_region.attribute(
+					c::ATTR_COMPATIBLE_REGIONS).as_string())) {
+					l_region.m_compatible_regions.insert(reg);
+				}
 			}
-		}
-	}
 
-	// pointers
-	auto n_ptrs{ n_root.child(c::TAG_POINTERS) };
-	if (n_ptrs) {
-		for (auto n_ptr{ n_ptrs.child(c::TAG_POINTER) }; n_ptr;
-			n_ptr = n_ptr.next_sibling(c::TAG_POINTER)) {
-
-			if (matches_config_region(n_ptr, p_region)) {
-
-				std::string l_name{ n_ptr.attribute(c::ATTR_NAME).as_string() };
-
-				if (p_pointers.find(l_name) == end(p_pointers))
-					p_pointers.insert(std::make_pair(l_name,
-						std::make_pair(
-							parse_numeric(n_ptr.attribute(c::ATTR_VALUE).as_string()),
-							parse_numeric(n_ptr.attribute(c::ATTR_ZERO_ADDR).as_string())
-						)
-					));
+			for (auto n_sig{ n_region.child(c::TAG_SIGNATURE) }; n_sig;
+				n_sig = n_sig.next_sibling(c::TAG_SIGNATURE)) {
+				l_region.m_defs.push_back(std::make_pair(
+					parse_numeric(n_sig.attribute(c::ATTR_OFFSET).as_string()),
+					parse_byte_list(n_sig.attribute(c::ATTR_VALUES).as_string())
+				));
 			}
+
+			m_region_defs.push_back(l_region);
 		}
 	}
 
-	// sets
-	auto n_sets{ n_root.child(c::TAG_SETS) };
-	if (n_sets) {
-		for (auto n_set{ n_sets.child(c::TAG_SET) }; n_set;
-			n_set = n_set.next_sibling(c::TAG_SET)) {
+	index_section(n_root, c::TAG_CONSTANTS, c::TAG_CONSTANT);
+	index_section(n_root, c::TAG_POINTERS, c::TAG_POINTER);
+	index_section(n_root, c::TAG_SETS, c::TAG_SET);
+	index_section(n_root, c::TAG_BOOLS, c::TAG_BOOL);
+	index_section(n_root, c::TAG_BYTE_TO_STR_MAPS, c::TAG_BYTE_TO_STR_MAP);
+	index_section(n_root, c::TAG_STRING_TO_STR_MAPS, c::TAG_STRING_TO_STR_MAP);
+}
 
-			if (matches_config_region(n_set, p_region)) {
+void fe::xml::ConfigDocument::index_section(const pugi::xml_node& p_root,
+	const char* p_section_tag, const char* p_element_tag) {
+	auto& section{ m_sections[p_element_tag] };
 
-				std::string l_name{ n_set.attribute(c::ATTR_NAME).as_string() };
+	auto n_section{ p_root.child(p_section_tag) };
+	if (!n_section)
+		return;
 
-				if (p_sets.find(l_name) == end(p_sets))
-					p_sets.insert(std::make_pair(l_name,
-						parse_byte_list(n_set.attribute(c::ATTR_VALUES).as_string())
-					));
-			}
-		}
-	}
+	for (auto n_elem{ n_section.child(p_element_tag) }; n_elem;
+		n_elem = n_elem.next_sibling(p_element_tag)) {
+		const std::size_t l_index{ section.nodes.size() };
 
-	// bools
-	auto n_bools{ n_root.child(c::TAG_BOOLS) };
-	if (n_bools) {
-		for (auto n_bool{ n_bools.child(c::TAG_BOOL) }; n_bool;
-			n_bool = n_bool.next_sibling(c::TAG_BOOL)) {
-
-			if (matches_config_region(n_bool, p_region)) {
-
-				std::string l_name{ n_bool.attribute(c::ATTR_NAME).as_string() };
-
-				if (p_bools.find(l_name) == end(p_bools)) {
-					bool final_bool_value{ false };
-
-					if (n_bool.attribute(c::ATTR_VALUE)) {
-						final_bool_value = n_bool.attribute(c::ATTR_VALUE).as_bool();
-					}
-					else if (n_bool.attribute(c::ATTR_CONDITION)) {
-						final_bool_value = evaluate_bool_condition(
-							p_rom,
-							n_bool.attribute(c::ATTR_CONDITION).as_string());
-					}
-					else
-						throw std::runtime_error(
-							std::format("Boolean '{}' has neither value nor condition", l_name)
-						);
-
-					p_bools.insert(std::make_pair(l_name, final_bool_value));
-				}
-			}
-		}
+		section.nodes.push_back(fe::xml::ConfigNode{ n_elem,
+			n_elem.attribute(c::ATTR_NAME).as_string(),
+			n_elem.attribute(c::ATTR_EXACT_MATCH_ONLY).as_bool(false) });
+
+		if (!n_elem.attribute(c::TAG_REGION))
+			section.untagged.push_back(l_index);
+		else
+			for (const auto& region : split_csv(n_elem.attribute(c::TAG_REGION).as_string()))
+				section.by_region[region].push_back(l_index);
 	}
+}
 
-	// maps byte -> string (labels, char maps etc)
-	auto n_bmaps{ n_root.child(c::TAG_BYTE_TO_STR_MAPS) };
-	if (n_bmaps) {
-		for (auto n_bmap{ n_bmaps.child(c::TAG_BYTE_TO_STR_MAP) }; n_bmap;
-			n_bmap = n_bmap.next_sibling(c::TAG_BYTE_TO_STR_MAP)) {
+const std::vector<fe::RegionDefinition>& fe::xml::ConfigDocument::region_defs(void) const {
+	return m_region_defs;
+}
 
-			if (matches_config_region(n_bmap, p_region)) {
+std::vector<const fe::xml::ConfigNode*> fe::xml::ConfigDocument::nodes(
+	const std::string& p_element_tag, const fe::ConfigRegion& p_region) const {
+	std::vector<const fe::xml::ConfigNode*> result;
 
-				std::string l_name{ n_bmap.attribute(c::ATTR_NAME).as_string() };
+	const auto iter{ m_sections.find(p_element_tag) };
+	if (iter == end(m_sections))
+		return result;
 
-				if (p_byte_maps.find(l_name) == end(p_byte_maps)) {
-					std::map<byte, std::string> l_tmp_bmap;
+	const auto& section{ iter->second };
 
-					for (auto n_entry{ n_bmap.child(c::TAG_ENTRY) }; n_entry;
-						n_entry = n_entry.next_sibling(c::TAG_ENTRY)) {
+	// untagged elements, elements tagged with our region, and non-exact
+	// elements tagged with a compatible region
+	std::vector<std::size_t> l_indexes{ section.untagged };
 
-						const byte l_key{ parse_numeric_byte(n_entry.attribute(c::ATTR_BYTE).as_string()) };
+	const auto add_region{ [&](const std::string& p_region_name, bool p_exact) {
+		const auto region_iter{ section.by_region.find(p_region_name) };
+		if (region_iter == end(section.by_region))
+			return;
 
-						if (l_tmp_bmap.find(l_key) != end(l_tmp_bmap))
-							throw std::runtime_error(std::format(
-								"Duplicate byte key {} in byte_to_string_map '{}'",
-								byte_to_hex(l_key), l_name));
+		for (std::size_t idx : region_iter->second)
+			if (p_exact || !section.nodes[idx].exact_match_only)
+				l_indexes.push_back(idx);
+	} };
 
-						l_tmp_bmap.insert(std::make_pair(
-							l_key,
-							n_entry.attribute(c::ATTR_STRING).as_string()
-						));
-					}
+	add_region(p_region.region, true);
+	for (const auto& region : p_region.compatible_regions)
+		add_region(region, false);
 
-					p_byte_maps.insert(std::make_pair(l_name, l_tmp_bmap));
-				}
-			}
-		}
-	}
+	// restore document order, and drop elements tagged with several of our regions
+	std::sort(begin(l_indexes), end(l_indexes));
+	l_indexes.erase(std::unique(begin(l_indexes), end(l_indexes)), end(l_indexes));
 
-	// maps string -> string
-	auto n_str_maps{ n_root.child(c::TAG_STRING_TO_STR_MAPS) };
-	if (n_str_maps) {
-		for (auto n_str_map{ n_str_maps.child(c::TAG_STRING_TO_STR_MAP) }; n_str_map;
-			n_str_map = n_str_map.next_sibling(c::TAG_STRING_TO_STR_MAP)) {
+	for (std::size_t idx : l_indexes)
+		result.push_back(&section.nodes[idx]);
+
+	return result;
+}
 
-			if (matches_config_region(n_str_map, p_region)) {
+std::shared_ptr<const fe::xml::ConfigDocument> fe::xml::get_config_document(
+	const std::string& p_config_xml, bool p_throw_on_file_not_exists) {
 
-				std::string l_name{ n_str_map.attribute(c::ATTR_NAME).as_string() };
+	struct CachedDocument {
+		std::filesystem::file_time_type write_time;
+		std::shared_ptr<const fe::xml::ConfigDocument> document;
+	};
 
-				if (p_string_maps.find(l_name) == end(p_string_maps)) {
-					std::map<std::string, std::string> l_tmp_str_map;
+	static std::mutex s_mutex;
+	static std::map<std::string, CachedDocument> s_documents;
 
-					for (auto n_entry{ n_str_map.child(c::TAG_ENTRY) }; n_entry;
-						n_entry = n_entry.next_sibling(c::TAG_ENTRY)) {
-						l_tmp_str_map.insert(std::make_pair(
-							n_entry.attribute(c::ATTR_KEY).as_string(),
-							n_entry.attribute(c::ATTR_VALUE).as_string()
-						));
-					}
+	std::error_code ec;
+	const auto l_write_time{ std::filesystem::last_write_time(p_config_xml, ec) };
 
-					p_string_maps.insert(std::make_pair(l_name, l_tmp_str_map));
-				}
-			}
+	std::shared_ptr<const fe::xml::ConfigDocument> result;
+
+	if (!ec) {
+		std::lock_guard<std::mutex> lock(s_mutex);
+
+		auto iter{ s_documents.find(p_config_xml) };
+		if (iter != end(s_documents) && iter->second.write_time == l_write_time)
+			result = iter->second.document;
+		else {
+			bool l_file_found{ false };
+			result = std::make_shared<const fe::xml::ConfigDocument>(p_config_xml, l_file_found);
+
+			if (l_file_found)
+				s_documents.insert_or_assign(p_config_xml, CachedDocument{ l_write_time, result });
+			else
+				result.reset();
 		}
 	}
 
+	if (!result && p_throw_on_file_not_exists)
+		throw std::runtime_error("File not found: " + p_config_xml);
+
+	return result;
 }
 
-std::vector<fe::RegionDefinition> fe::xml::load_region_defs(const std::string& p_config_xml_file,
+void fe::xml::load_configuration(const std::string& p_config_xml,
+	const fe::ConfigRegion& p_region,
+	std::map<std::string, std::size_t>& p_constants,
+	std::map<std::string, std::pair<std::size_t, std::size_t>>& p_pointers,
+	std::map<std::string, std::vector<byte>>& p_sets,
+	std::map<std::string, std::map<byte, std::string>>& p_byte_maps,
+	std::map<std::string, std::map<std::string, std::string>>& p_string_maps,
+	std::map<std::string, bool>& p_bools,
+	std::map<std::string, std::string>& p_bool_conditions,
 	bool p_throw_on_file_not_exists) {
-	std::vector<fe::RegionDefinition> result;
+	klib::prof::Scope l_prof("xml config data", p_config_xml);
 
-	pugi::xml_document l_doc;
-	auto loadresult{ l_doc.load_file(p_config_xml_file.c_str()) };
-	if (!loadresult) {
-		if (loadresult.status == pugi::status_file_not_found) {
-			if (p_throw_on_file_not_exists)
-				throw std::runtime_error("File not found: " + p_config_xml_file);
-			else
-				return result;
-		}
-		else {
-			throw std::runtime_error(std::format(
-				"Could not parse XML file '{}': {} (offset {})",
-				p_config_xml_file,
-				loadresult.description(),
-				loadresult.offset
+	const auto l_doc{ get_config_document(p_config_xml, p_throw_on_file_not_exists) };
+	if (!l_doc)
+		return;
+
+	const auto get_entry_count{ [&]() {
+		return p_constants.size() + p_pointers.size() + p_sets.size() +
+			p_byte_maps.size() + p_string_maps.size() + p_bools.size() +
+			p_bool_conditions.size();
+	} };
+	const std::size_t l_entry_count{ get_entry_count() };
+
+	// constants
+	for (const auto n_const : l_doc->nodes(c::TAG_CONSTANT, p_region))
+		if (p_constants.find(n_const->name) == end(p_constants))
+			p_constants.insert(std::make_pair(n_const->name,
+				parse_numeric(n_const->node.attribute(c::ATTR_VALUE).as_string())
+			));
+
+	// pointers
+	for (const auto n_ptr : l_doc->nodes(c::TAG_POINTER, p_region))
+		if (p_pointers.find(n_ptr->name) == end(p_pointers))
+			p_pointers.insert(std::make_pair(n_ptr->name,
+				std::make_pair(
+					parse_numeric(n_ptr->node.attribute(c::ATTR_VALUE).as_string()),
+					parse_numeric(n_ptr->node.attribute(c::ATTR_ZERO_ADDR).as_string())
+				)
+			));
+
+	// sets
+	for (const auto n_set : l_doc->nodes(c::TAG_SET, p_region))
+		if (p_sets.find(n_set->name) == end(p_sets))
+			p_sets.insert(std::make_pair(n_set->name,
+				parse_byte_list(n_set->node.attribute(c::ATTR_VALUES).as_string())
 			));
+
+	// bools
+	for (const auto n_bool : l_doc->nodes(c::TAG_BOOL, p_region)) {
+		const std::string& l_name{ n_bool->name };
+
+		if (p_bools.find(l_name) == end(p_bools) &&
+			p_bool_conditions.find(l_name) == end(p_bool_conditions)) {
+
+			if (n_bool->node.attribute(c::ATTR_VALUE)) {
+				p_bools.insert(std::make_pair(l_name,
+					n_bool->node.attribute(c::ATTR_VALUE).as_bool()));
+			}
+			// conditions are evaluated against the ROM by the caller
+			else if (n_bool->node.attribute(c::ATTR_CONDITION)) {
+				p_bool_conditions.insert(std::make_pair(l_name,
+					n_bool->node.attribute(c::ATTR_CONDITION).as_string()));
+			}
+			else
+				throw std::runtime_error(
+					std::format("Boolean '{}' has neither value nor condition", l_name)
+				);
 		}
 	}
 
-	auto n_root{ l_doc.child(c::TAG_CONFIG_ROOT) };
-
-	if (!n_root)
-		throw std::runtime_error(std::format(
-			"Invalid XML file '{}': missing <{}> root element",
-			p_config_xml_file, c::TAG_CONFIG_ROOT
-		));
+	// maps byte -> string (labels, char maps etc)
+	for (const auto n_bmap : l_doc->nodes(c::TAG_BYTE_TO_STR_MAP, p_region)) {
+		const std::string& l_name{ n_bmap->name };
 
-	auto n_regions{ n_root.child(c::TAG_REGIONS) };
+		if (p_byte_maps.find(l_name) == end(p_byte_maps)) {
+			std::map<byte, std::string> l_tmp_bmap;
 
-	if (n_regions) {
-		for (auto n_region{ n_regions.child(c::TAG_REGION) }; n_region;
-			n_region = n_region.next_sibling(c::TAG_REGION)) {
-			fe::RegionDefinition l_region;
+			for (auto n_entry{ n_bmap->node.child(c::TAG_ENTRY) }; n_entry;
+				n_entry = n_entry.next_sibling(c::TAG_ENTRY)) {
 
-			l_region.m_name = n_region.attribute(c::ATTR_NAME).as_string();
-			if (n_region.attribute(c::ATTR_FILE_SIZE))
-				l_region.m_filesize = parse_numeric(n_region.attribute(c::ATTR_FILE_SIZE).as_string());
+				const byte l_key{ parse_numeric_byte(n_entry.attribute(c::ATTR_BYTE).as_string()) };
 
-			if (n_region.attribute(c::ATTR_COMPATIBLE_REGIONS)) {
+				if (l_tmp_bmap.find(l_key) != end(l_tmp_bmap))
+					throw std::runtime_error(std::format(
+						"Duplicate byte key {} in byte_to_string_map '{}'",
+						byte_to_hex(l_key), l_name));
 
-				for (const auto& reg : split_csv(n_region.attribute(
-					c::ATTR_COMPATIBLE_REGIONS).as_string())) {
-					l_region.m_compatible_regions.insert(reg);
-				}
+				l_tmp_bmap.insert(std::make_pair(
+					l_key,
+					n_entry.attribute(c::ATTR_STRING).as_string()
+				));
 			}
 
-			for (auto n_sig{ n_region.child(c::TAG_SIGNATURE) }; n_sig;
-				n_sig = n_sig.next_sibling(c::TAG_SIGNATURE)) {
-				l_region.m_defs.push_back(std::make_pair(
-					parse_numeric(n_sig.attribute(c::ATTR_OFFSET).as_string()),
-					parse_byte_list(n_sig.attribute(c::ATTR_VALUES).as_string())
+			p_byte_maps.insert(std::make_pair(l_name, l_tmp_bmap));
+		}
+	}
+
+	// maps string -> string
+	for (const auto n_str_map : l_doc->nodes(c::TAG_STRING_TO_STR_MAP, p_region)) {
+		const std::string& l_name{ n_str_map->name };
+
+		if (p_string_maps.find(l_name) == end(p_string_maps)) {
+			std::map<std::string, std::string> l_tmp_str_map;
+
+			for (auto n_entry{ n_str_map->node.child(c::TAG_ENTRY) }; n_entry;
+				n_entry = n_entry.next_sibling(c::TAG_ENTRY)) {
+				l_tmp_str_map.insert(std::make_pair(
+					n_entry.attribute(c::ATTR_KEY).as_string(),
+					n_entry.attribute(c::ATTR_VALUE).as_string()
 				));
 			}
 
-			result.push_back(l_region);
+			p_string_maps.insert(std::make_pair(l_name, l_tmp_str_map));
 		}
 	}
 
-	return result;
+	l_prof.count("entries", get_entry_count() - l_entry_count);
+}
+
+std::vector<fe::RegionDefinition> fe::xml::load_region_defs(const std::string& p_config_xml_file,
+	bool p_throw_on_file_not_exists) {
+	klib::prof::Scope l_prof("xml region definitions", p_config_xml_file);
+
+	const auto l_doc{ get_config_document(p_config_xml_file, p_throw_on_file_not_exists) };
+	if (!l_doc)
+		return std::vector<fe::RegionDefinition>();
+
+	l_prof.count("regions", l_doc->region_defs().size());
+
+	return l_doc->region_defs();
 }
 
 std::string fe::xml::join_bytes(const std::vector<byte>& p_bytes, bool p_hex) {
@@ -400,7 +453,7 @@ bool fe::xml::matches_config_region(const pugi::xml_node& p_node,
 	);
 }
 
-bool fe::xml::is_byte_match(const std::vector<byte>& p_rom, std::size_t p_offset,
+bool fe::xml::is_byte_match(klib::RomView p_rom, std::size_t p_offset,
 	const std::vector<byte>& p_vals) {
 	if (p_rom.size() < (p_offset + p_vals.size()))
 		return false;
@@ -412,55 +465,106 @@ bool fe::xml::is_byte_match(const std::vector<byte>& p_rom, std::size_t p_offset
 	return true;
 }
 
-bool fe::xml::evaluate_bool_condition(const std::vector<byte>& p_rom,
-	const std::string& p_condition) {
-	std::size_t pos{ 0 };
+namespace {
 
-	while (pos < p_condition.size()) {
+	std::mutex g_condition_mutex;
+	std::map<std::string, std::shared_ptr<const fe::xml::CompiledCondition>> g_conditions;
 
-		// skip whitespace
-		while (pos < p_condition.size() &&
-			std::isspace(static_cast<unsigned char>(p_condition[pos])))
-			++pos;
+	// the caller holds g_condition_mutex
+	std::shared_ptr<const fe::xml::CompiledCondition> get_compiled_condition(
+		const std::string& p_condition) {
+		auto iter{ g_conditions.find(p_condition) };
+		if (iter != end(g_conditions))
+			return iter->second;
 
-		if (pos >= p_condition.size())
-			break;
+		fe::xml::CompiledCondition result;
+		std::size_t pos{ 0 };
 
-		auto eq_pos{ p_condition.find('=', pos) };
+		while (pos < p_condition.size()) {
 
-		if (eq_pos == std::string::npos)
-			throw std::runtime_error(
-				"Invalid condition expression: " + p_condition);
+			// skip whitespace
+			while (pos < p_condition.size() &&
+				std::isspace(static_cast<unsigned char>(p_condition[pos])))
+				++pos;
 
-		std::string offset_str{
-			trim_whitespace(
-				p_condition.substr(pos, eq_pos - pos))
-		};
+			if (pos >= p_condition.size())
+				break;
 
-		pos = eq_pos + 1;
+			auto eq_pos{ p_condition.find('=', pos) };
 
-		std::size_t end_pos{ pos };
+			if (eq_pos == std::string::npos)
+				throw std::runtime_error(
+					"Invalid condition expression: " + p_condition);
 
-		while (end_pos < p_condition.size() &&
-			!std::isspace(static_cast<unsigned char>(p_condition[end_pos])))
-			++end_pos;
+			std::string offset_str{
+				fe::xml::trim_whitespace(
+					p_condition.substr(pos, eq_pos - pos))
+			};
 
-		std::string bytes_str{
-			p_condition.substr(pos, end_pos - pos)
-		};
+			pos = eq_pos + 1;
 
-		pos = end_pos;
+			std::size_t end_pos{ pos };
 
-		const auto offset{ parse_numeric(offset_str) };
-		const auto bytes{ parse_byte_list(bytes_str) };
+			while (end_pos < p_condition.size() &&
+				!std::isspace(static_cast<unsigned char>(p_condition[end_pos])))
+				++end_pos;
 
-		if (!is_byte_match(p_rom, offset, bytes))
-			return false;
+			std::string bytes_str{
+				p_condition.substr(pos, end_pos - pos)
+			};
+
+			pos = end_pos;
+
+			result.m_terms.push_back(std::make_pair(
+				fe::xml::parse_numeric(offset_str),
+				fe::xml::parse_byte_list(bytes_str)));
+		}
+
+		auto l_compiled{ std::make_shared<const fe::xml::CompiledCondition>(std::move(result)) };
+		g_conditions.insert(std::make_pair(p_condition, l_compiled));
+
+		return l_compiled;
 	}
 
+}
+
+bool fe::xml::evaluate_bool_condition(klib::RomView p_rom,
+	const std::string& p_condition) {
+	return evaluate_bool_condition(p_rom, *compile_bool_condition(p_condition));
+}
+
+std::shared_ptr<const fe::xml::CompiledCondition> fe::xml::compile_bool_condition(
+	const std::string& p_condition) {
+	std::lock_guard<std::mutex> lock(g_condition_mutex);
+	return get_compiled_condition(p_condition);
+}
+
+bool fe::xml::evaluate_bool_condition(klib::RomView p_rom,
+	const fe::xml::CompiledCondition& p_condition) {
+	for (const auto& term : p_condition.m_terms)
+		if (!is_byte_match(p_rom, term.first, term.second))
+			return false;
+
 	return true;
 }
 
+std::map<std::string, bool> fe::xml::evaluate_bool_conditions(klib::RomView p_rom,
+	const std::map<std::string, std::string>& p_conditions) {
+	std::vector<std::pair<const std::string*, std::shared_ptr<const fe::xml::CompiledCondition>>> l_compiled;
+
+	{
+		std::lock_guard<std::mutex> lock(g_condition_mutex);
+		for (const auto& kv : p_conditions)
+			l_compiled.push_back(std::make_pair(&kv.first, get_compiled_condition(kv.second)));
+	}
+
+	std::map<std::string, bool> result;
+	for (const auto& cond : l_compiled)
+		result.insert(std::make_pair(*cond.first, evaluate_bool_condition(p_rom, *cond.second)));
+
+	return result;
+}
+
 std::vector<std::string> fe::xml::split_csv(const std::string& p_values) {
 	std::vector<std::string> result;
 
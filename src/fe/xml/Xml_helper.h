@@ -2,6 +2,7 @@
 #define FE_XML_HELPER_H
 
 #include <map>
+#include <memory>
 #include <string>
 #include <optional>
 #include <unordered_set>
@@ -9,6 +10,7 @@
 #include <vector>
 #include "./../../common/pugixml/pugixml.hpp"
 #include "./../../common/pugixml/pugiconfig.hpp"
+#include "./../../common/klib/Krom.h"
 
 using byte = unsigned char;
 
@@ -27,6 +29,44 @@ namespace fe {
 
 	namespace xml {
 
+		// a named element of one of the config sections
+		struct ConfigNode {
+			pugi::xml_node node;
+			std::string name;
+			bool exact_match_only;
+		};
+
+		// a parsed config xml file, indexed by section and region tag in one pass
+		class ConfigDocument {
+			struct Section {
+				std::vector<fe::xml::ConfigNode> nodes;
+				// indexes into nodes, in document order
+				std::vector<std::size_t> untagged;
+				std::map<std::string, std::vector<std::size_t>> by_region;
+			};
+
+			pugi::xml_document m_doc;
+			std::vector<fe::RegionDefinition> m_region_defs;
+			// keyed by element tag
+			std::map<std::string, Section> m_sections;
+
+			void index_section(const pugi::xml_node& p_root, const char* p_section_tag,
+				const char* p_element_tag);
+
+		public:
+			ConfigDocument(const std::string& p_config_xml, bool& p_file_found);
+
+			const std::vector<fe::RegionDefinition>& region_defs(void) const;
+			// all elements with the given tag that apply to the region, in document order
+			std::vector<const fe::xml::ConfigNode*> nodes(const std::string& p_element_tag,
+				const fe::ConfigRegion& p_region) const;
+		};
+
+		// each file is parsed once per process, and again only when it changes on disk;
+		// nullptr if the file does not exist and p_throw_on_file_not_exists is false
+		std::shared_ptr<const fe::xml::ConfigDocument> get_config_document(
+			const std::string& p_config_xml, bool p_throw_on_file_not_exists);
+
 		std::vector<RegionDefinition> load_region_defs(const std::string& p_xml_file,
 			bool p_throw_on_file_not_exists = true);
 		void load_configuration(const std::string& p_config_xml,
@@ -37,7 +77,7 @@ namespace fe {
 			std::map<std::string, std::map<byte, std::string>>& p_byte_maps,
 			std::map<std::string, std::map<std::string, std::string>>& p_string_maps,
 			std::map<std::string, bool>& p_bools,
-			const std::vector<byte>& p_rom,
+			std::map<std::string, std::string>& p_bool_conditions,
 			bool p_throw_on_file_not_exists = true);
 
 		// utility
@@ -53,10 +93,24 @@ namespace fe {
 			bool exact_match_only);
 		bool matches_config_region(const pugi::xml_node& p_node,
 			const fe::ConfigRegion& p_region);
-		bool is_byte_match(const std::vector<byte>& p_rom, std::size_t p_offset,
+		bool is_byte_match(klib::RomView p_rom, std::size_t p_offset,
 			const std::vector<byte>& p_vals);
-		bool evaluate_bool_condition(const std::vector<byte>& p_rom,
+		bool evaluate_bool_condition(klib::RomView p_rom,
+			const std::string& p_condition);
+
+		// a conditional boolean is true if every byte sequence matches at its ROM offset
+		struct CompiledCondition {
+			std::vector<std::pair<std::size_t, std::vector<byte>>> m_terms;
+		};
+
+		// parsed once per process and condition string
+		std::shared_ptr<const fe::xml::CompiledCondition> compile_bool_condition(
 			const std::string& p_condition);
+		bool evaluate_bool_condition(klib::RomView p_rom,
+			const fe::xml::CompiledCondition& p_condition);
+		// all conditions of a config against one ROM, by boolean name
+		std::map<std::string, bool> evaluate_bool_conditions(klib::RomView p_rom,
+			const std::map<std::string, std::string>& p_conditions);
 
 		std::vector<std::string> split_csv(const std::string& p_values);
 	}
@@ -1,6 +1,7 @@
 #include "HackManager.h"
 #include "fh_constants.h"
 #include "./../common/klib/Asm6502.h"
+#include "./../common/klib/Kprofile.h"
 #include "./../common/klib/Kstring.h"
 #include <algorithm>
 #include <cassert>
@@ -11,8 +12,9 @@
 
 // reads the next script operand as a flag number, stores the byte number (relative to start of flags block)
 // in X, and the bit number (0-7) in that byte in Y
-word fh::HackManager::apply_helper_DecodeScriptFlag(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_helper_DecodeScriptFlag(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr) const {
+	klib::prof::Scope l_prof("HackManager::apply_helper_DecodeScriptFlag");
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = flag no
@@ -33,7 +35,8 @@ word fh::HackManager::apply_helper_DecodeScriptFlag(const fe::Config& p_config,
 // reads the next script operand as a quest flag number (0-7)
 // and stores the corresponding bit number in Y
 word fh::HackManager::apply_helper_DecodeQuestFlag(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
+	klib::prof::Scope l_prof("HackManager::apply_helper_DecodeQuestFlag");
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = quest flag no
@@ -46,8 +49,9 @@ word fh::HackManager::apply_helper_DecodeQuestFlag(const fe::Config& p_config,
 }
 
 // if A equals the operand, jump - otherwise continue script execution
-word fh::HackManager::apply_helper_IfAEquals(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_helper_IfAEquals(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr) const {
+	klib::prof::Scope l_prof("HackManager::apply_helper_IfAEquals");
 	klib::Asm6502 code;
 
 	code.pha();
@@ -65,8 +69,9 @@ word fh::HackManager::apply_helper_IfAEquals(const fe::Config& p_config, std::ve
 }
 
 // if min <= A <= max, jump - otherwise continue script execution
-word fh::HackManager::apply_helper_IfABetween(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_helper_IfABetween(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr) const {
+	klib::prof::Scope l_prof("HackManager::apply_helper_IfABetween");
 	klib::Asm6502 code;
 
 	// preserve value to test
@@ -103,8 +108,9 @@ word fh::HackManager::apply_helper_IfABetween(const fe::Config& p_config, std::v
 
 // Converts the player's current pixel position to a block position.
 // Returns: X = (Y_block << 4) | X_block
-word fh::HackManager::apply_helper_GetPlayerBlockPos(std::vector<byte>& p_rom,
+word fh::HackManager::apply_helper_GetPlayerBlockPos(klib::RomImage& p_rom,
 	word cpu_addr) const {
+	klib::prof::Scope l_prof("HackManager::apply_helper_GetPlayerBlockPos");
 	klib::Asm6502 code;
 
 	code.lda_zp(RAM::ZP_PlayerPosX);
@@ -123,8 +129,9 @@ word fh::HackManager::apply_helper_GetPlayerBlockPos(std::vector<byte>& p_rom,
 }
 
 // helper which reads the next script operand as a 16-bit cpu address and stores it in ($e2,$e3)
-word fh::HackManager::apply_helper_LoadWord(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_helper_LoadWord(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr) const {
+	klib::prof::Scope l_prof("HackManager::apply_helper_LoadWord");
 	klib::Asm6502 code;
 
 	// lo byte
@@ -141,7 +148,7 @@ word fh::HackManager::apply_helper_LoadWord(const fe::Config& p_config, std::vec
 }
 
 // script library hacks
-word fh::HackManager::apply_SetFlag(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_SetFlag(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr, word flag_decode_helper_addr, word bitmask_table_addr) const {
 	klib::Asm6502 code;
 
@@ -156,7 +163,7 @@ word fh::HackManager::apply_SetFlag(const fe::Config& p_config, std::vector<byte
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_ClearFlag(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_ClearFlag(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr, word flag_decode_helper_addr, word bitmask_table_addr) const {
 	klib::Asm6502 code;
 
@@ -176,7 +183,7 @@ word fh::HackManager::apply_ClearFlag(const fe::Config& p_config, std::vector<by
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_IfFlag(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_IfFlag(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr, word flag_decode_helper_addr, word bitmask_table_addr) const {
 	klib::Asm6502 code;
 
@@ -194,7 +201,7 @@ word fh::HackManager::apply_IfFlag(const fe::Config& p_config, std::vector<byte>
 }
 
 word fh::HackManager::apply_SelectFlag(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	const word SelectedFlagRamAddr{ cfg_word(p_config, c::ID_HACK_SCRIPT_SELECTED_FLAG_RAM_ADDR) };
@@ -210,7 +217,7 @@ word fh::HackManager::apply_SelectFlag(const fe::Config& p_config,
 }
 
 word fh::HackManager::apply_SetSelectedFlag(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr, word bitmask_table_addr) const {
+	klib::RomImage& p_rom, word cpu_addr, word bitmask_table_addr) const {
 	klib::Asm6502 code;
 
 	const word SelectedFlagRamAddr{ cfg_word(p_config, c::ID_HACK_SCRIPT_SELECTED_FLAG_RAM_ADDR) };
@@ -243,7 +250,7 @@ word fh::HackManager::apply_SetSelectedFlag(const fe::Config& p_config,
 }
 
 word fh::HackManager::apply_ClearSelectedFlag(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr, word bitmask_table_addr) const {
+	klib::RomImage& p_rom, word cpu_addr, word bitmask_table_addr) const {
 	klib::Asm6502 code;
 
 	const word SelectedFlagRamAddr{ cfg_word(p_config, c::ID_HACK_SCRIPT_SELECTED_FLAG_RAM_ADDR) };
@@ -281,7 +288,7 @@ word fh::HackManager::apply_ClearSelectedFlag(const fe::Config& p_config,
 }
 
 word fh::HackManager::apply_IfSelectedFlag(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr, word bitmask_table_addr) const {
+	klib::RomImage& p_rom, word cpu_addr, word bitmask_table_addr) const {
 	klib::Asm6502 code;
 
 	const word SelectedFlagRamAddr{ cfg_word(p_config, c::ID_HACK_SCRIPT_SELECTED_FLAG_RAM_ADDR) };
@@ -316,7 +323,7 @@ word fh::HackManager::apply_IfSelectedFlag(const fe::Config& p_config,
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_SetQuestFlag(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_SetQuestFlag(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr, word quest_flag_decode_helper_addr, word bitmask_table_addr) const {
 	klib::Asm6502 code;
 
@@ -331,7 +338,7 @@ word fh::HackManager::apply_SetQuestFlag(const fe::Config& p_config, std::vector
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_ClearQuestFlag(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_ClearQuestFlag(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr, word quest_flag_decode_helper_addr, word bitmask_table_addr) const {
 	klib::Asm6502 code;
 
@@ -351,7 +358,7 @@ word fh::HackManager::apply_ClearQuestFlag(const fe::Config& p_config, std::vect
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_IfQuestFlag(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_IfQuestFlag(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr, word quest_flag_decode_helper_addr, word bitmask_table_addr) const {
 	klib::Asm6502 code;
 
@@ -371,7 +378,7 @@ word fh::HackManager::apply_IfQuestFlag(const fe::Config& p_config, std::vector<
 // runs custom screen handler - data-driven tilemap changes (by default handler index 3)
 // we can certainly assume that RAM::CurrentScreen_SpecialEventID is 0xff when this is invoked
 // so we are not storing and restoring it
-word fh::HackManager::apply_RunScreenHandler(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_RunScreenHandler(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr) const {
 	klib::Asm6502 code;
 
@@ -385,7 +392,7 @@ word fh::HackManager::apply_RunScreenHandler(const fe::Config& p_config, std::ve
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_GetXP(const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+word fh::HackManager::apply_GetXP(const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = xp lo byte
@@ -399,7 +406,7 @@ word fh::HackManager::apply_GetXP(const fe::Config& p_config, std::vector<byte>&
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_IfWorld(std::vector<byte>& p_rom, word cpu_addr, word helper_if_a_equals_addr) const {
+word fh::HackManager::apply_IfWorld(klib::RomImage& p_rom, word cpu_addr, word helper_if_a_equals_addr) const {
 	klib::Asm6502 code;
 
 	code.lda_zp(RAM::ZP_CurrentWorld);
@@ -408,7 +415,7 @@ word fh::HackManager::apply_IfWorld(std::vector<byte>& p_rom, word cpu_addr, wor
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_IfScreen(std::vector<byte>& p_rom, word cpu_addr, word helper_if_a_equals_addr) const {
+word fh::HackManager::apply_IfScreen(klib::RomImage& p_rom, word cpu_addr, word helper_if_a_equals_addr) const {
 	klib::Asm6502 code;
 
 	code.lda_zp(RAM::ZP_CurrentScreen);
@@ -417,7 +424,7 @@ word fh::HackManager::apply_IfScreen(std::vector<byte>& p_rom, word cpu_addr, wo
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_IfStage(std::vector<byte>& p_rom, word cpu_addr, word helper_if_a_equals_addr) const {
+word fh::HackManager::apply_IfStage(klib::RomImage& p_rom, word cpu_addr, word helper_if_a_equals_addr) const {
 	klib::Asm6502 code;
 
 	code.lda_abs(RAM::CurrentStage);
@@ -426,7 +433,7 @@ word fh::HackManager::apply_IfStage(std::vector<byte>& p_rom, word cpu_addr, wor
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_Die(const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+word fh::HackManager::apply_Die(const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.lda_imm(0x01);
@@ -436,7 +443,7 @@ word fh::HackManager::apply_Die(const fe::Config& p_config, std::vector<byte>& p
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_JSR(const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+word fh::HackManager::apply_JSR(const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	const word ScriptReturn_Lo_ram_addr{ cfg_word(p_config, c::ID_HACK_SCRIPT_JSR_RAM_ADDR_LO) };
@@ -470,7 +477,7 @@ word fh::HackManager::apply_JSR(const fe::Config& p_config, std::vector<byte>& p
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_Return(const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+word fh::HackManager::apply_Return(const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	const word ScriptReturn_Lo_ram_addr{ cfg_word(p_config, c::ID_HACK_SCRIPT_JSR_RAM_ADDR_LO) };
@@ -493,7 +500,7 @@ word fh::HackManager::apply_Return(const fe::Config& p_config, std::vector<byte>
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_ForceDoor(const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+word fh::HackManager::apply_ForceDoor(const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	// the requirement check has already failed and invoked this script
@@ -506,7 +513,7 @@ word fh::HackManager::apply_ForceDoor(const fe::Config& p_config, std::vector<by
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_IfYX(std::vector<byte>& p_rom, word cpu_addr,
+word fh::HackManager::apply_IfYX(klib::RomImage& p_rom, word cpu_addr,
 	word helper_get_player_block_pos_addr, word helper_if_a_equals_addr) const {
 	klib::Asm6502 code;
 
@@ -517,7 +524,7 @@ word fh::HackManager::apply_IfYX(std::vector<byte>& p_rom, word cpu_addr,
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_IfDoorYX(std::vector<byte>& p_rom, word cpu_addr,
+word fh::HackManager::apply_IfDoorYX(klib::RomImage& p_rom, word cpu_addr,
 	word helper_if_a_equals_addr) const {
 	klib::Asm6502 code;
 
@@ -527,7 +534,7 @@ word fh::HackManager::apply_IfDoorYX(std::vector<byte>& p_rom, word cpu_addr,
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_IfAddrEquals(std::vector<byte>& p_rom, word cpu_addr,
+word fh::HackManager::apply_IfAddrEquals(klib::RomImage& p_rom, word cpu_addr,
 	word helper_load_word_addr, word helper_if_a_equals_addr) const {
 	klib::Asm6502 code;
 
@@ -539,7 +546,7 @@ word fh::HackManager::apply_IfAddrEquals(std::vector<byte>& p_rom, word cpu_addr
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_IfAddrBetween(std::vector<byte>& p_rom, word cpu_addr,
+word fh::HackManager::apply_IfAddrBetween(klib::RomImage& p_rom, word cpu_addr,
 	word helper_load_word_addr, word helper_if_a_between_addr) const {
 	klib::Asm6502 code;
 
@@ -551,7 +558,7 @@ word fh::HackManager::apply_IfAddrBetween(std::vector<byte>& p_rom, word cpu_add
 	return get_next_cpu_addr(cpu_addr, code.apply_hack_and_clear(p_rom, 12, cpu_addr));
 }
 
-word fh::HackManager::apply_SetAddr(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::apply_SetAddr(const fe::Config& p_config, klib::RomImage& p_rom,
 	word cpu_addr, word helper_load_word_addr) const {
 	klib::Asm6502 code;
 
@@ -630,7 +637,7 @@ namespace {
 // page on the inward phase; that is kept deliberately, it gives a second
 // effect for free, so treat it as documented behaviour rather than a defect.
 word fh::HackManager::apply_AtlasDevShakeScreen(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 	const auto operands{ atlasdev_arity(p_config, "AtlasDevShakeScreen", 3) };
 
@@ -727,7 +734,7 @@ word fh::HackManager::apply_AtlasDevShakeScreen(const fe::Config& p_config,
 // Stack after the pushes, with X from TSX:
 //   stage=$0101,X error=$0102,X total=$0103,X depth=$0104,X remaining=$0105,X
 word fh::HackManager::apply_AtlasDevFadeOut(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 	const auto operands{ atlasdev_arity(p_config, "AtlasDevFadeOut", 2) };
 
@@ -807,7 +814,7 @@ word fh::HackManager::apply_AtlasDevFadeOut(const fe::Config& p_config,
 }
 
 word fh::HackManager::apply_AtlasDevFadeIn(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 	const auto operands{ atlasdev_arity(p_config, "AtlasDevFadeIn", 2) };
 
@@ -914,7 +921,7 @@ word fh::HackManager::apply_AtlasDevFadeIn(const fe::Config& p_config,
 // Values above 16 are a deliberate no-op so a script driven by a variable
 // cannot reach an undefined song.
 word fh::HackManager::apply_AtlasDevSetMusic(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = requested state
@@ -935,7 +942,7 @@ word fh::HackManager::apply_AtlasDevSetMusic(const fe::Config& p_config,
 // note in docs/advanced_doc.md before enabling that one.
 
 word fh::HackManager::apply_AtlasDevShowSequentialMessages(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 	// Four message-id operands; 0 marks an unused slot.  Ids are
 	// 1-based indexes into the bank-13 string table -- raw ids bypass
@@ -986,7 +993,7 @@ word fh::HackManager::apply_AtlasDevShowSequentialMessages(const fe::Config& p_c
 // ignored because the effect routine indexes its table unchecked. Whether
 // the music keeps playing under it depends on the effect, not this opcode.
 word fh::HackManager::apply_AtlasDevPlaySFX(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = public SFX ID
@@ -1007,7 +1014,7 @@ word fh::HackManager::apply_AtlasDevPlaySFX(const fe::Config& p_config,
 // by name and the build fails rather than the ROM misbehaving.  It has had no
 // hardware validation beyond a purpose-built fixture that defined that RAM.
 word fh::HackManager::apply_AtlasDevShowNumberInMessage(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 	// Renders a script register, so this needs the script-variable feature
 	// exactly as AtlasDevShowChoiceToVar and AtlasDevShowMessageFromVar do.
@@ -1095,7 +1102,7 @@ word fh::HackManager::apply_AtlasDevShowNumberInMessage(const fe::Config& p_conf
 // by name and the build fails rather than the ROM misbehaving.  It has had no
 // hardware validation beyond a purpose-built fixture that defined that RAM.
 word fh::HackManager::apply_AtlasDevShowChoiceToVar(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 	// Runs the vanilla menu selection loop ($84ED: portrait tick,
 	// Menu_UpdateAndDraw, joypad) over Count rows, then stores the
@@ -1141,7 +1148,7 @@ word fh::HackManager::apply_AtlasDevShowChoiceToVar(const fe::Config& p_config,
 }
 
 word fh::HackManager::apply_AtlasDevClearPortrait(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 	// The vanilla portrait teardown ($F281): id := $FF, image cleared,
 	// area palette restored.  Dialogue/window state untouched, so a
@@ -1153,7 +1160,7 @@ word fh::HackManager::apply_AtlasDevClearPortrait(const fe::Config& p_config,
 }
 
 word fh::HackManager::apply_AtlasDevEntitySayMessage(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	// Consume only Slot.  The Message index is left as the very next script
@@ -1262,7 +1269,7 @@ word fh::HackManager::apply_AtlasDevEntitySayMessage(
 // by name and the build fails rather than the ROM misbehaving.  It has had no
 // hardware validation beyond a purpose-built fixture that defined that RAM.
 word fh::HackManager::apply_AtlasDevShowMessageFromVar(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 	const word Vars{ cfg_word(p_config, c::ID_HACK_SCRIPT_VAR_RAM_ADDR) };
 	const byte Count{ cfg_byte(p_config, c::ID_HACK_SCRIPT_VAR_COUNT) };
@@ -1293,7 +1300,7 @@ word fh::HackManager::apply_AtlasDevShowMessageFromVar(const fe::Config& p_confi
 }
 
 word fh::HackManager::apply_AtlasDevHideTextbox(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	// $81FB is the generic vanilla End-action close path:
@@ -1309,7 +1316,7 @@ word fh::HackManager::apply_AtlasDevHideTextbox(
 // Music_Current holds the requested ID before the NMI picks it up and the
 // same ID with bit 7 set afterwards, so both forms are compared.
 word fh::HackManager::apply_AtlasDevIfMusic(const fe::Config& p_config,
-	std::vector<byte>& p_rom, word cpu_addr) const {
+	klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = requested song
@@ -1333,7 +1340,7 @@ word fh::HackManager::apply_AtlasDevIfMusic(const fe::Config& p_config,
 }
 
 word fh::HackManager::apply_AtlasDevOpenTextbox(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	// The counterpart to AtlasDevHideTextbox.  $81E2 is the vanilla open the
@@ -1350,7 +1357,7 @@ word fh::HackManager::apply_AtlasDevOpenTextbox(
 }
 
 word fh::HackManager::apply_AtlasDevCloseDialogue(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	// The portrait counterpart to AtlasDevHideTextbox, which restores only
@@ -1386,7 +1393,7 @@ word fh::HackManager::apply_AtlasDevCloseDialogue(
 // cannot hold nine entities.  Both fall out of the countdown below rather than
 // needing a range check.
 word fh::HackManager::apply_AtlasDevIfEntityCountAtLeast(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	// Count down from the operand rather than up from zero, so the threshold
@@ -1436,7 +1443,7 @@ word fh::HackManager::apply_AtlasDevIfEntityCountAtLeast(
 // 1 then 0.  Nothing else clears it during play, so a script that freezes
 // MUST resume; ending the script while frozen leaves the game frozen.
 word fh::HackManager::apply_AtlasDevFreezeEntities(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.lda_imm(0x01);
@@ -1449,7 +1456,7 @@ word fh::HackManager::apply_AtlasDevFreezeEntities(
 
 // AtlasDevResumeEntities -- the other half of AtlasDevFreezeEntities.
 word fh::HackManager::apply_AtlasDevResumeEntities(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.lda_imm(0x00);
@@ -1469,7 +1476,7 @@ word fh::HackManager::apply_AtlasDevResumeEntities(
 // inlined.  A free slot holds $ff and an inactive one has bit 7 set, so
 // neither can match any of these identities.
 word fh::HackManager::apply_AtlasDevIfBossPresent(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.ldy_imm(0x07);
@@ -1501,7 +1508,7 @@ word fh::HackManager::apply_AtlasDevIfBossPresent(
 // $64, and the guard matters: an unclamped $ff would match every EMPTY slot
 // and report the room as full of whatever was asked for.
 word fh::HackManager::apply_AtlasDevIfEntityTypePresent(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = Type
@@ -1528,7 +1535,7 @@ word fh::HackManager::apply_AtlasDevIfEntityTypePresent(
 // Branches when the slot holds a live entity.  There is deliberately no
 // negated form: invert the branch target instead.
 word fh::HackManager::apply_AtlasDevIfEntitySlotActive(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = Slot
@@ -1552,7 +1559,7 @@ word fh::HackManager::apply_AtlasDevIfEntitySlotActive(
 // sword-hit test consults.  An invalid slot is not hidden, matching
 // AtlasDevIfEntitySlotActive's treatment of one.
 word fh::HackManager::apply_AtlasDevIfEntityHidden(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = Slot
@@ -1577,7 +1584,7 @@ word fh::HackManager::apply_AtlasDevIfEntityHidden(
 // shows, nonzero hides; the entity's behaviour keeps running either way, so
 // this hides an actor without removing it.
 word fh::HackManager::apply_AtlasDevSetEntityHidden(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = Slot
@@ -1614,7 +1621,7 @@ word fh::HackManager::apply_AtlasDevSetEntityHidden(
 // subtract-borrow rather than on zero, so Health 0 means "dies to the next
 // hit", not "dead".
 word fh::HackManager::apply_AtlasDevSetEntityHealth(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = Slot
@@ -1641,7 +1648,7 @@ word fh::HackManager::apply_AtlasDevSetEntityHealth(
 // so this reuses the existing i-frame window rather than adding a hook.
 // Frames 0 clears it immediately, matching the death path.
 word fh::HackManager::apply_AtlasDevSetEntityInvincible(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = Slot
@@ -1667,7 +1674,7 @@ word fh::HackManager::apply_AtlasDevSetEntityInvincible(
 // it means "run BScript ops" rather than "dispatch a behaviour".  Behaviour 6
 // is refused: the dispatcher special-cases it into an unrelated jump.
 word fh::HackManager::apply_AtlasDevSetEntityBehavior(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = Slot
@@ -1701,7 +1708,7 @@ word fh::HackManager::apply_AtlasDevSetEntityBehavior(
 // velocity elsewhere and are unaffected.  A behaviour restart re-reads the ROM
 // operand and overwrites this.
 word fh::HackManager::apply_AtlasDevSetEntitySpeed(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = Slot
@@ -1728,7 +1735,7 @@ word fh::HackManager::apply_AtlasDevSetEntitySpeed(
 // Bit 0 of the per-slot flag byte is the engine's own facing bit.  Direction 0
 // faces left, anything else faces right.  An inactive slot is left alone.
 word fh::HackManager::apply_AtlasDevSetEntityFacing(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = Slot
@@ -1776,7 +1783,7 @@ word fh::HackManager::apply_AtlasDevSetEntityFacing(
 // An out-of-range slot is rejected, and still consumes both remaining
 // operands so the interpreter cannot mistake one for the next opcode.
 word fh::HackManager::apply_AtlasDevEntityFieldToVar(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	const word Vars{ cfg_word(p_config, c::ID_HACK_SCRIPT_VAR_RAM_ADDR) };
@@ -1854,7 +1861,7 @@ word fh::HackManager::apply_AtlasDevEntityFieldToVar(
 // Digits clamps to 1..7, $FA03's own legal range.  X and Y are raw tile
 // coordinates; numbers are not boxes, so there is no evenness constraint.
 word fh::HackManager::apply_AtlasDevDrawVarNumber(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	const word Vars{ cfg_word(p_config, c::ID_HACK_SCRIPT_VAR_RAM_ADDR) };
@@ -1910,7 +1917,7 @@ word fh::HackManager::apply_AtlasDevDrawVarNumber(
 // question as a branch and needs no register at all; reach for this one only
 // when the number itself is wanted, to print or to do arithmetic on.
 word fh::HackManager::apply_AtlasDevCountActiveEntities(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	// Read the register file through the configuration rather than hardcoding
@@ -1965,7 +1972,7 @@ word fh::HackManager::apply_AtlasDevCountActiveEntities(
 // no slot does.  The result is a slot index, so it pairs with the opcodes
 // that take one.
 word fh::HackManager::apply_AtlasDevFindEntity(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	const word Vars{ cfg_word(p_config, c::ID_HACK_SCRIPT_VAR_RAM_ADDR) };
@@ -2014,7 +2021,7 @@ word fh::HackManager::apply_AtlasDevFindEntity(
 }
 
 word fh::HackManager::apply_AtlasDevSetPortrait(
-	const fe::Config& p_config, std::vector<byte>& p_rom, word cpu_addr) const {
+	const fe::Config& p_config, klib::RomImage& p_rom, word cpu_addr) const {
 	klib::Asm6502 code;
 
 	code.jsr(cfg_word(p_config, c::ID_ROM_ISCRIPTS_LOADBYTE)); // A = raw textbox context
@@ -2081,8 +2088,9 @@ word fh::HackManager::apply_AtlasDevSetPortrait(
 
 // main orchestrator - injects the script routines specified by users through the configuration xml
 // and extends the scripting language itself
-std::size_t fh::HackManager::apply_script_library(const fe::Config& p_config, std::vector<byte>& p_rom,
+std::size_t fh::HackManager::apply_script_library(const fe::Config& p_config, klib::RomImage& p_rom,
 	std::size_t p_file_offset, const std::vector<HackLib>& p_lib, std::size_t p_base_opcode_count) const {
+	klib::prof::Scope l_prof("HackManager::apply_script_library");
 
 	const std::set<HackLib> FLAG_REQUIRED{ HackLib::SetFlag, HackLib::ClearFlag, HackLib::IfFlag,
 	HackLib::SelectFlag, HackLib::SetSelectedFlag, HackLib::ClearSelectedFlag, HackLib::IfSelectedFlag };
@@ -2161,6 +2169,7 @@ std::size_t fh::HackManager::apply_script_library(const fe::Config& p_config, st
 	}
 
 	for (HackLib llib : p_lib) {
+		klib::prof::Scope l_lib_prof("HackManager::apply_routine", magic_enum::enum_name(llib));
 		script_impl_addresses.push_back(cpu_addr - 1);
 
 		switch (llib) {
@@ -2414,8 +2423,9 @@ bool fh::HackManager::requires_any(const std::vector<HackLib>& p_lib, const std:
 }
 
 // tilemap change subsystem
-std::size_t fh::HackManager::apply_tilemap_change_subsystem(const fe::Config& p_config, std::vector<byte>& p_rom,
+std::size_t fh::HackManager::apply_tilemap_change_subsystem(const fe::Config& p_config, klib::RomImage& p_rom,
 	const fh::TilemapChanges& tm_changes) const {
+	klib::prof::Scope l_prof("HackManager::apply_tilemap_change_subsystem");
 
 	static const std::vector<byte> BITMASK_TABLE_DATA{ 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
 	const word cpu_addr{ cfg_word(p_config, c::ID_TM_CHANGE_CPU_ADDR) };
@@ -2440,7 +2450,7 @@ std::size_t fh::HackManager::apply_tilemap_change_subsystem(const fe::Config& p_
 	return static_cast<std::size_t>(tm_subsystem_end - cpu_addr);
 }
 
-word fh::HackManager::install_hack_tm_event_handler(const fe::Config& p_config, std::vector<byte>& p_rom,
+word fh::HackManager::install_hack_tm_event_handler(const fe::Config& p_config, klib::RomImage& p_rom,
 	byte tm_lookup_bank, word tm_lookup_cpu_addr) const {
 	// the handler index for our custom handler
 	const byte custom_handler_index{ cfg_byte(p_config, c::ID_TM_CHANGE_HANDLER_IDX) };
@@ -2507,7 +2517,7 @@ word fh::HackManager::install_hack_tm_event_handler(const fe::Config& p_config,
 	return result;
 }
 
-word fh::HackManager::install_hack_tm_lookup(std::vector<byte>& p_rom, byte p_bank, word p_cpu_addr,
+word fh::HackManager::install_hack_tm_lookup(klib::RomImage& p_rom, byte p_bank, word p_cpu_addr,
 	word descriptor_handler_cpu_addr, word data_table_start_cpu_addr) const {
 	klib::Asm6502 code;
 
@@ -2524,7 +2534,7 @@ word fh::HackManager::install_hack_tm_lookup(std::vector<byte>& p_rom, byte p_ba
 		code.apply_hack_and_clear(p_rom, p_bank, p_cpu_addr));
 }
 
-word fh::HackManager::install_hack_tm_descriptor_handler(std::vector<byte>& p_rom, byte p_bank, word p_cpu_addr,
+word fh::HackManager::install_hack_tm_descriptor_handler(klib::RomImage& p_rom, byte p_bank, word p_cpu_addr,
 	word flag_helper_cpu_addr, word tm_changer_cpu_addr) const {
 	klib::Asm6502 code;
 
@@ -2573,7 +2583,7 @@ word fh::HackManager::install_hack_tm_descriptor_handler(std::vector<byte>& p_ro
 		code.apply_hack_and_clear(p_rom, p_bank, p_cpu_addr));
 }
 
-word fh::HackManager::install_hack_tm_tilemap_changer(const fe::Config& p_config, std::vector<byte>& p_rom, byte p_bank, word p_cpu_addr) const {
+word fh::HackManager::install_hack_tm_tilemap_changer(const fe::Config& p_config, klib::RomImage& p_rom, byte p_bank, word p_cpu_addr) const {
 	const byte waitframes{ cfg_byte(p_config, c::ID_TM_CHANGE_HANDLER_WAIT_FRAMES) };
 	const byte sound_effect{ cfg_byte(p_config, c::ID_TM_CHANGE_HANDLER_SOUND_EFFECT) };
 
@@ -2619,7 +2629,7 @@ word fh::HackManager::install_hack_tm_tilemap_changer(const fe::Config& p_config
 		code.apply_hack_and_clear(p_rom, p_bank, p_cpu_addr));
 }
 
-word fh::HackManager::install_hack_tm_flag_helper(std::vector<byte>& p_rom, byte p_bank, word p_cpu_addr,
+word fh::HackManager::install_hack_tm_flag_helper(klib::RomImage& p_rom, byte p_bank, word p_cpu_addr,
 	word p_table_addr) const {
 	klib::Asm6502 code;
 
@@ -2647,7 +2657,7 @@ word fh::HackManager::install_hack_tm_flag_helper(std::vector<byte>& p_rom, byte
 }
 
 // other hacks
-word fh::HackManager::install_hack_clear_flag_memory(const fe::Config& p_config, std::vector<byte>& p_rom) const {
+word fh::HackManager::install_hack_clear_flag_memory(const fe::Config& p_config, klib::RomImage& p_rom) const {
 	const word Hack_ClearPersistentFlags{ cfg_word(p_config, c::ID_HACK_CLEAR_PERSISTENT_FLAGS) };
 
 	klib::Asm6502 code;
@@ -2672,7 +2682,7 @@ word fh::HackManager::install_hack_clear_flag_memory(const fe::Config& p_config,
 }
 
 // this code ensures the flag RAM is stored and restored via SRAM for the translation hack 'en-transl' and derivatives
-void fh::HackManager::install_static_hack_flags_to_sram(const fe::Config& p_config, std::vector<byte>& p_rom) const {
+void fh::HackManager::install_static_hack_flags_to_sram(const fe::Config& p_config, klib::RomImage& p_rom) const {
 	const word HackStaticExtraSave{ 0x90c0 };
 	const word HackStaticExtraLoad{ 0x90dd };
 
@@ -2726,12 +2736,12 @@ void fh::HackManager::install_static_hack_flags_to_sram(const fe::Config& p_conf
 	code.apply_hack_and_clear(p_rom, 12, SRAM_Load_Hook);
 }
 
-word fh::HackManager::cfg_word(const fe::Config& p_config, const std::string& p_id) const {
-	return static_cast<word>(p_config.constant(p_id));
+word fh::HackManager::cfg_word(const fe::Config& p_config, const fe::ConfigKey& p_key) const {
+	return static_cast<word>(p_config.constant(p_key));
 }
 
-byte fh::HackManager::cfg_byte(const fe::Config& p_config, const std::string& p_id) const {
-	return static_cast<byte>(p_config.constant(p_id));
+byte fh::HackManager::cfg_byte(const fe::Config& p_config, const fe::ConfigKey& p_key) const {
+	return static_cast<byte>(p_config.constant(p_key));
 }
 
 word fh::HackManager::get_next_cpu_addr(word cpu_addr, std::size_t hack_size, std::size_t max_addr) const {
@@ -2741,7 +2751,7 @@ word fh::HackManager::get_next_cpu_addr(word cpu_addr, std::size_t hack_size, st
 	return static_cast<word>(next_addr);
 }
 
-std::vector<word> fh::HackManager::read_script_opcode_addrs(const std::vector<byte>& p_rom, std::size_t p_opcode_count) const {
+std::vector<word> fh::HackManager::read_script_opcode_addrs(klib::RomView p_rom, std::size_t p_opcode_count) const {
 	std::vector<word> result;
 
 	word ptrs_hi{ klib::Asm6502::read_word(p_rom, 12, ROM::IScripts_JumpTable_Ref_U) };
@@ -2756,7 +2766,7 @@ std::vector<word> fh::HackManager::read_script_opcode_addrs(const std::vector<by
 	return result;
 }
 
-std::size_t fh::HackManager::write_script_opcode_table(std::vector<byte>& p_rom, word table_cpu_addr,
+std::size_t fh::HackManager::write_script_opcode_table(klib::RomImage& p_rom, word table_cpu_addr,
 	const std::vector<word>& p_jump_table) const {
 
 	word ref_lo{ table_cpu_addr };
@@ -2769,7 +2779,7 @@ std::size_t fh::HackManager::write_script_opcode_table(std::vector<byte>& p_rom,
 }
 
 std::vector<word> fh::HackManager::read_screen_event_handler_addrs(const fe::Config& p_config,
-	const std::vector<byte>& p_rom) const {
+	klib::RomView p_rom) const {
 	const word dispatcher_addr{ ROM::GameLoop_RunScreenEventHandlers_LDA_EventTable };
 
 	// TODO: sanity check that the two LDA operands differ by exactly one
@@ -2784,6 +2794,6 @@ std::vector<word> fh::HackManager::read_screen_event_handler_addrs(const fe::Con
 }
 
 std::size_t fh::HackManager::detect_screen_event_handler_count(const fe::Config& p_config,
-	const std::vector<byte>& p_rom) const {
+	klib::RomView p_rom) const {
 	return p_rom.at(p_config.constant(c::ID_COMMAND_BYTE_COUNT_OFFSET)) / 2;
 }
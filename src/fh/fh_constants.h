@@ -2,6 +2,7 @@
 #define FH_CONSTANTS_H
 
 #include <cstddef>
+#include "./../fe/ConfigKey.h"
 
 using byte = unsigned char;
 using word = uint16_t;
@@ -107,37 +108,37 @@ namespace fh {
 	namespace c {
 		constexpr byte FlagsByteCount{ 0x1f };
 
-		constexpr char ID_ROM_ISCRIPTS_LOADBYTE[]{ "rom_iscripts_loadbyte" };
-		constexpr char ID_ROM_ISCRIPTS_SKIPADDRANDINVOKE[]{ "rom_iscripts_skipaddrandinvoke" };
-		constexpr char ID_ROM_ISCRIPTS_JUMPTONEXTADDR[]{ "rom_iscripts_jumptonextaddr" };
-		constexpr char ID_ROM_ISCRIPTS_INVOKENEXTACTION[]{ "rom_iscripts_invokenextaction" };
-		constexpr char ID_ROM_MMC1_UPDATEROMBANK[]{ "rom_mmc1_updaterombank" };
-		constexpr char ID_ROM_PLAYER_UPDATEEXPERIENCE[]{ "rom_player_updateexperience" };
-
-		constexpr char ID_HACK_CLEAR_PERSISTENT_FLAGS[]{ "hack_clear_persistent_flags" };
-		constexpr char ID_TM_CHANGE_BANK[]{ "hack_tm_change_bank" };
-		constexpr char ID_TM_CHANGE_CPU_ADDR[]{ "hack_tm_change_cpu_addr" };
-		constexpr char ID_TM_CHANGE_HANDLER_CPU_ADDR[]{ "hack_tm_handler_cpu_addr" };
-		constexpr char ID_TM_CHANGE_HANDLER_TABLE_CPU_ADDR[]{ "hack_tm_handler_table_cpu_addr" };
-		constexpr char ID_TM_CHANGE_HANDLER_WAIT_FRAMES[]{ "hack_tm_change_wait_frames" };
-		constexpr char ID_TM_CHANGE_HANDLER_SOUND_EFFECT[]{ "hack_tm_change_sound_effect" };
-		constexpr char ID_TM_CHANGE_HANDLER_IDX[]{ "hack_tm_change_handler_index" };
-
-		constexpr char ID_HACK_SCRIPT_JSR_RAM_ADDR_LO[]{ "hack_script_jsr_ram_addr_lo" };
-		constexpr char ID_HACK_SCRIPT_JSR_RAM_ADDR_HI[]{ "hack_script_jsr_ram_addr_hi" };
-		constexpr char ID_HACK_SCRIPT_SELECTED_FLAG_RAM_ADDR[]{ "hack_script_selected_flag_ram_addr" };
+		inline const fe::ConfigKey ID_ROM_ISCRIPTS_LOADBYTE{ "rom_iscripts_loadbyte" };
+		inline const fe::ConfigKey ID_ROM_ISCRIPTS_SKIPADDRANDINVOKE{ "rom_iscripts_skipaddrandinvoke" };
+		inline const fe::ConfigKey ID_ROM_ISCRIPTS_JUMPTONEXTADDR{ "rom_iscripts_jumptonextaddr" };
+		inline const fe::ConfigKey ID_ROM_ISCRIPTS_INVOKENEXTACTION{ "rom_iscripts_invokenextaction" };
+		inline const fe::ConfigKey ID_ROM_MMC1_UPDATEROMBANK{ "rom_mmc1_updaterombank" };
+		inline const fe::ConfigKey ID_ROM_PLAYER_UPDATEEXPERIENCE{ "rom_player_updateexperience" };
+
+		inline const fe::ConfigKey ID_HACK_CLEAR_PERSISTENT_FLAGS{ "hack_clear_persistent_flags" };
+		inline const fe::ConfigKey ID_TM_CHANGE_BANK{ "hack_tm_change_bank" };
+		inline const fe::ConfigKey ID_TM_CHANGE_CPU_ADDR{ "hack_tm_change_cpu_addr" };
+		inline const fe::ConfigKey ID_TM_CHANGE_HANDLER_CPU_ADDR{ "hack_tm_handler_cpu_addr" };
+		inline const fe::ConfigKey ID_TM_CHANGE_HANDLER_TABLE_CPU_ADDR{ "hack_tm_handler_table_cpu_addr" };
+		inline const fe::ConfigKey ID_TM_CHANGE_HANDLER_WAIT_FRAMES{ "hack_tm_change_wait_frames" };
+		inline const fe::ConfigKey ID_TM_CHANGE_HANDLER_SOUND_EFFECT{ "hack_tm_change_sound_effect" };
+		inline const fe::ConfigKey ID_TM_CHANGE_HANDLER_IDX{ "hack_tm_change_handler_index" };
+
+		inline const fe::ConfigKey ID_HACK_SCRIPT_JSR_RAM_ADDR_LO{ "hack_script_jsr_ram_addr_lo" };
+		inline const fe::ConfigKey ID_HACK_SCRIPT_JSR_RAM_ADDR_HI{ "hack_script_jsr_ram_addr_hi" };
+		inline const fe::ConfigKey ID_HACK_SCRIPT_SELECTED_FLAG_RAM_ADDR{ "hack_script_selected_flag_ram_addr" };
 
 		// Used only by AtlasDevShowMessageFromVar. No default is shipped: a
 		// project must define both before that opcode can be installed, and
 		// Config::constant throws by name if either is missing, so the build
 		// fails loudly rather than reading unallocated RAM.
-		constexpr char ID_HACK_SCRIPT_VAR_RAM_ADDR[]{ "hack_script_var_ram_addr" };
-		constexpr char ID_HACK_SCRIPT_VAR_COUNT[]{ "hack_script_var_count" };
+		inline const fe::ConfigKey ID_HACK_SCRIPT_VAR_RAM_ADDR{ "hack_script_var_ram_addr" };
+		inline const fe::ConfigKey ID_HACK_SCRIPT_VAR_COUNT{ "hack_script_var_count" };
 
-		constexpr char ID_FLAGS_WRAM_TO_SRAM[]{ "flags_wram_to_sram" };
+		inline const fe::ConfigKey ID_FLAGS_WRAM_TO_SRAM{ "flags_wram_to_sram" };
 
-		constexpr char ID_ISCRIPT_RG2_START[]{ "iscript_data_rg2_start" };
-		constexpr char ID_COMMAND_BYTE_COUNT_OFFSET[]{ "command_byte_count_offset" };
+		inline const fe::ConfigKey ID_ISCRIPT_RG2_START{ "iscript_data_rg2_start" };
+		inline const fe::ConfigKey ID_COMMAND_BYTE_COUNT_OFFSET{ "command_byte_count_offset" };
 	}
 }
 
@@ -2,6 +2,7 @@
 #include "fi_constants.h"
 #include "Opcode.h"
 #include "./../common/klib/Kfile.h"
+#include "./../common/klib/Kprofile.h"
 #include "./../common/klib/Kstring.h"
 #include <algorithm>
 #include <format>
@@ -11,13 +12,19 @@
 #include <string>
 #include <utility>
 
+fi::AsmReader::AsmReader(const fi::OpcodeTable& p_opcodes) :
+	m_opcodes{ p_opcodes },
+	m_line_no{ 0 }
+{
+}
+
 void fi::AsmReader::read_asm_file(const fe::Config& p_config,
 	const std::string& p_filename, std::size_t script_rg2_offset) {
 	auto l_lines{ klib::file::read_file_as_strings(p_filename) };
 	fi::SectionType currentSection{ fi::SectionType::Defines };
 
-	for (auto& line : l_lines) {
-		line = trim(strip_comment(line));
+	for (std::size_t i{ 0 }; i < l_lines.size(); ++i) {
+		const auto line{ trim(strip_comment(l_lines[i])) };
 
 		if (line == c::SECTION_DEFINES) {
 			currentSection = fi::SectionType::Defines;
@@ -35,17 +42,29 @@ void fi::AsmReader::read_asm_file(const fe::Config& p_config,
 			currentSection = fi::SectionType::TilemapChanges;
 		}
 		else if (!line.empty())
-			m_sections[currentSection].push_back(line);
+			m_sections[currentSection].push_back(std::make_pair(i + 1, line));
 	}
 
-	parse_section_strings();
-	parse_section_defines();
-	parse_section_shops();
-	parse_section_tilemap_changes();
-	parse_section_iscript(p_config, script_rg2_offset);
+	try {
+		parse_section_strings();
+		parse_section_defines();
+		parse_section_shops();
+		parse_section_tilemap_changes();
+		parse_section_iscript(p_config, script_rg2_offset);
+	}
+	catch (const klib::str::ParseError&) {
+		throw;
+	}
+	catch (const std::runtime_error& ex) {
+		if (m_line_no == 0)
+			throw;
+		throw klib::str::ParseError(ex.what(), m_line_no);
+	}
 }
 
 void fi::AsmReader::parse_section_strings(void) {
+	klib::prof::Scope l_prof("AsmReader::parse_section_strings");
+
 	if (!m_sections.contains(SectionType::Strings))
 		return;
 
@@ -53,7 +72,8 @@ void fi::AsmReader::parse_section_strings(void) {
 	std::map<int, std::string> temp;
 	int max_index{ 0 };
 
-	for (const auto& line : lines) {
+	for (const auto& [line_no, line] : lines) {
+		m_line_no = line_no;
 
 		size_t colon_pos = line.find(':');
 		if (colon_pos == std::string::npos) {
@@ -83,18 +103,22 @@ void fi::AsmReader::parse_section_strings(void) {
 
 		max_index = std::max(max_index, index);
 	}
+	m_line_no = 0;
 
 	for (const auto& kv : temp)
 		m_strings[kv.first] = fi::FaxString(kv.second);
 }
 
 void fi::AsmReader::parse_section_defines() {
+	klib::prof::Scope l_prof("AsmReader::parse_section_defines");
+
 	if (!m_sections.contains(SectionType::Defines))
 		return;
 
 	const auto& lines = m_sections.at(SectionType::Defines);
 
-	for (const auto& line : lines) {
+	for (const auto& [line_no, line] : lines) {
+		m_line_no = line_no;
 		// Must start with "define "
 		if (!line.starts_with("define ")) {
 			throw std::runtime_error("Malformed define line: " + line);
@@ -124,13 +148,16 @@ void fi::AsmReader::parse_section_defines() {
 }
 
 void fi::AsmReader::parse_section_shops() {
+	klib::prof::Scope l_prof("AsmReader::parse_section_shops");
+
 	if (!m_sections.contains(SectionType::Shops))
 		return;
 
 	const auto& lines = m_sections.at(SectionType::Shops);
 	std::map<std::size_t, Shop> result;
 
-	for (const auto& line : lines) {
+	for (const auto& [line_no, line] : lines) {
+		m_line_no = line_no;
 		size_t colon_pos = line.find(':');
 		if (colon_pos == std::string::npos) {
 			throw std::runtime_error("Malformed shop line: " + line);
@@ -182,6 +209,8 @@ void fi::AsmReader::parse_section_shops() {
 }
 
 void fi::AsmReader::parse_section_tilemap_changes() {
+	klib::prof::Scope l_prof("AsmReader::parse_section_tilemap_changes");
+
 	if (!m_sections.contains(SectionType::TilemapChanges))
 		return;
 
@@ -201,7 +230,8 @@ void fi::AsmReader::parse_section_tilemap_changes() {
 	const auto& lines = m_sections.at(SectionType::TilemapChanges);
 	std::optional<byte> current_world, current_screen;
 
-	for (const auto& line : lines) {
+	for (const auto& [line_no, line] : lines) {
+		m_line_no = line_no;
 		auto tokens = klib::str::split_whitespace(line);
 
 		if (tokens.empty())
@@ -450,7 +480,7 @@ std::string fi::AsmReader::to_lower(const std::string& str) {
 std::vector<byte> fi::AsmReader::get_string_bytes(const fe::Config& p_config) const {
 	std::vector<byte> result;
 
-	const std::map<std::string, byte> l_smap{ p_config.bmap_reverse(c::ID_STRING_CHAR_MAP) };
+	const auto& l_smap{ p_config.bmap_reverse(c::ID_STRING_CHAR_MAP) };
 
 	for (const auto& kv : m_strings) {
 		try {
@@ -470,6 +500,10 @@ std::size_t fi::AsmReader::get_string_count(void) const {
 	return m_strings.size();
 }
 
+std::size_t fi::AsmReader::get_instruction_count(void) const {
+	return m_instructions.size();
+}
+
 std::map<std::string, int> fi::AsmReader::relocate_strings(
 	const std::set<std::string>& p_strings) {
 	std::map<int, std::string> new_string_table;
@@ -8,6 +8,7 @@
 #include "FaxString.h"
 #include "Shop.h"
 #include "Opcode.h"
+#include "./../common/klib/Krom.h"
 #include "./../fe/Config.h"
 #include "./../fh/TilemapChanges.h"
 
@@ -17,16 +18,21 @@ namespace fi {
 
 	class AsmReader {
 
+		const fi::OpcodeTable& m_opcodes;
+
 		// set of reserved string indexes first,
 		// then becomes full set of strings during parsing
 		std::map<int, fi::FaxString> m_strings;
 		std::map<std::string, std::size_t> m_defines;
 		std::map<std::size_t, fi::Shop> m_shops;
-		std::vector<fi::Instruction> m_instructions;
+		fi::InstructionList m_instructions;
 		// map from entrypoint no to offset
 		std::map<std::size_t, std::size_t> m_ptr_table;
 
-		std::map<SectionType, std::vector<std::string>> m_sections;
+		// (line number, line) for each non-empty line in a section
+		std::map<SectionType, std::vector<std::pair<std::size_t, std::string>>> m_sections;
+		// the source line being parsed, or 0 between lines
+		std::size_t m_line_no;
 
 		fh::TilemapChanges m_tilemap_changes;
 
@@ -60,7 +66,7 @@ namespace fi {
 		std::string to_lower(const std::string& str);
 
 	public:
-		AsmReader(void) = default;
+		AsmReader(const fi::OpcodeTable& p_opcodes);
 		void read_asm_file(const fe::Config& p_config,
 			const std::string& p_filename, std::size_t script_rg2_offset);
 		std::size_t get_entrypoint_count(void) const;
@@ -69,6 +75,13 @@ namespace fi {
 		std::pair<std::vector<byte>, std::vector<byte>> get_script_bytes(const fe::Config& p_config) const;
 		std::vector<byte> get_string_bytes(const fe::Config& p_config) const;
 		std::size_t get_string_count(void) const;
+		std::size_t get_instruction_count(void) const;
+
+		// checks the patched ROM against the linked instructions: every entrypoint
+		// decodes, every code path ends inside a script data region and every jump
+		// lands on an instruction; throws std::runtime_error on the first problem
+		void verify_rom(const fe::Config& p_config, klib::RomView p_rom,
+			std::size_t script_rg2_offset) const;
 
 		// get optional tilemap changes
 		const fh::TilemapChanges& get_tilemap_changes() const;
@@ -1,5 +1,6 @@
 #include "AsmReader.h"
 #include "fi_constants.h"
+#include "./../common/klib/Kprofile.h"
 #include <format>
 #include <map>
 #include <set>
@@ -52,6 +53,8 @@ Data we need:
 
  */
 void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_t script_rg2_offset) {
+	klib::prof::Scope l_prof("AsmReader::parse_section_iscript");
+
 	if (!m_sections.contains(SectionType::IScript))
 		throw std::runtime_error(
 			std::format("Missing required section {}", c::SECTION_ISCRIPT
@@ -68,14 +71,6 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 	// we will do this with 0-relative offsets in the first pass
 	// and recalculate later
 
-	// make an opcode mnemonic reverse lookup
-	std::map<std::string, byte> mnemonics;
-	for (const auto& opc : fi::opcodes) {
-		mnemonics.insert(std::make_pair(
-			to_lower(opc.second.name), opc.first
-		));
-	}
-
 	// map from shop index to byte offsets
 	// we can patch these as we go since we put them first
 	// no need to touch any offsets here before the very final pass
@@ -109,7 +104,8 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 	std::map<std::string, std::set<StringOperandRef>> string_operand_refs;
 
 	// and so it begins...
-	for (std::string line : m_sections.at(fi::SectionType::IScript)) {
+	for (const auto& [line_no, line] : m_sections.at(fi::SectionType::IScript)) {
+		m_line_no = line_no;
 
 		// if label - extract and store
 		if (contains_label(line)) {
@@ -138,8 +134,7 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 				.opcode_byte = textbox_no,
 				.size = 1,
 				.jump_target = std::nullopt,
-				.byte_offset = offset++,
-				.operands = {}
+				.byte_offset = offset++
 				});
 		}
 		// else it must be an opcode
@@ -148,15 +143,21 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 			auto tokens{ split_whitespace(line) };
 
 			const std::string& mnemo{ to_lower(tokens[0]) };
-			if (!mnemonics.contains(mnemo)) {
+			const auto mnemo_opcode{ m_opcodes.find_mnemonic(mnemo) };
+			if (!mnemo_opcode.has_value()) {
 				throw std::runtime_error("Unknown opcode: " + mnemo);
 			}
 
-			byte opcode_byte = mnemonics[mnemo];
-			std::vector<uint16_t> operands;
-			std::optional<uint16_t> target_address;
+			byte opcode_byte = mnemo_opcode.value();
+
+			const fi::Opcode& op = m_opcodes.at(opcode_byte);
 
-			const fi::Opcode& op = fi::opcodes.at(opcode_byte);
+			fi::Instruction instr{
+				.type = fi::Instruction_type::OpCode,
+				.opcode_byte = opcode_byte,
+				.size = op.size(),
+				.byte_offset = offset
+			};
 
 			// let's validate the params first
 			const auto expected_tokens{ op.token_count() };
@@ -191,13 +192,13 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 							operand_str = m_strings.at(str_idx).get_string();
 						else {
 							// fall back to 0
-							operands.push_back(0);
+							instr.push_operand(0);
 							push_str = false;
 						}
 					}
 
 					if (push_str) {
-						const std::size_t operand_index{ operands.size() };
+						const std::size_t operand_index{ instr.operand_count };
 
 						unique_strings.insert(operand_str);
 						string_operand_refs[operand_str].insert({
@@ -206,11 +207,11 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 							});
 
 						// placeholder; patched later by relocate_strings()
-						operands.push_back(0);
+						instr.push_operand(0);
 					}
 				}
 				else {
-					operands.push_back(static_cast<uint16_t>(resolve_token(tokens.at(current_token))));
+					instr.push_operand(static_cast<uint16_t>(resolve_token(tokens.at(current_token))));
 				}
 
 				++current_token;
@@ -224,7 +225,7 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 				if (iter == end(l_shop_ptrs))
 					throw std::runtime_error(std::format("Invalid shop index {}", shop_idx));
 
-				target_address = static_cast<uint16_t>(iter->second);
+				instr.jump_target = iter->second;
 			}
 			else if (op.flow == fi::Flow::Jump) {
 				// labels: defer until we have all instruction offsets
@@ -234,17 +235,11 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 
 			// finally emit the instruction
 			// byte_offset_to_instruction_idx[offset] = m_instructions.size();
-			m_instructions.push_back(fi::Instruction{
-				.type = fi::Instruction_type::OpCode,
-				.opcode_byte = opcode_byte,
-				.size = op.size(),
-				.jump_target = target_address,
-				.byte_offset = offset,
-				.operands = std::move(operands)
-				});
+			m_instructions.push_back(instr);
 			offset += op.size();
 		}
 	}
+	m_line_no = 0;
 
 	// first pass done - we now have tentative byte offsets for all instructions
 	// we have labels and entrypoint idx to instruction index
@@ -271,8 +266,8 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 		const auto string_index{ str_remap.at(text) };
 
 		for (const auto& [instruction_index, operand_index] : refs) {
-			m_instructions.at(instruction_index).operands.at(operand_index) =
-				static_cast<uint16_t>(string_index);
+			m_instructions.set_operand(instruction_index, operand_index,
+				static_cast<uint16_t>(string_index));
 		}
 	}
 
@@ -287,7 +282,7 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 	std::size_t l_iscript_rg1_size{ l_iscript_rg1_end - l_iscript_data_start };
 
 	for (std::size_t i{ 0 }; i < m_instructions.size(); ++i)
-		if (m_instructions[i].byte_offset.value() + m_instructions[i].size >
+		if (m_instructions.byte_offset(i) + m_instructions.byte_size(i) >
 			l_iscript_rg1_size) {
 			first_unsafe_inst_idx = i;
 			break;
@@ -298,10 +293,10 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 	if (first_unsafe_inst_idx.has_value()) {
 		for (std::size_t i{ first_unsafe_inst_idx.value() - 1 };
 			i > 0; --i)
-			if (m_instructions[i].byte_offset.value() + m_instructions[i].size
+			if (m_instructions.byte_offset(i) + m_instructions.byte_size(i)
 				<= l_iscript_rg1_size
-				&& m_instructions[i].type != fi::Instruction_type::Directive
-				&& fi::opcodes.at(m_instructions[i].opcode_byte).ends_stream) {
+				&& !m_instructions.is_directive(i)
+				&& m_opcodes.layout(m_instructions.opcode_byte(i)).ends_stream) {
 				idx_after_last_safe_stream_end = i + 1;
 				break;
 			}
@@ -317,11 +312,11 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 		// (at end of iscript ptr table)
 		std::size_t relocation_delta{
 			(l_iscript_rg2_offset - l_iscript_data_start)
-		- m_instructions.at(idx_after_last_safe_stream_end.value()).byte_offset.value() };
+		- m_instructions.byte_offset(idx_after_last_safe_stream_end.value()) };
 
 		for (std::size_t i{ idx_after_last_safe_stream_end.value() };
 			i < m_instructions.size(); ++i)
-			m_instructions[i].byte_offset.value() += relocation_delta;
+			m_instructions.set_byte_offset(i, m_instructions.byte_offset(i) + relocation_delta);
 
 	}
 
@@ -333,8 +328,8 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 			throw std::runtime_error("Unresolved label: " + kv.first);
 		else {
 			for (std::size_t instr_no : kv.second)
-				m_instructions[instr_no].jump_target =
-				m_instructions.at(iter->second).byte_offset.value();
+				m_instructions.set_jump_target(instr_no,
+					m_instructions.byte_offset(iter->second));
 		}
 	}
 
@@ -343,16 +338,17 @@ void fi::AsmReader::parse_section_iscript(const fe::Config& p_config, std::size_
 	const uint16_t PTR_DELTA{ static_cast<uint16_t>(l_iscript_ptr.first + 2 * l_iscript_count
 	- l_iscript_ptr.second) };
 	for (std::size_t ins{ 0 }; ins < m_instructions.size(); ++ins) {
-		if (m_instructions[ins].jump_target.has_value()) {
-			m_instructions[ins].jump_target = m_instructions[ins].jump_target.value() + PTR_DELTA;
+		const auto jump_target{ m_instructions.jump_target(ins) };
+		if (jump_target.has_value()) {
+			m_instructions.set_jump_target(ins, jump_target.value() + PTR_DELTA);
 		}
 
-		m_instructions[ins].byte_offset.value() += PTR_DELTA;
+		m_instructions.set_byte_offset(ins, m_instructions.byte_offset(ins) + PTR_DELTA);
 	}
 
 	// finally calculate the ptr table
 	for (const auto& kv : ptr_to_instr_index)
-		m_ptr_table[kv.first] = m_instructions[kv.second].byte_offset.value();
+		m_ptr_table[kv.first] = m_instructions.byte_offset(kv.second);
 }
 
 std::size_t fi::AsmReader::get_entrypoint_count(void) const {
@@ -390,13 +386,24 @@ fi::AsmReader::get_script_bytes(const fe::Config& p_config) const {
 		region_1.insert(end(region_1), begin(shopbytes), end(shopbytes));
 	}
 
-	for (const auto& instr : m_instructions) {
-		auto instrbytes{ instr.get_bytes() };
+	// size both regions up front, then encode every instruction in place
+	const auto in_region_1{ [&](std::size_t p_index) {
+		return m_instructions.byte_offset(p_index) < SCRIPT_DATA_START + l_iscript_rg1_size;
+	} };
+
+	std::size_t l_rg1_pos{ region_1.size() }, l_rg2_pos{ 0 };
+	std::size_t l_rg1_bytes{ 0 }, l_rg2_bytes{ 0 };
+	for (std::size_t i{ 0 }; i < m_instructions.size(); ++i)
+		(in_region_1(i) ? l_rg1_bytes : l_rg2_bytes) += m_instructions.byte_size(i);
+
+	region_1.resize(l_rg1_pos + l_rg1_bytes);
+	region_2.resize(l_rg2_bytes);
 
-		if (instr.byte_offset < SCRIPT_DATA_START + l_iscript_rg1_size)
-			region_1.insert(end(region_1), begin(instrbytes), end(instrbytes));
+	for (std::size_t i{ 0 }; i < m_instructions.size(); ++i) {
+		if (in_region_1(i))
+			l_rg1_pos += m_instructions.encode(i, m_opcodes, std::span<byte>(region_1).subspan(l_rg1_pos));
 		else
-			region_2.insert(end(region_2), begin(instrbytes), end(instrbytes));
+			l_rg2_pos += m_instructions.encode(i, m_opcodes, std::span<byte>(region_2).subspan(l_rg2_pos));
 	}
 
 	return std::make_pair(region_1, region_2);
@@ -0,0 +1,126 @@
+#include "AsmReader.h"
+#include "fi_constants.h"
+#include "./../common/klib/Kprofile.h"
+#include "./../common/klib/Kverify.h"
+#include <array>
+#include <format>
+#include <set>
+#include <stdexcept>
+
+/*
+ post-build verification
+
+ Instead of disassembling the patched ROM again, we decode it along every
+ code path and check it against the offsets the linker laid down:
+
+ 1) The pointer table and its hi byte reference read back as linked
+ 2) Each entrypoint starts with its textbox directive
+ 3) Every instruction lies fully inside one of the script code regions,
+    which start after the shop data, and its ROM bytes are the ones we
+    linked, operands included
+ 4) Every jump lands on the start of an instruction, and every shop read
+    points into the shop data and is terminated inside it
+ 5) Every path ends; an instruction that does not end the stream must be
+    directly followed by the next instruction
+
+ Each instruction is visited at most once, so this is linear in the
+ number of instructions.
+*/
+void fi::AsmReader::verify_rom(const fe::Config& p_config, klib::RomView p_rom,
+	std::size_t script_rg2_offset) const {
+	klib::prof::Scope l_prof("AsmReader::verify_rom");
+
+	auto l_iscript_ptr{ p_config.pointer(c::ID_ISCRIPT_PTR_LO) };
+	const std::size_t l_iscript_count{ m_ptr_table.size() };
+	const std::size_t l_zero_addr{ l_iscript_ptr.second };
+
+	// the shops are laid down between the pointer table and the code
+	const std::size_t l_shop_start{ l_iscript_ptr.first + 2 * l_iscript_count };
+	std::size_t l_shop_end{ l_shop_start };
+	for (const auto& kv : m_shops)
+		l_shop_end += kv.second.byte_size();
+
+	klib::verify::CodeWalker l_walker(p_rom, {
+		{ l_shop_end, p_config.constant(c::ID_ISCRIPT_RG1_END) },
+		{ script_rg2_offset, p_config.constant(c::ID_ISCRIPT_RG2_END) }
+		});
+
+	for (std::size_t i{ 0 }; i < m_instructions.size(); ++i)
+		l_walker.add_instruction(m_instructions.byte_offset(i) + l_zero_addr, m_instructions.byte_size(i));
+
+	std::size_t l_hi_ref{ p_config.constant(c::ID_ISCRIPT_PTR_HI_REF_OFFSET) };
+	if (l_walker.read_short(l_hi_ref) + l_zero_addr != l_iscript_ptr.first + l_iscript_count)
+		throw std::runtime_error(std::format("The iScript pointer table reference at ROM offset 0x{:06x} does not point to the hi bytes", l_hi_ref));
+
+	// shop ROM offsets already checked
+	std::set<std::size_t> l_shops;
+	// the linked bytes of the instruction being checked
+	std::array<byte, MAX_INSTRUCTION_SIZE> l_bytes;
+
+	const auto step{ [&](std::size_t p_index) {
+		const fi::Instruction instr{ m_instructions[p_index] };
+		const std::size_t l_offset{ instr.byte_offset + l_zero_addr };
+
+		if (instr.type == fi::Instruction_type::OpCode && !m_opcodes.layout(instr.opcode_byte).defined)
+			throw std::runtime_error(std::format("Undefined opcode 0x{:02x} at ROM offset 0x{:06x}", instr.opcode_byte, l_offset));
+
+		const std::size_t l_size{ m_instructions.encode(p_index, m_opcodes, l_bytes) };
+		for (std::size_t i{ 0 }; i < l_size; ++i)
+			if (l_walker.read_byte(l_offset + i) != l_bytes[i])
+				throw std::runtime_error(std::format("ROM byte 0x{:02x} at offset 0x{:06x} does not match the linked byte 0x{:02x}",
+					l_walker.read_byte(l_offset + i), l_offset + i, l_bytes[i]));
+
+		if (instr.type == fi::Instruction_type::OpCode) {
+			const auto& op{ m_opcodes.layout(instr.opcode_byte) };
+
+			// the jump or read address is always the final operand
+			if (op.flow == fi::Flow::Jump || op.flow == fi::Flow::Read) {
+				std::size_t l_target{ l_walker.read_short(l_offset + instr.size - 2) + l_zero_addr };
+
+				if (op.flow == fi::Flow::Jump) {
+					if (m_instructions.is_directive(l_walker.jump(l_offset, l_target)))
+						throw std::runtime_error(std::format("Code path runs into the textbox directive at ROM offset 0x{:06x}", l_target));
+				}
+				else if (l_shops.insert(l_target).second) {
+					std::size_t l_shop_offset{ l_target };
+					while (l_shop_offset >= l_shop_start && l_shop_offset < l_shop_end &&
+						l_walker.read_byte(l_shop_offset) != 0xff)
+						l_shop_offset += 3;
+
+					if (l_shop_offset < l_shop_start || l_shop_offset >= l_shop_end)
+						throw std::runtime_error(std::format("Shop at ROM offset 0x{:06x} read at 0x{:06x} is not terminated inside the shop data",
+							l_target, l_offset));
+				}
+			}
+
+			if (op.ends_stream)
+				return false;
+		}
+
+		if (p_index + 1 < m_instructions.size() && m_instructions.is_directive(p_index + 1))
+			throw std::runtime_error(std::format("Code path runs into the textbox directive at ROM offset 0x{:06x}",
+				m_instructions.byte_offset(p_index + 1) + l_zero_addr));
+
+		return true;
+	} };
+
+	for (const auto& [entry_no, ptr] : m_ptr_table) {
+		std::size_t l_ptr{ static_cast<std::size_t>(l_walker.read_byte(l_iscript_ptr.first + entry_no)) +
+			256 * static_cast<std::size_t>(l_walker.read_byte(l_iscript_ptr.first + l_iscript_count + entry_no)) };
+
+		if (l_ptr != ptr)
+			throw std::runtime_error(std::format("Pointer table entry {} reads 0x{:04x}, but was linked as 0x{:04x}",
+				entry_no, l_ptr, ptr));
+
+		const auto l_index{ l_walker.find(ptr + l_zero_addr) };
+		if (!l_index.has_value())
+			throw std::runtime_error(std::format("Pointer table entry {} points to ROM offset 0x{:06x}, which is not the start of an instruction",
+				entry_no, ptr + l_zero_addr));
+		else if (!m_instructions.is_directive(l_index.value()))
+			throw std::runtime_error(std::format("Entrypoint at ROM offset 0x{:06x} has no textbox context", ptr + l_zero_addr));
+
+		l_walker.walk(l_index.value(), step);
+	}
+
+	l_prof.count("instructions", m_instructions.size());
+}
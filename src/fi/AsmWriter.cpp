@@ -8,9 +8,25 @@
 #include <map>
 #include <string_view>
 
-void fi::AsmWriter::generate_asm_file(const fe::Config& p_config,
+fi::AsmWriter::AsmWriter(const fi::OpcodeTable& p_opcodes) :
+	m_opcodes{ p_opcodes }
+{
+}
+
+bool fi::AsmWriter::generate_asm_file(const fe::Config& p_config,
 	const std::string& p_filename,
-	const std::map<std::size_t, fi::Instruction>& p_instructions,
+	const fi::InstructionList& p_instructions,
+	const std::vector<std::size_t>& p_entrypoints,
+	const std::set<std::size_t>& p_jump_targets,
+	const std::vector<fi::FaxString>& p_strings,
+	const std::vector<fi::Shop>& p_shops,
+	bool p_shop_comments) const {
+	return klib::file::write_string_to_file(get_asm_string(p_config, p_instructions,
+		p_entrypoints, p_jump_targets, p_strings, p_shops, p_shop_comments), p_filename);
+}
+
+std::string fi::AsmWriter::get_asm_string(const fe::Config& p_config,
+	const fi::InstructionList& p_instructions,
 	const std::vector<std::size_t>& p_entrypoints,
 	const std::set<std::size_t>& p_jump_targets,
 	const std::vector<fi::FaxString>& p_strings,
@@ -65,9 +81,9 @@ void fi::AsmWriter::generate_asm_file(const fe::Config& p_config,
 	std::map<std::size_t, std::string> l_labels;
 
 	// loop over all instructions and append to output
-	for (const auto& kv : p_instructions) {
-		const fi::Instruction& instr{ kv.second };
-		std::size_t offset{ kv.first };
+	for (std::size_t instr_no{ 0 }; instr_no < p_instructions.size(); ++instr_no) {
+		const fi::Instruction instr{ p_instructions[instr_no] };
+		std::size_t offset{ instr.byte_offset };
 
 		if (!l_rg2_marked && (offset >= l_rg2_start)) {
 			af += "\n\n ; ***** Region 2 code start *****\n";
@@ -93,7 +109,7 @@ void fi::AsmWriter::generate_asm_file(const fe::Config& p_config,
 			af += std::format(".textbox {}\n", get_define(fi::ArgDomain::TextBox, instr.opcode_byte));
 		}
 		else {
-			const auto& op{ fi::opcodes.find(instr.opcode_byte)->second };
+			const auto& op{ m_opcodes.at(instr.opcode_byte) };
 
 			std::string line{ std::format("    {}", op.name) };
 			std::string comment;
@@ -171,7 +187,7 @@ void fi::AsmWriter::generate_asm_file(const fe::Config& p_config,
 		}
 	}
 
-	klib::file::write_string_to_file(af, p_filename);
+	return af;
 }
 
 void fi::AsmWriter::append_defines_section(std::string& p_asm) const {
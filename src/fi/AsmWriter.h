@@ -8,11 +8,14 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace fi {
 
 	class AsmWriter {
 
+		const fi::OpcodeTable& m_opcodes;
+
 		void append_defines_section(std::string& p_asm) const;
 		void append_strings_section(std::string& p_asm,
 			const std::vector<fi::FaxString>& p_strings) const;
@@ -31,11 +34,18 @@ namespace fi {
 
 	public:
 
-		AsmWriter(void) = default;
+		AsmWriter(const fi::OpcodeTable& p_opcodes);
 
-		void generate_asm_file(const fe::Config& p_config,
+		bool generate_asm_file(const fe::Config& p_config,
 			const std::string& p_filename,
-			const std::map<std::size_t, fi::Instruction>& p_instructions,
+			const fi::InstructionList& p_instructions,
+			const std::vector<std::size_t>& p_entrypoints,
+			const std::set<std::size_t>& p_jump_targets,
+			const std::vector<fi::FaxString>& p_strings,
+			const std::vector<fi::Shop>& p_shops,
+			bool p_shop_comments) const;
+		std::string get_asm_string(const fe::Config& p_config,
+			const fi::InstructionList& p_instructions,
 			const std::vector<std::size_t>& p_entrypoints,
 			const std::set<std::size_t>& p_jump_targets,
 			const std::vector<fi::FaxString>& p_strings,
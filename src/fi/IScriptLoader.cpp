@@ -1,10 +1,17 @@
 #include "IScriptLoader.h"
 #include "fi_constants.h"
+#include "./../common/klib/Kprofile.h"
 #include <algorithm>
+#include <atomic>
 #include <format>
-
-fi::IScriptLoader::IScriptLoader(const std::vector<byte>& p_rom) :
-	rom{ p_rom }
+#include <iterator>
+#include <thread>
+#include <unordered_map>
+
+fi::IScriptLoader::IScriptLoader(klib::RomView p_rom,
+	const fi::OpcodeTable& p_opcodes) :
+	rom{ p_rom },
+	m_opcodes{ p_opcodes }
 {
 }
 
@@ -15,9 +22,11 @@ void fi::IScriptLoader::reset(void) {
 	m_jump_targets.clear();
 	m_shop_addresses.clear();
 	m_strings.clear();
+	m_visited.assign(rom.size(), false);
 }
 
-void fi::IScriptLoader::parse_rom(const fe::Config& p_config) {
+void fi::IScriptLoader::parse_rom(const fe::Config& p_config,
+	std::size_t p_worker_count) {
 	reset();
 
 	// parse strings
@@ -37,8 +46,26 @@ void fi::IScriptLoader::parse_rom(const fe::Config& p_config) {
 			+ 256 * static_cast<std::size_t>(rom.at(l_iscript_ptr.first + l_iscript_count + i))
 			+ l_iscript_ptr.second);
 
-	for (const auto offset : ptr_table)
-		parse_blob_from_entrypoint(offset, l_iscript_ptr.second, true);
+	m_instructions = fi::InstructionList(l_iscript_ptr.second);
+
+	bool l_parsed{ false };
+	if (p_worker_count > 1) {
+		klib::prof::Scope l_prof("IScriptLoader::parse_entrypoints_parallel");
+		l_parsed = parse_entrypoints_parallel(l_iscript_ptr.second, p_worker_count);
+		if (l_parsed)
+			l_prof.detail("{} workers", p_worker_count);
+		else
+			l_prof.detail("fell back to serial parsing");
+	}
+
+	if (!l_parsed)
+		for (std::size_t i{ 0 }; i < ptr_table.size(); ++i) {
+			klib::prof::Scope l_prof("IScriptLoader::parse_blob_from_entrypoint");
+			l_prof.detail("entrypoint {}", i);
+			parse_blob_from_entrypoint(ptr_table[i], l_iscript_ptr.second);
+		}
+
+	m_instructions.sort_by_offset();
 
 	normalize_shop_indexes();
 }
@@ -47,7 +74,7 @@ void fi::IScriptLoader::parse_strings(const fe::Config& p_config) {
 	m_strings.clear();
 	std::string encodedstring;
 
-	const auto& lc_char_map{ p_config.bmap(c::ID_STRING_CHAR_MAP) };
+	const auto& lc_char_table{ p_config.bmap_table(c::ID_STRING_CHAR_MAP) };
 
 	for (std::size_t i{ p_config.constant(c::ID_STRING_DATA_START) };
 		i < p_config.constant(c::ID_STRING_DATA_END) && m_strings.size() < 255;
@@ -59,11 +86,10 @@ void fi::IScriptLoader::parse_strings(const fe::Config& p_config) {
 		}
 		else {
 			byte b{ rom.at(i) };
-			auto iter{ lc_char_map.find(b) };
-			if (iter == end(lc_char_map))
+			if (lc_char_table[b] == nullptr)
 				encodedstring += std::format("<${:02x}>", b);
 			else
-				encodedstring += iter->second;
+				encodedstring += *lc_char_table[b];
 		}
 
 	}
@@ -85,102 +111,247 @@ std::string fi::IScriptLoader::to_hex(size_t value) {
 }
 
 void fi::IScriptLoader::parse_blob_from_entrypoint(size_t offset,
-	size_t zeroaddr, bool at_entrypoint) {
-	if (m_instructions.find(offset) != end(m_instructions))
+	size_t zeroaddr) {
+	// each entrypoint is parsed fully before the next one, so an offset that is
+	// both an entrypoint and a jump target is decoded the same way every time
+	std::vector<std::size_t> worklist;
+	parse_blob(offset, zeroaddr, true, worklist);
+
+	while (!worklist.empty()) {
+		std::size_t target{ worklist.back() };
+		worklist.pop_back();
+		parse_blob(target, zeroaddr, false, worklist);
+	}
+}
+
+void fi::IScriptLoader::parse_blob(size_t offset, size_t zeroaddr,
+	bool at_entrypoint, std::vector<std::size_t>& p_worklist) {
+	if (offset < m_visited.size() && m_visited[offset])
 		return;
 
 	size_t cursor = offset;
 
-	if (at_entrypoint)
-		m_instructions.insert(std::make_pair(offset,
-			fi::Instruction({ Instruction_type::Directive, read_byte(cursor), 1 })
-		));
+	if (at_entrypoint) {
+		m_instructions.push_back(fi::Instruction{
+			.type = Instruction_type::Directive,
+			.opcode_byte = read_byte(cursor),
+			.size = 1,
+			.byte_offset = offset });
+		m_visited[offset] = true;
+	}
 
 	while (cursor < rom.size()) {
-		if (m_instructions.find(cursor) != end(m_instructions))
+		if (m_visited[cursor])
 			return;
 
-		size_t instr_offset = cursor;
-		uint8_t opcode_byte = read_byte(cursor);
-		std::optional<std::size_t> shop_index;
+		fi::Instruction instr{ decode_instruction(cursor, zeroaddr) };
+		const auto& op{ m_opcodes.layout(instr.opcode_byte) };
 
-		auto it = opcodes.find(opcode_byte);
-		if (it == opcodes.end()) {
-			throw std::runtime_error("Unknown opcode " + to_hex(opcode_byte) +
-				" at offset " + to_hex(instr_offset));
+		// track jump targets, extract shops
+		if (op.flow == Flow::Jump) {
+			m_jump_targets.insert(instr.jump_target.value());
+			// parse the branch once this path is done
+			p_worklist.push_back(instr.jump_target.value());
+		}
+		else if (op.flow == Flow::Read) {
+			const auto& shop_iter{ m_shop_addresses.find(instr.jump_target.value()) };
+
+			if (shop_iter == end(m_shop_addresses)) {
+				// new shop, parse it and assign index
+				instr.shop_index = m_shops.size();
+				m_shop_addresses[instr.jump_target.value()] = instr.shop_index.value();
+				m_shops.push_back(read_shop(instr.jump_target.value()));
+			}
+			else {
+				// already seen shop, use its index
+				instr.shop_index = shop_iter->second;
+			}
 		}
 
-		const Opcode& op = it->second;
-		std::vector<uint16_t> operands;
+		m_visited[instr.byte_offset] = true;
+		m_instructions.push_back(instr);
 
-		for (const auto& arg : op.args) {
-			if (arg.type == ArgType::Byte)
-				operands.push_back(read_byte(cursor));
-			else if (arg.type == ArgType::Short)
-				operands.push_back(read_short(cursor));
-		}
+		if (op.ends_stream)
+			break;
 
-		std::optional<std::size_t> target_addr;
+	}
+}
 
-		// track jump targets, extract shops
-		if (op.flow == Flow::Jump || op.flow == Flow::Read) {
-			target_addr = static_cast<std::size_t>(read_short(cursor))
-				+ zeroaddr;
+fi::Instruction fi::IScriptLoader::decode_instruction(std::size_t& cursor,
+	std::size_t zeroaddr) const {
+	size_t instr_offset = cursor;
+	uint8_t opcode_byte = read_byte(cursor);
 
-			if (op.flow == Flow::Jump)
-				m_jump_targets.insert(target_addr.value());
-			else {
-				const auto& shop_iter{ m_shop_addresses.find(target_addr.value()) };
-
-				if (shop_iter == end(m_shop_addresses)) {
-					// new shop, parse it and assign index
-					fi::Shop newshop;
-					std::size_t shop_offset{ target_addr.value() };
-					while (rom.at(shop_offset) != 0xff) {
-						newshop.add_entry(rom.at(shop_offset),
-							rom.at(shop_offset + 1),
-							rom.at(shop_offset + 2));
-						shop_offset += 3;
-					}
+	const auto& layout{ m_opcodes.layout(opcode_byte) };
+	if (!layout.defined) {
+		throw std::runtime_error("Unknown opcode " + to_hex(opcode_byte) +
+			" at offset " + to_hex(instr_offset));
+	}
 
-					shop_index = m_shops.size();
-					m_shop_addresses[target_addr.value()] = shop_index.value();
-					m_shops.push_back(newshop);
+	fi::Instruction result{
+		.type = fi::Instruction_type::OpCode,
+		.opcode_byte = opcode_byte,
+		.size = layout.size,
+		.byte_offset = instr_offset
+	};
 
-				}
-				else {
-					// already seen shop, use its index
-					shop_index = shop_iter->second;
+	for (std::size_t i{ 0 }; i < layout.operand_count; ++i)
+		result.push_operand(layout.is_short(i) ? read_short(cursor) : read_byte(cursor));
+
+	if (layout.flow == Flow::Jump || layout.flow == Flow::Read)
+		result.jump_target = static_cast<std::size_t>(read_short(cursor))
+		+ zeroaddr;
+
+	return result;
+}
+
+fi::Shop fi::IScriptLoader::read_shop(std::size_t p_offset) const {
+	fi::Shop result;
+
+	while (rom.at(p_offset) != 0xff) {
+		result.add_entry(rom.at(p_offset),
+			rom.at(p_offset + 1),
+			rom.at(p_offset + 2));
+		p_offset += 3;
+	}
+
+	return result;
+}
+
+/*
+ Parallel disassembly
+
+ Before the workers start, every entrypoint offset is claimed for its textbox
+ directive. Each worker then takes the next unparsed entrypoint and follows all
+ its code paths into its own buffer, claiming each instruction start in a shared
+ atomic bitmap. A path stops at the first offset somebody else claimed, since
+ that worker decodes the code from there on. No matter which worker claims an
+ offset, it always decodes to the same instruction, so the merged result is the
+ same set of instructions, jump targets and shops as a serial parse.
+
+ The exception is a path reaching the directive of an entrypoint that comes
+ later in the pointer table: a serial parse would decode that directive as an
+ opcode. In that case, and on any decoding error, we give up and let the caller
+ parse serially, which also reports errors in a deterministic order.
+*/
+bool fi::IScriptLoader::parse_entrypoints_parallel(std::size_t zeroaddr,
+	std::size_t p_worker_count) {
+	// unique entrypoint offsets, and the first pointer table index using each
+	std::vector<std::size_t> l_entrypoints;
+	std::unordered_map<std::size_t, std::size_t> l_entry_index;
+
+	for (std::size_t offset : ptr_table) {
+		if (offset >= rom.size())
+			return false;
+		if (l_entry_index.insert(std::make_pair(offset, l_entrypoints.size())).second)
+			l_entrypoints.push_back(offset);
+	}
+
+	// one bit per ROM byte, set by the worker that decodes the instruction starting there
+	std::vector<std::atomic<std::uint64_t>> l_claimed((rom.size() + 63) / 64);
+	const auto claim{ [&l_claimed](std::size_t p_offset) {
+		const std::uint64_t l_bit{ std::uint64_t{ 1 } << (p_offset % 64) };
+		return (l_claimed[p_offset / 64].fetch_or(l_bit, std::memory_order_relaxed) & l_bit) == 0;
+	} };
+
+	for (std::size_t offset : l_entrypoints)
+		claim(offset);
+
+	struct Buffer {
+		fi::InstructionList instructions;
+		std::set<std::size_t> jump_targets;
+		// shop ROM address -> shop
+		std::map<std::size_t, fi::Shop> shops;
+	};
+
+	std::vector<Buffer> l_buffers(std::min(p_worker_count, l_entrypoints.size()),
+		Buffer{ .instructions = fi::InstructionList(zeroaddr) });
+	std::atomic<std::size_t> l_next_entry{ 0 };
+	std::atomic<bool> l_failed{ false };
+
+	const auto worker{ [&](Buffer& p_buffer) {
+		std::vector<std::size_t> l_worklist;
+
+		try {
+			for (std::size_t i{ l_next_entry++ }; i < l_entrypoints.size() && !l_failed; i = l_next_entry++) {
+				std::size_t cursor{ l_entrypoints[i] };
+
+				p_buffer.instructions.push_back(fi::Instruction{
+					.type = Instruction_type::Directive,
+					.opcode_byte = read_byte(cursor),
+					.size = 1,
+					.byte_offset = l_entrypoints[i] });
+				l_worklist.push_back(cursor);
+
+				while (!l_worklist.empty() && !l_failed) {
+					cursor = l_worklist.back();
+					l_worklist.pop_back();
+
+					while (cursor < rom.size()) {
+						auto entry_iter{ l_entry_index.find(cursor) };
+						if (entry_iter != end(l_entry_index)) {
+							if (entry_iter->second > i)
+								l_failed = true;
+							break;
+						}
+						else if (!claim(cursor))
+							break;
+
+						fi::Instruction instr{ decode_instruction(cursor, zeroaddr) };
+						const auto& op{ m_opcodes.layout(instr.opcode_byte) };
+
+						if (op.flow == Flow::Jump) {
+							p_buffer.jump_targets.insert(instr.jump_target.value());
+							l_worklist.push_back(instr.jump_target.value());
+						}
+						else if (op.flow == Flow::Read && !p_buffer.shops.contains(instr.jump_target.value()))
+							p_buffer.shops.insert(std::make_pair(instr.jump_target.value(),
+								read_shop(instr.jump_target.value())));
+
+						p_buffer.instructions.push_back(instr);
+
+						if (op.ends_stream)
+							break;
+					}
 				}
 			}
 		}
+		catch (const std::exception&) {
+			l_failed = true;
+		}
+	} };
+
+	{
+		std::vector<std::thread> workers;
+		for (auto& buffer : l_buffers)
+			workers.emplace_back(worker, std::ref(buffer));
+		for (auto& thread : workers)
+			thread.join();
+	}
 
-		m_instructions.insert(
-			std::make_pair(instr_offset,
-				fi::Instruction{
-					.type = fi::Instruction_type::OpCode,
-					.opcode_byte = opcode_byte,
-					.size = it->second.size(),
-					.jump_target = target_addr,
-					.byte_offset = instr_offset,
-					.operands = std::move(operands),
-					.shop_index = shop_index
-				}));
+	if (l_failed)
+		return false;
 
-		if (op.flow == Flow::Jump) {
-			// parse all branches recursively, but store and restore cursors
-			std::size_t temp_cursor{ cursor };
-			cursor = target_addr.value();
+	// shops are indexed by address, just like normalize_shop_indexes would do
+	std::map<std::size_t, fi::Shop> l_shops;
 
-			parse_blob_from_entrypoint(cursor, zeroaddr, false);
+	for (auto& buffer : l_buffers) {
+		m_instructions.append(buffer.instructions);
+		m_jump_targets.merge(buffer.jump_targets);
+		l_shops.merge(buffer.shops);
+	}
 
-			cursor = temp_cursor;
-		}
+	for (auto& [addr, shop] : l_shops) {
+		m_shop_addresses[addr] = m_shops.size();
+		m_shops.push_back(std::move(shop));
+	}
 
-		if (op.ends_stream)
-			break;
+	for (std::size_t i{ 0 }; i < m_instructions.size(); ++i)
+		if (!m_instructions.is_directive(i) &&
+			m_opcodes.layout(m_instructions.opcode_byte(i)).flow == Flow::Read)
+			m_instructions.set_shop_index(i, m_shop_addresses.at(m_instructions.jump_target(i).value()));
 
-	}
+	return true;
 }
 
 void fi::IScriptLoader::normalize_shop_indexes() {
@@ -214,13 +385,12 @@ void fi::IScriptLoader::normalize_shop_indexes() {
 	m_shops = std::move(reordered_shops);
 
 	// remap instruction operands for shop-reading opcodes
-	for (auto& [offset, instr] : m_instructions) {
-		if (instr.type == fi::Instruction_type::OpCode) {
-			auto opcode_it = opcodes.find(instr.opcode_byte);
-			if (opcode_it != opcodes.end() &&
-				opcode_it->second.flow == Flow::Read &&
-				instr.shop_index.has_value()) {
-				instr.shop_index = old_to_new.at(*instr.shop_index);
+	for (std::size_t i{ 0 }; i < m_instructions.size(); ++i) {
+		if (!m_instructions.is_directive(i)) {
+			const auto shop_index{ m_instructions.shop_index(i) };
+			if (m_opcodes.layout(m_instructions.opcode_byte(i)).flow == Flow::Read &&
+				shop_index.has_value()) {
+				m_instructions.set_shop_index(i, old_to_new.at(shop_index.value()));
 			}
 		}
 	}
@@ -10,6 +10,7 @@
 #include "FaxString.h"
 #include "Shop.h"
 #include "./../fe/Config.h"
+#include "./../common/klib/Krom.h"
 
 using byte = unsigned char;
 
@@ -17,13 +18,15 @@ namespace fi {
 
 	class IScriptLoader {
 	public:
-		IScriptLoader(const std::vector<uint8_t>& rom);
+		IScriptLoader(klib::RomView rom, const fi::OpcodeTable& p_opcodes);
 
 		// TODO change visibility
 	public:
-		const std::vector<byte> rom;
+		const klib::RomView rom;
+		const fi::OpcodeTable& m_opcodes;
 		std::vector<std::size_t> ptr_table;
-		std::map<std::size_t, fi::Instruction> m_instructions;
+		// sorted by byte offset once parsing is done
+		fi::InstructionList m_instructions;
 		std::vector<fi::Shop> m_shops;
 		std::vector<fi::FaxString> m_strings;
 
@@ -33,10 +36,21 @@ namespace fi {
 		std::map<std::size_t, std::size_t> m_shop_addresses;
 
 		void reset(void);
-		void parse_rom(const fe::Config& p_config);
+		// with more than one worker, entrypoints are decoded in parallel; the
+		// result is always identical to a serial parse
+		void parse_rom(const fe::Config& p_config, std::size_t p_worker_count = 1);
 		void parse_strings(const fe::Config& p_config);
-		void parse_blob_from_entrypoint(size_t offset, size_t zeroaddr,
-			bool at_entrypoint);
+		// one bit per ROM byte, set where a parsed instruction starts
+		std::vector<bool> m_visited;
+
+		void parse_blob_from_entrypoint(size_t offset, size_t zeroaddr);
+		// parses one code path, queueing the targets of its jumps
+		void parse_blob(size_t offset, size_t zeroaddr, bool at_entrypoint,
+			std::vector<std::size_t>& p_worklist);
+		bool parse_entrypoints_parallel(std::size_t zeroaddr, std::size_t p_worker_count);
+		// decodes the opcode at the cursor and advances past it
+		fi::Instruction decode_instruction(std::size_t& cursor, std::size_t zeroaddr) const;
+		fi::Shop read_shop(std::size_t p_offset) const;
 		void normalize_shop_indexes(void);
 
 		byte read_byte(std::size_t& offset) const;
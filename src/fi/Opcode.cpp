@@ -1,7 +1,12 @@
 #include "Opcode.h"
+#include "./../common/klib/Khash.h"
 #include "./../common/klib/Kstring.h"
+#include <algorithm>
+#include <format>
+#include <set>
+#include <stdexcept>
 
-std::map<byte, fi::Opcode> fi::opcodes{
+const fi::OpcodeTable fi::default_opcodes{
 	{0x00, fi::Opcode("End", {}, fi::Flow::End, true)},
 	{0x01, fi::Opcode("MsgNoskip", {{fi::ArgType::Byte, fi::ArgDomain::TextString}}, fi::Flow::Continue, false)},
 	{0x02, fi::Opcode("MsgPrompt", {{fi::ArgType::Byte, fi::ArgDomain::TextString}}, fi::Flow::Continue, false)},
@@ -28,8 +33,6 @@ std::map<byte, fi::Opcode> fi::opcodes{
 	{0x17, fi::Opcode("Jump", {}, fi::Flow::Jump, true)}
 };
 
-std::map<std::string, fi::Opcode> fi::implementation_opcodes;
-
 namespace {
 
 	const fi::Opcode NONE_CONTINUE{
@@ -132,7 +135,9 @@ static ParsedOpcodeDef parse_opcode_properties(const std::string& p_definition)
 	return { result, impl };
 }
 
-static fi::Opcode parse_opcode_def(const std::string& p_definition, std::vector<std::string>& p_required_impls) {
+static fi::Opcode parse_opcode_def(const std::string& p_definition,
+	const std::map<std::string, fi::Opcode>& p_implementation_opcodes,
+	std::vector<std::string>& p_required_impls) {
 	auto parsed{ parse_opcode_properties(p_definition) };
 
 	if (parsed.impl)
@@ -149,8 +154,8 @@ static fi::Opcode parse_opcode_def(const std::string& p_definition, std::vector<
 		auto opcode_name{ parsed.opcode.name };
 		const auto key{ klib::str::to_lower(*parsed.impl) };
 
-		const auto it{ fi::implementation_opcodes.find(key) };
-		if (it == fi::implementation_opcodes.end())
+		const auto it{ p_implementation_opcodes.find(key) };
+		if (it == p_implementation_opcodes.end())
 			throw std::runtime_error(std::format(
 				"Unknown script opcode implementation '{}'", *parsed.impl));
 
@@ -163,8 +168,9 @@ static fi::Opcode parse_opcode_def(const std::string& p_definition, std::vector<
 	return parsed.opcode;
 }
 
-static void load_opcode_implementations(const std::map<std::string, std::string>& p_impl_defs) {
-	fi::implementation_opcodes.clear();
+static std::map<std::string, fi::Opcode> load_opcode_implementations(
+	const std::map<std::string, std::string>& p_impl_defs) {
+	std::map<std::string, fi::Opcode> result;
 
 	for (const auto& [impl_name, definition] : p_impl_defs) {
 		auto parsed{ parse_opcode_properties(definition) };
@@ -176,8 +182,10 @@ static void load_opcode_implementations(const std::map<std::string, std::string>
 		parsed.opcode.name = impl_name;
 
 		const auto key{ klib::str::to_lower(impl_name) };
-		fi::implementation_opcodes.emplace(key, parsed.opcode);
+		result.emplace(key, parsed.opcode);
 	}
+
+	return result;
 }
 
 fi::ScriptOpcodeInfo fi::load_iscript_opcodes_from_config(const std::map<byte, std::string>& p_opcode_defs,
@@ -189,7 +197,7 @@ fi::ScriptOpcodeInfo fi::load_iscript_opcodes_from_config(const std::map<byte, s
 	if (p_opcode_defs.empty())
 		return result;
 
-	load_opcode_implementations(p_impl_defs);
+	const auto l_implementation_opcodes{ load_opcode_implementations(p_impl_defs) };
 
 	std::map<byte, fi::Opcode> l_opcodes;
 
@@ -203,18 +211,18 @@ fi::ScriptOpcodeInfo fi::load_iscript_opcodes_from_config(const std::map<byte, s
 
 		++expected;
 
-		auto parsed{ parse_opcode_def(kv.second, result.required_impls) };
+		auto parsed{ parse_opcode_def(kv.second, l_implementation_opcodes, result.required_impls) };
 		l_opcodes.insert(std::make_pair(kv.first, parsed));
 	}
 
 	result.base_opcode_count = p_opcode_defs.size() - result.required_impls.size();
 
 	if constexpr (THROW_ON_OPCODE_DIFFS) {
-		if (l_opcodes != fi::opcodes)
+		if (fi::OpcodeTable(l_opcodes) != fi::default_opcodes)
 			throw std::runtime_error("Vanilla iScript opcodes do not match config");
 	}
 
-	fi::opcodes = l_opcodes;
+	result.opcodes = fi::OpcodeTable(l_opcodes);
 
 	return result;
 }
@@ -251,35 +259,331 @@ std::size_t fi::Opcode::size(void) const {
 	return result;
 }
 
+// opcode table members
+fi::OpcodeTable::OpcodeTable(std::initializer_list<std::pair<const byte, fi::Opcode>> p_opcodes) :
+	OpcodeTable(std::map<byte, fi::Opcode>(p_opcodes))
+{
+}
+
+fi::OpcodeTable::OpcodeTable(const std::map<byte, fi::Opcode>& p_opcodes) :
+	m_index{},
+	m_layouts{},
+	m_mnemonic_seed{ klib::hash::FNV1A_64_OFFSET }
+{
+	m_definitions.reserve(p_opcodes.size());
+	m_mnemonics.reserve(p_opcodes.size());
+
+	for (const auto& [opcode_byte, op] : p_opcodes) {
+		fi::OpcodeLayout l_layout{
+			.size = static_cast<std::uint8_t>(op.size()),
+			.operand_count = 0,
+			.short_operands = 0,
+			.flow = op.flow,
+			.ends_stream = op.ends_stream,
+			.defined = true
+		};
+
+		if (op.args.size() > fi::MAX_OPERANDS)
+			throw std::runtime_error(std::format("Opcode '{}' has more than {} arguments",
+				op.name, fi::MAX_OPERANDS));
+
+		for (const auto& arg : op.args) {
+			if (arg.type == fi::ArgType::None)
+				continue;
+
+			if (arg.type == fi::ArgType::Short)
+				l_layout.short_operands |= static_cast<std::uint16_t>(1 << l_layout.operand_count);
+			++l_layout.operand_count;
+		}
+
+		m_index[opcode_byte] = static_cast<std::uint8_t>(m_definitions.size());
+		m_layouts[opcode_byte] = l_layout;
+		m_definitions.push_back(op);
+		m_mnemonics.push_back(klib::str::to_lower(op.name));
+	}
+
+	build_mnemonic_table();
+}
+
+std::size_t fi::OpcodeTable::mnemonic_slot(std::string_view p_mnemonic) const {
+	return klib::hash::fnv1a_64(p_mnemonic, m_mnemonic_seed) & (m_mnemonic_slots.size() - 1);
+}
+
+// tries seeds, growing the table when needed, until no two mnemonics share a slot
+void fi::OpcodeTable::build_mnemonic_table(void) {
+	// opcode bytes to index; the lowest byte wins if a mnemonic is defined more than once
+	std::vector<byte> l_opcodes;
+	std::set<std::string> l_seen;
+
+	for (std::size_t i{ 0 }; i < m_layouts.size(); ++i)
+		if (m_layouts[i].defined && !m_mnemonics[m_index[i]].empty() &&
+			l_seen.insert(m_mnemonics[m_index[i]]).second)
+			l_opcodes.push_back(static_cast<byte>(i));
+
+	std::size_t l_slot_count{ 1 };
+	while (l_slot_count < 2 * l_opcodes.size())
+		l_slot_count *= 2;
+
+	for (std::size_t l_attempt{ 0 }; ; ++l_attempt) {
+		// after a few failed seeds it is cheaper to use a sparser table
+		if (l_attempt != 0 && l_attempt % 64 == 0)
+			l_slot_count *= 2;
+
+		m_mnemonic_seed = klib::hash::FNV1A_64_OFFSET + l_attempt;
+		m_mnemonic_slots.assign(l_slot_count, -1);
+
+		bool l_collision{ false };
+		for (byte opcode : l_opcodes) {
+			auto& slot{ m_mnemonic_slots[mnemonic_slot(m_mnemonics[m_index[opcode]])] };
+			if (slot != -1) {
+				l_collision = true;
+				break;
+			}
+			slot = opcode;
+		}
+
+		if (!l_collision)
+			return;
+	}
+}
+
+const fi::Opcode* fi::OpcodeTable::find(byte p_opcode) const {
+	if (!m_layouts[p_opcode].defined)
+		return nullptr;
+	return &m_definitions[m_index[p_opcode]];
+}
+
+const fi::Opcode& fi::OpcodeTable::at(byte p_opcode) const {
+	const auto result{ find(p_opcode) };
+	if (result == nullptr)
+		throw std::out_of_range(std::format("Undefined opcode ${:02x}", p_opcode));
+	return *result;
+}
+
+std::optional<byte> fi::OpcodeTable::find_mnemonic(std::string_view p_mnemonic) const {
+	const auto slot{ m_mnemonic_slots[mnemonic_slot(p_mnemonic)] };
+	if (slot == -1 || m_mnemonics[m_index[slot]] != p_mnemonic)
+		return std::nullopt;
+	return static_cast<byte>(slot);
+}
+
+std::size_t fi::OpcodeTable::size(void) const {
+	return m_definitions.size();
+}
+
+bool fi::OpcodeTable::operator==(const fi::OpcodeTable& p_other) const {
+	return m_index == p_other.m_index &&
+		m_definitions == p_other.m_definitions;
+}
+
 // instruction members
-std::vector<byte> fi::Instruction::get_bytes(void) const {
-	std::vector<byte> result{ opcode_byte };
-	if (type == Instruction_type::Directive)
-		return result;
+void fi::Instruction::push_operand(std::uint16_t p_operand) {
+	if (operand_count == operands.size())
+		throw std::runtime_error(std::format("Instructions take at most {} operands", operands.size()));
+	operands[operand_count++] = p_operand;
+}
+
+// instruction list members
+fi::InstructionList::InstructionList(std::size_t p_base) :
+	m_base{ p_base }
+{
+}
+
+std::uint16_t fi::InstructionList::to_relative(std::size_t p_offset) const {
+	if (p_offset < m_base || p_offset - m_base > 0xffff)
+		throw std::runtime_error(std::format("Offset 0x{:x} is not within a bank of 0x{:x}", p_offset, m_base));
+	return static_cast<std::uint16_t>(p_offset - m_base);
+}
+
+void fi::InstructionList::push_back(const fi::Instruction& p_instruction) {
+	if (p_instruction.shop_index.has_value() && p_instruction.shop_index.value() > 0xffff)
+		throw std::runtime_error(std::format("Shop index {} is out of range", p_instruction.shop_index.value()));
+
+	byte l_flags{ static_cast<byte>(p_instruction.operand_count << OPERAND_COUNT_SHIFT) };
+	if (p_instruction.type == fi::Instruction_type::Directive)
+		l_flags |= FLAG_DIRECTIVE;
+	if (p_instruction.jump_target.has_value())
+		l_flags |= FLAG_JUMP_TARGET;
+	if (p_instruction.shop_index.has_value())
+		l_flags |= FLAG_SHOP_INDEX;
+
+	m_offsets.push_back(to_relative(p_instruction.byte_offset));
+	m_jump_targets.push_back(p_instruction.jump_target.has_value() ?
+		to_relative(p_instruction.jump_target.value()) : 0);
+	m_opcode_bytes.push_back(p_instruction.opcode_byte);
+	m_sizes.push_back(static_cast<byte>(p_instruction.size));
+	m_flags.push_back(l_flags);
+	m_shop_indexes.push_back(static_cast<std::uint16_t>(p_instruction.shop_index.value_or(0)));
+	m_operands.push_back(p_instruction.operands);
+}
+
+void fi::InstructionList::append(const fi::InstructionList& p_other) {
+	if (p_other.m_base != m_base)
+		throw std::runtime_error("Cannot append instructions with a different base offset");
+
+	m_opcode_bytes.insert(end(m_opcode_bytes), begin(p_other.m_opcode_bytes), end(p_other.m_opcode_bytes));
+	m_sizes.insert(end(m_sizes), begin(p_other.m_sizes), end(p_other.m_sizes));
+	m_flags.insert(end(m_flags), begin(p_other.m_flags), end(p_other.m_flags));
+	m_offsets.insert(end(m_offsets), begin(p_other.m_offsets), end(p_other.m_offsets));
+	m_jump_targets.insert(end(m_jump_targets), begin(p_other.m_jump_targets), end(p_other.m_jump_targets));
+	m_shop_indexes.insert(end(m_shop_indexes), begin(p_other.m_shop_indexes), end(p_other.m_shop_indexes));
+	m_operands.insert(end(m_operands), begin(p_other.m_operands), end(p_other.m_operands));
+}
+
+void fi::InstructionList::clear(void) {
+	m_opcode_bytes.clear();
+	m_sizes.clear();
+	m_flags.clear();
+	m_offsets.clear();
+	m_jump_targets.clear();
+	m_shop_indexes.clear();
+	m_operands.clear();
+}
+
+void fi::InstructionList::reserve(std::size_t p_count) {
+	m_opcode_bytes.reserve(p_count);
+	m_sizes.reserve(p_count);
+	m_flags.reserve(p_count);
+	m_offsets.reserve(p_count);
+	m_jump_targets.reserve(p_count);
+	m_shop_indexes.reserve(p_count);
+	m_operands.reserve(p_count);
+}
+
+std::size_t fi::InstructionList::size(void) const {
+	return m_offsets.size();
+}
+
+bool fi::InstructionList::empty(void) const {
+	return m_offsets.empty();
+}
 
-	const auto& op{ fi::opcodes.at(opcode_byte) };
+void fi::InstructionList::sort_by_offset(void) {
+	std::vector<std::uint32_t> l_order(size());
+	for (std::size_t i{ 0 }; i < l_order.size(); ++i)
+		l_order[i] = static_cast<std::uint32_t>(i);
+
+	std::sort(begin(l_order), end(l_order),
+		[this](std::uint32_t a, std::uint32_t b) {
+			return m_offsets[a] < m_offsets[b];
+		});
+
+	const auto permute{ [&l_order](auto& p_column) {
+		std::remove_reference_t<decltype(p_column)> l_sorted;
+		l_sorted.reserve(p_column.size());
+		for (std::uint32_t i : l_order)
+			l_sorted.push_back(p_column[i]);
+		p_column = std::move(l_sorted);
+	} };
+
+	permute(m_opcode_bytes);
+	permute(m_sizes);
+	permute(m_flags);
+	permute(m_offsets);
+	permute(m_jump_targets);
+	permute(m_shop_indexes);
+	permute(m_operands);
+}
+
+fi::Instruction fi::InstructionList::operator[](std::size_t p_index) const {
+	return fi::Instruction{
+		.type = is_directive(p_index) ? fi::Instruction_type::Directive : fi::Instruction_type::OpCode,
+		.opcode_byte = m_opcode_bytes[p_index],
+		.size = m_sizes[p_index],
+		.jump_target = jump_target(p_index),
+		.byte_offset = byte_offset(p_index),
+		.operands = m_operands[p_index],
+		.operand_count = static_cast<std::size_t>(m_flags[p_index] >> OPERAND_COUNT_SHIFT),
+		.shop_index = shop_index(p_index)
+	};
+}
+
+bool fi::InstructionList::is_directive(std::size_t p_index) const {
+	return (m_flags[p_index] & FLAG_DIRECTIVE) != 0;
+}
 
-	if (operands.size() != op.args.size())
+byte fi::InstructionList::opcode_byte(std::size_t p_index) const {
+	return m_opcode_bytes[p_index];
+}
+
+std::size_t fi::InstructionList::byte_size(std::size_t p_index) const {
+	return m_sizes[p_index];
+}
+
+std::size_t fi::InstructionList::byte_offset(std::size_t p_index) const {
+	return m_base + m_offsets[p_index];
+}
+
+std::optional<std::size_t> fi::InstructionList::jump_target(std::size_t p_index) const {
+	if ((m_flags[p_index] & FLAG_JUMP_TARGET) == 0)
+		return std::nullopt;
+	return m_base + m_jump_targets[p_index];
+}
+
+std::optional<std::size_t> fi::InstructionList::shop_index(std::size_t p_index) const {
+	if ((m_flags[p_index] & FLAG_SHOP_INDEX) == 0)
+		return std::nullopt;
+	return m_shop_indexes[p_index];
+}
+
+void fi::InstructionList::set_byte_offset(std::size_t p_index, std::size_t p_offset) {
+	m_offsets.at(p_index) = to_relative(p_offset);
+}
+
+void fi::InstructionList::set_jump_target(std::size_t p_index, std::size_t p_offset) {
+	m_jump_targets.at(p_index) = to_relative(p_offset);
+	m_flags[p_index] |= FLAG_JUMP_TARGET;
+}
+
+void fi::InstructionList::set_shop_index(std::size_t p_index, std::size_t p_shop_index) {
+	if (p_shop_index > 0xffff)
+		throw std::runtime_error(std::format("Shop index {} is out of range", p_shop_index));
+
+	m_shop_indexes.at(p_index) = static_cast<std::uint16_t>(p_shop_index);
+	m_flags[p_index] |= FLAG_SHOP_INDEX;
+}
+
+void fi::InstructionList::set_operand(std::size_t p_index, std::size_t p_operand_index,
+	std::uint16_t p_value) {
+	if (p_operand_index >= static_cast<std::size_t>(m_flags.at(p_index) >> OPERAND_COUNT_SHIFT))
+		throw std::out_of_range(std::format("Instruction {} has no operand {}", p_index, p_operand_index));
+	m_operands[p_index][p_operand_index] = p_value;
+}
+
+std::size_t fi::InstructionList::encode(std::size_t p_index, const fi::OpcodeTable& p_opcodes,
+	std::span<byte> p_out) const {
+	const std::size_t l_size{ m_sizes[p_index] };
+	if (p_out.size() < l_size)
+		throw std::out_of_range(std::format("Instruction {} needs {} bytes, but only {} are available",
+			p_index, l_size, p_out.size()));
+
+	std::size_t l_pos{ 0 };
+	p_out[l_pos++] = m_opcode_bytes[p_index];
+	if (is_directive(p_index))
+		return l_pos;
+
+	const auto& op{ p_opcodes.at(m_opcode_bytes[p_index]) };
+	const std::size_t l_operand_count{ static_cast<std::size_t>(m_flags[p_index] >> OPERAND_COUNT_SHIFT) };
+	const auto& operands{ m_operands[p_index] };
+
+	if (l_operand_count != op.args.size())
 		throw std::runtime_error(std::format("Opcode '{}' expects {} operand(s), got {}",
-			op.name, op.args.size(), operands.size()));
+			op.name, op.args.size(), l_operand_count));
+
+	const auto put_short{ [&p_out, &l_pos](std::uint16_t p_value) {
+		p_out[l_pos++] = static_cast<byte>(p_value % 256);
+		p_out[l_pos++] = static_cast<byte>(p_value / 256);
+	} };
 
 	for (std::size_t i{ 0 }; i < op.args.size(); ++i) {
-		const auto& arg{ op.args[i] };
-		const auto opval{ operands[i] };
-
-		if (arg.type == fi::ArgType::Byte)
-			result.push_back(static_cast<byte>(opval));
-		else if (arg.type == fi::ArgType::Short) {
-			result.push_back(static_cast<byte>(opval % 256));
-			result.push_back(static_cast<byte>(opval / 256));
-		}
+		if (op.args[i].type == fi::ArgType::Byte)
+			p_out[l_pos++] = static_cast<byte>(operands[i]);
+		else if (op.args[i].type == fi::ArgType::Short)
+			put_short(operands[i]);
 	}
 
-	if (op.flow == fi::Flow::Jump || op.flow == fi::Flow::Read) {
-		uint16_t opval{ static_cast<uint16_t>(jump_target.value()) };
-		result.push_back(static_cast<byte>(opval % 256));
-		result.push_back(static_cast<byte>(opval / 256));
-	}
+	if (op.flow == fi::Flow::Jump || op.flow == fi::Flow::Read)
+		put_short(static_cast<std::uint16_t>(jump_target(p_index).value()));
 
-	return result;
+	return l_pos;
 }
@@ -1,11 +1,15 @@
 #ifndef FI_OPCODE_H
 #define FI_OPCODE_H
 
+#include <array>
 #include <cstdint>
 #include <initializer_list>
 #include <map>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 using byte = unsigned char;
@@ -51,24 +55,135 @@ namespace fi {
 		std::size_t size(void) const;
 	};
 
-	extern std::map<byte, fi::Opcode> opcodes;
-	extern std::map<std::string, fi::Opcode> implementation_opcodes;
+	// operands are stored inline with each instruction, so an opcode can not take more;
+	// the count also has to fit the high nibble of the instruction flags
+	constexpr std::size_t MAX_OPERANDS{ 8 };
+	// the opcode byte, every operand a Short, and a jump or read address
+	constexpr std::size_t MAX_INSTRUCTION_SIZE{ 1 + 2 * MAX_OPERANDS + 2 };
+
+	// what the decoder needs to know about an opcode byte, packed into one slot
+	struct OpcodeLayout {
+		// in bytes, including the opcode and any jump or read address
+		std::uint8_t size;
+		// Byte and Short operands, and a bit per operand that is set for Shorts
+		std::uint8_t operand_count;
+		std::uint16_t short_operands;
+		fi::Flow flow;
+		bool ends_stream, defined;
+
+		bool is_short(std::size_t p_operand) const {
+			return (short_operands >> p_operand) & 1;
+		}
+	};
+
+	// opcode byte -> opcode definition; immutable once built, so any number of
+	// tables can be shared between readers, loaders and writers
+	class OpcodeTable {
+		// defined opcodes, in opcode byte order
+		std::vector<fi::Opcode> m_definitions;
+		// opcode byte -> index into m_definitions
+		std::array<std::uint8_t, 256> m_index;
+		std::array<fi::OpcodeLayout, 256> m_layouts;
+
+		// lowercase mnemonics, in the same order as m_definitions
+		std::vector<std::string> m_mnemonics;
+		// perfect hash of lowercase mnemonic -> opcode byte, -1 for free slots
+		std::vector<std::int16_t> m_mnemonic_slots;
+		std::uint64_t m_mnemonic_seed;
+
+		std::size_t mnemonic_slot(std::string_view p_mnemonic) const;
+		void build_mnemonic_table(void);
+
+	public:
+		OpcodeTable(std::initializer_list<std::pair<const byte, fi::Opcode>> p_opcodes);
+		explicit OpcodeTable(const std::map<byte, fi::Opcode>& p_opcodes);
+
+		const fi::OpcodeLayout& layout(byte p_opcode) const {
+			return m_layouts[p_opcode];
+		}
+		// nullptr if the byte is not an opcode
+		const fi::Opcode* find(byte p_opcode) const;
+		// throws std::out_of_range if the byte is not an opcode
+		const fi::Opcode& at(byte p_opcode) const;
+		// takes a lowercase mnemonic
+		std::optional<byte> find_mnemonic(std::string_view p_mnemonic) const;
+		std::size_t size(void) const;
+
+		bool operator==(const OpcodeTable& p_other) const;
+	};
+
+	// the original game's opcodes, used when the config does not define any
+	extern const fi::OpcodeTable default_opcodes;
 
 	enum Instruction_type { OpCode, Directive };
 
+	// one instruction while it is decoded or parsed; offsets are ROM offsets
+	// for the loader, and bank-relative for the assembler
 	struct Instruction {
 		Instruction_type type;
 		byte opcode_byte;
 		std::size_t size;
 		std::optional<std::size_t> jump_target;
-		std::optional<std::size_t> byte_offset;
-		std::vector<uint16_t> operands;
+		std::size_t byte_offset;
+		// one per opcode argument, in argument order
+		std::array<std::uint16_t, MAX_OPERANDS> operands{};
+		std::size_t operand_count{ 0 };
 		std::optional<std::size_t> shop_index;
 
-		std::vector<byte> get_bytes(void) const;
+		void push_operand(std::uint16_t p_operand);
+	};
+
+	// instructions stored column by column; offsets and jump targets are kept
+	// as 16-bit values relative to a base offset, which covers a whole bank
+	class InstructionList {
+		// low bits; the operand count goes in the high nibble
+		static constexpr byte FLAG_DIRECTIVE{ 0x01 };
+		static constexpr byte FLAG_JUMP_TARGET{ 0x02 };
+		static constexpr byte FLAG_SHOP_INDEX{ 0x04 };
+		static constexpr unsigned OPERAND_COUNT_SHIFT{ 4 };
+
+		std::size_t m_base;
+		std::vector<byte> m_opcode_bytes, m_sizes, m_flags;
+		std::vector<std::uint16_t> m_offsets, m_jump_targets, m_shop_indexes;
+		std::vector<std::array<std::uint16_t, MAX_OPERANDS>> m_operands;
+
+		std::uint16_t to_relative(std::size_t p_offset) const;
+
+	public:
+		explicit InstructionList(std::size_t p_base = 0);
+
+		// offsets in the instruction are absolute, and must lie within 64KB of the base
+		void push_back(const fi::Instruction& p_instruction);
+		// both lists must share the same base
+		void append(const fi::InstructionList& p_other);
+		void clear(void);
+		void reserve(std::size_t p_count);
+		std::size_t size(void) const;
+		bool empty(void) const;
+		void sort_by_offset(void);
+
+		fi::Instruction operator[](std::size_t p_index) const;
+
+		bool is_directive(std::size_t p_index) const;
+		byte opcode_byte(std::size_t p_index) const;
+		std::size_t byte_size(std::size_t p_index) const;
+		std::size_t byte_offset(std::size_t p_index) const;
+		std::optional<std::size_t> jump_target(std::size_t p_index) const;
+		std::optional<std::size_t> shop_index(std::size_t p_index) const;
+
+		void set_byte_offset(std::size_t p_index, std::size_t p_offset);
+		void set_jump_target(std::size_t p_index, std::size_t p_offset);
+		void set_shop_index(std::size_t p_index, std::size_t p_shop_index);
+		void set_operand(std::size_t p_index, std::size_t p_operand_index, std::uint16_t p_value);
+
+		// writes the instruction's ROM bytes to the start of p_out, which must hold
+		// at least byte_size(p_index) bytes; returns the number of bytes written
+		std::size_t encode(std::size_t p_index, const fi::OpcodeTable& p_opcodes,
+			std::span<byte> p_out) const;
 	};
 
 	struct ScriptOpcodeInfo {
+		fi::OpcodeTable opcodes{ default_opcodes };
 		std::vector<std::string> required_impls;
 		std::size_t base_opcode_count{ 0 };
 	};
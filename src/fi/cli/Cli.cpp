@@ -1,6 +1,14 @@
 #include "Cli.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
 #include <format>
+#include <future>
 #include <iostream>
+#include <sstream>
+#include <thread>
 #include "application_constants.h"
 #include "./../fi_constants.h"
 #include "./../../fm/fm_constants.h"
@@ -16,6 +24,8 @@
 #include "./../../fm/MMLReader.h"
 #include "./../../fm/MMLWriter.h"
 #include "./../../common/klib/Kfile.h"
+#include "./../../common/klib/Kpatch.h"
+#include "./../../common/klib/Kprofile.h"
 #include "./../../common/klib/Kstring.h"
 #include "./../../fm/song/MMLSong.h"
 #include "./../../fm/song/MMLSongCollection.h"
@@ -28,20 +38,47 @@
 #include <windows.h>
 #endif
 
-constexpr char ID_DUPLICATE_STATIC_BANK[]{ "duplicate_static_bank" };
+static const fe::ConfigKey ID_DUPLICATE_STATIC_BANK{ "duplicate_static_bank" };
+
+// output file extension and the build stage reading it back, for each extract-all output
+static const std::vector<std::pair<std::string, fi::ScriptMode>> EXTRACT_ALL_OUTPUTS{
+	{ "asm", fi::ScriptMode::IScriptBuild },
+	{ "basm", fi::ScriptMode::BScriptBuild },
+	{ "mml", fi::ScriptMode::MmlBuild },
+	{ "txt", fi::ScriptMode::MiscBuild }
+};
+
+// empty if the variable is not set
+static std::string get_environment_variable(const char* p_name) {
+#ifdef _WIN32
+	char* l_value{ nullptr };
+	std::size_t l_length{ 0 };
+	std::string result;
+
+	if (_dupenv_s(&l_value, &l_length, p_name) == 0 && l_value != nullptr)
+		result = l_value;
+	std::free(l_value);
+
+	return result;
+#else
+	const char* l_value{ std::getenv(p_name) };
+	return l_value == nullptr ? std::string() : std::string(l_value);
+#endif
+}
 
 void fi::Cli::print_header(void) const {
-	std::cout << fi::appc::APP_NAME << " v" << fi::appc::APP_VERSION << " - Faxanadu Script Assembler and Disassembler\n";
-	std::cout << "Author: Kai E. Fr";
+	*m_out << fi::appc::APP_NAME << " v" << fi::appc::APP_VERSION << " - Faxanadu Script Assembler and Disassembler\n";
+	*m_out << "Author: Kai E. Fr";
 	output_oe_on_windows();
-	std::cout << "land (" << fi::appc::APP_URL << ")\n";
-	std::cout << "Build date: " << __DATE__ << " " << __TIME__ << " CET\n\n";
+	*m_out << "land (" << fi::appc::APP_URL << ")\n";
+	*m_out << "Build date: " << __DATE__ << " " << __TIME__ << " CET\n\n";
 }
 
 void fi::Cli::print_help(void) const {
-	std::cout <<
+	*m_out <<
 		"Usage:\n"
-		"  faxiscripts <command> <input> <output> [options]\n\n"
+		"  faxiscripts <command> <input> <output> [options]\n"
+		"  A ROM or output file given as - is read from stdin or written to stdout\n\n"
 		"Commands:\n"
 		"  IScripts (interaction scripts):\n"
 		"    x,   extract            - Disassemble IScripts from ROM\n"
@@ -69,20 +106,38 @@ void fi::Cli::print_help(void) const {
 		"\n"
 		"  LilyPond:\n"
 		"    m2l, mml-to-ly         - Convert MML to LilyPond files\n"
-		"    r2l, rom-to-ly         - Extract music from ROM as LilyPond files\n\n";
-
-	std::cout << "Options:\n";
-	std::cout << "  Common options:\n";
-	std::cout << "    -r, --region                 ROM region which must be defined in the configuration xml (auto-detected by default)\n";
-	std::cout << "    -f, --force                  Force file overwrite when extracting data (disabled by default)\n";
-	std::cout << "    -s, --source-rom             Source ROM when assembling (by default the output file itself)\n";
-	std::cout << "    -o, --original-size          Only patch original ROM location (disabled by default)\n";
-	std::cout << "  IScript options:\n";
-	std::cout << "    -p, --no-shop-comments       Disable shop comment extraction (enabled by default)\n";
-	std::cout << "  MScript options:\n";
-	std::cout << "    -n, --no-notes               Do not emit notes in music disassembly (notes enabled by default)\n";
-	std::cout << "  MML options:\n";
-	std::cout << "    -lp, --lilypond-percussion   Add percussion staff to the LilyPond output (disabled by default)\n";
+		"    r2l, rom-to-ly         - Extract music from ROM as LilyPond files\n"
+		"\n"
+		"  All data types:\n"
+		"    xa,  extract-all       - Extract iScripts, bScripts, MML and misc data from ROM in one go\n"
+		"    rt,  corpus            - Extract and rebuild every ROM in a directory, report round-trip differences\n"
+		"\n"
+		"  Batch:\n"
+		"    bt,  batch             - Run all build commands listed in a manifest file against one ROM\n"
+		"\n"
+		"  Resident mode:\n"
+		"    sv,  serve             - Keep ROM and configuration in memory, read commands from stdin\n\n";
+
+	*m_out << "Options:\n";
+	*m_out << "  Common options:\n";
+	*m_out << "    -r, --region                 ROM region which must be defined in the configuration xml (auto-detected by default)\n";
+	*m_out << "    -f, --force                  Force file overwrite when extracting data (disabled by default)\n";
+	*m_out << "    -s, --source-rom             Source ROM when assembling (by default the output file itself)\n";
+	*m_out << "    -o, --original-size          Only patch original ROM location (disabled by default)\n";
+	*m_out << "    -w, --watch                  Rebuild whenever the input file or configuration changes (build commands only)\n";
+	*m_out << "    -nc, --no-config-cache       Always parse the configuration xml files, and do not update the config cache\n";
+	*m_out << "    -pf, --profile               Print time, bytes and item counts spent in each processing phase\n";
+	*m_out << "    -pj, --profile-json          Also write the phase profile to the given JSON file\n";
+	*m_out << "    -t, --trace                  Write a Chrome trace event file of all processing phases to the given file\n";
+	*m_out << "    -c, --check                  Only parse, link and size-check the input file, and print diagnostics as JSON (build commands only)\n";
+	*m_out << "    -po, --patch-out             Write an IPS or BPS patch to the given file instead of patching the ROM (build commands only)\n";
+	*m_out << "  IScript options:\n";
+	*m_out << "    -p, --no-shop-comments       Disable shop comment extraction (enabled by default)\n";
+	*m_out << "    -pl, --parallel              Disassemble iScript entrypoints on all cores (disabled by default)\n";
+	*m_out << "  MScript options:\n";
+	*m_out << "    -n, --no-notes               Do not emit notes in music disassembly (notes enabled by default)\n";
+	*m_out << "  MML options:\n";
+	*m_out << "    -lp, --lilypond-percussion   Add percussion staff to the LilyPond output (disabled by default)\n";
 }
 
 fi::Cli::Cli(int argc, char** argv) :
@@ -90,8 +145,22 @@ fi::Cli::Cli(int argc, char** argv) :
 	m_shop_comments{ true },
 	m_overwrite{ false },
 	m_notes{ true },
-	m_lilypond_percussion{ false }
+	m_lilypond_percussion{ false },
+	m_watch{ false },
+	m_profile{ false },
+	m_config_cache{ true },
+	m_check{ false },
+	m_iscript_workers{ 1 },
+	m_out{ &std::cout },
+	m_err{ &std::cerr }
 {
+	// keep stdout clean when it carries the output file or the check report
+	if (argc >= 4 && klib::file::is_stdio(argv[3]))
+		m_out = m_err;
+	for (int i{ 4 }; i < argc; ++i)
+		if (check_mode(argv[i], appc::CLI_FLAGS[8]))
+			m_out = m_err;
+
 	print_header();
 
 	if (argc < 4) {
@@ -105,11 +174,60 @@ fi::Cli::Cli(int argc, char** argv) :
 		parse_arguments(4, argc, argv);
 	}
 
-	m_config.load_definitions(appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME);
+	klib::prof::set_enabled(m_profile || !m_profile_json.empty() || !m_trace_file.empty());
+
+	if (m_config_cache)
+		m_config.set_cache_dir(get_config_cache_dir());
+
+	try {
+		klib::prof::Scope l_prof("total");
+		execute();
+	}
+	catch (const std::exception&) {
+		// a failed run is still worth profiling
+		if (klib::prof::is_enabled())
+			report_profile();
+		throw;
+	}
+
+	if (klib::prof::is_enabled())
+		report_profile();
+}
+
+void fi::Cli::execute(void) {
+	{
+		klib::prof::Scope l_prof("load region definitions");
+		m_config.load_definitions(appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME);
+	}
+
+	if (!m_patch_file.empty() && !is_build_mode(m_script_mode) &&
+		m_script_mode != fi::ScriptMode::Batch && m_script_mode != fi::ScriptMode::Serve)
+		throw std::runtime_error("Patch output can only be used with build commands");
+
+	check_stdio_arguments();
+
+	// every ROM write of this command lands in the journal, which patch output is made from
+	const klib::patch::Recording l_recording(m_journal);
 
 	// we have the info we need to execute
+	// check mode - lint the input file without touching the ROM
+	if (m_check) {
+		if (!is_build_mode(m_script_mode) || m_watch || !m_patch_file.empty())
+			throw std::runtime_error("Check mode can only be used with build commands, and not with watch mode or patch output");
+
+		check_build(m_script_mode, m_in_file,
+			m_source_rom.empty() ? m_out_file : m_source_rom);
+	}
+	// watch mode - rebuild when the input file or the configuration changes
+	else if (m_watch) {
+		if (!is_build_mode(m_script_mode))
+			throw std::runtime_error("Watch mode can only be used with build commands");
+
+		watch_build(m_script_mode, m_in_file, m_out_file,
+			m_source_rom.empty() ? m_out_file : m_source_rom);
+	}
 	// IScript dispatch
-	if (m_script_mode == fi::ScriptMode::IScriptBuild) {
+	else if (m_script_mode == fi::ScriptMode::IScriptBuild) {
 		asm_to_nes(m_in_file, m_out_file,
 			m_source_rom.empty() ? m_out_file : m_source_rom,
 			m_strict);
@@ -152,14 +270,54 @@ fi::Cli::Cli(int argc, char** argv) :
 	// debug
 	else if (m_script_mode == fi::ScriptMode::DumpConfig)
 		dump_config(m_in_file, m_out_file);
+	// full extraction
+	else if (m_script_mode == fi::ScriptMode::ExtractAll)
+		extract_all(m_in_file, m_out_file, m_overwrite);
+	// regression corpus
+	else if (m_script_mode == fi::ScriptMode::Corpus)
+		corpus(m_in_file, m_out_file);
+	// batch build
+	else if (m_script_mode == fi::ScriptMode::Batch)
+		batch_to_nes(m_in_file, m_out_file, m_source_rom.empty() ? m_out_file : m_source_rom);
+	// resident mode
+	else if (m_script_mode == fi::ScriptMode::Serve)
+		serve(m_in_file, m_out_file);
 	// can't really happen
 	else
 		throw(std::runtime_error("Invalid script mode"));
 }
 
-static void try_patch_msg(const std::string& p_data_type,
+void fi::Cli::report_profile(void) const {
+	// the report files are written after the snapshot, so they are not part of it
+	const auto l_summary_json{ klib::prof::summary_json() };
+	const auto l_trace_json{ klib::prof::trace_json() };
+
+	if (m_profile)
+		*m_out << "\nProfile:\n" << klib::prof::summary_table();
+
+	if (!m_profile_json.empty()) {
+		klib::file::write_string_to_file(l_summary_json, m_profile_json);
+		*m_out << "Wrote profile to " << m_profile_json << "\n";
+	}
+
+	if (!m_trace_file.empty()) {
+		klib::file::write_string_to_file(l_trace_json, m_trace_file);
+		*m_out << "Wrote trace events to " << m_trace_file << "\n";
+	}
+}
+
+void fi::Cli::flush_profile(void) const {
+	if (klib::prof::is_enabled()) {
+		report_profile();
+		klib::prof::clear();
+	}
+}
+
+void fi::Cli::try_patch_msg(const std::string& p_data_type,
 	std::size_t p_data_size, std::size_t p_data_max_size) {
-	std::cout << std::format("Trying to patch {}: Using {} of {} available bytes ({:.2f}%)\n",
+	m_patch_usage.push_back(fi::PatchUsage{ p_data_type, p_data_size, p_data_max_size });
+
+	*m_out << std::format("Trying to patch {}: Using {} of {} available bytes ({:.2f}%)\n",
 		p_data_type, p_data_size, p_data_max_size,
 		100.0f * static_cast<float>(p_data_size) / static_cast<float>(p_data_max_size));
 	if (p_data_size > p_data_max_size)
@@ -172,29 +330,27 @@ void fi::Cli::asm_to_nes(const std::string& p_asm_filename,
 	const std::string& p_source_rom_filename,
 	bool p_strict) {
 
-	if (p_strict)
-		std::cout << "Using strict mode - Only original ROM data region will be used\n";
+	auto rom{ load_rom_and_determine_region(p_source_rom_filename) };
 
-	fi::AsmReader reader;
+	if (!patch_iscripts(rom, p_asm_filename, p_strict))
+		return;
 
-	std::cout << "Attempting to read ROM contents from " << p_source_rom_filename << "\n";
-	auto rom{ klib::file::read_file_as_bytes(p_source_rom_filename) };
+	write_rom_file(rom, p_out_filename);
+}
 
-	if (m_region.empty()) {
-		m_config.determine_region(rom);
-		std::cout << "ROM region resolved to '" << m_config.get_region() << "'\n";
-	}
-	else {
-		m_config.set_region(m_region);
-		std::cout << "ROM region specified as '" << m_region << "'\n";
-	}
+bool fi::Cli::patch_iscripts(klib::RomImage& rom,
+	const std::string& p_asm_filename, bool p_strict) {
+
+	if (p_strict)
+		*m_out << "Using strict mode - Only original ROM data region will be used\n";
+
+	const auto& opcode_defs{ load_iscript_opcodes() };
+	fi::AsmReader reader(opcode_defs.opcodes);
 
-	m_config.load_config_data(appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME, rom);
-	auto opcode_defs{ fi::load_iscript_opcodes_from_config(m_config.bmap_dense(fi::c::ID_ISCRIPT_OPCODES),
-		m_config.str_map(fi::c::ID_ISCRIPT_OPCODE_IMPLS)) };
 	std::size_t l_iscript_rg2_start{ m_config.constant(c::ID_ISCRIPT_RG2_START) };
 
 	if (!opcode_defs.required_impls.empty()) {
+		klib::prof::Scope l_prof("install script library");
 		fh::HackManager hack_mgr;
 
 		if (p_strict)
@@ -213,21 +369,36 @@ void fi::Cli::asm_to_nes(const std::string& p_asm_filename,
 
 		const auto l_iscript_rg2_start_new{ hack_mgr.apply_script_library(m_config, rom,
 			l_iscript_rg2_start, required_libs, opcode_defs.base_opcode_count) };
+		l_prof.count("bytes", l_iscript_rg2_start_new - l_iscript_rg2_start);
 
-		std::cout << "Installed new script library routines (" <<
+		*m_out << "Installed new script library routines (" <<
 			(l_iscript_rg2_start_new - l_iscript_rg2_start) << " bytes)\n";
 
 		l_iscript_rg2_start = l_iscript_rg2_start_new;
 	}
 
-	std::cout << "Attempting to parse assembly file " << p_asm_filename << "\n";
-	reader.read_asm_file(m_config, p_asm_filename, l_iscript_rg2_start);
+	*m_out << "Attempting to parse assembly file " << p_asm_filename << "\n";
+	{
+		klib::prof::Scope l_prof("parse iscripts");
+		reader.read_asm_file(m_config, p_asm_filename, l_iscript_rg2_start);
+		l_prof.count("instructions", reader.get_instruction_count());
+		l_prof.count("strings", reader.get_string_count());
+		l_prof.count("entrypoints", reader.get_entrypoint_count());
+	}
+
+	std::pair<std::vector<byte>, std::vector<byte>> bytes;
+	std::vector<byte> strbytes;
+	{
+		klib::prof::Scope l_prof("link iscripts");
+
+		// we use different methods to get the ROM bytes if the smart linker is used
+		bytes = reader.get_script_bytes(m_config);
+		strbytes = reader.get_string_bytes(m_config);
 
-	// we use different methods to get the ROM bytes if the smart linker is used
-	auto bytes{ reader.get_script_bytes(m_config) };
-	auto strbytes{ reader.get_string_bytes(m_config) };
+		l_prof.count("bytes", bytes.first.size() + bytes.second.size() + strbytes.size());
+	}
 
-	std::cout << std::format("Using {} unique strings out of a maximum of 255\n",
+	*m_out << std::format("Using {} unique strings out of a maximum of 255\n",
 		reader.get_string_count());
 
 	// extract constants we need from config
@@ -248,62 +419,54 @@ void fi::Cli::asm_to_nes(const std::string& p_asm_filename,
 
 	if (p_strict && !bytes.second.empty())
 		throw std::runtime_error("Strict mode was enabled but the original ROM region could not fit all data");
+	else if (m_check)
+		return true;
 
-	for (std::size_t i{ 0 }; i < bytes.first.size(); ++i)
-		rom.at(i + l_iscript_ptr.first) = bytes.first[i];
+	const std::size_t l_iscript_rg2_offset{ !p_strict ?
+		l_iscript_rg2_start : l_iscript_ptr.first + bytes.first.size() };
 
-	for (std::size_t i{ 0 }; i < bytes.second.size(); ++i)
-		rom.at(i + (
-			!p_strict ?
-			l_iscript_rg2_start : l_iscript_ptr.first + bytes.first.size()
-			)) = bytes.second[i];
+	klib::patch::write(rom, l_iscript_ptr.first, bytes.first);
+	klib::patch::write(rom, l_iscript_rg2_offset, bytes.second);
 
-	for (std::size_t i{ 0 }; i < strbytes.size(); ++i)
-		rom.at(i + l_iscript_string_start) = strbytes[i];
+	klib::patch::write(rom, l_iscript_string_start, strbytes);
 	// make the rest of the string section unparseable so we don't
 	// accidentally import any garbage strings from the file we emit
-	for (std::size_t i{ strbytes.size() }; i < l_iscript_string_size; ++i)
-		rom.at(i + l_iscript_string_start) = 0x00;
+	if (strbytes.size() < l_iscript_string_size)
+		klib::patch::fill(rom, l_iscript_string_start + strbytes.size(),
+			l_iscript_string_size - strbytes.size(), 0x00);
 
 	// finally patch the ref to the hi pointers
 	std::size_t l_hi_byte_addr_bank_rel{ l_iscript_ptr.first + reader.get_entrypoint_count() - l_iscript_ptr.second };
 	std::size_t l_rom_offset_hi_byte_ref{ m_config.constant(c::ID_ISCRIPT_PTR_HI_REF_OFFSET) };
 
-	rom.at(l_rom_offset_hi_byte_ref) = static_cast<byte>(l_hi_byte_addr_bank_rel % 256);
-	rom.at(l_rom_offset_hi_byte_ref + 1) = static_cast<byte>(l_hi_byte_addr_bank_rel / 256);
+	const byte l_hi_byte_ref[]{ static_cast<byte>(l_hi_byte_addr_bank_rel % 256),
+		static_cast<byte>(l_hi_byte_addr_bank_rel / 256) };
+	klib::patch::write(rom, l_rom_offset_hi_byte_ref, l_hi_byte_ref);
 
 	// compile tilemap changes if applicable
 	const auto& tmchanges{ reader.get_tilemap_changes() };
 	if (!tmchanges.empty()) {
+		klib::prof::Scope l_prof("install tilemap changes");
 		fh::HackManager hack_mgr;
 		std::size_t tmsub_size{ hack_mgr.apply_tilemap_change_subsystem(m_config, rom, tmchanges) };
-		std::cout << "Installed tilemap change subsystem (" << tmsub_size << " bytes)\n";
+		l_prof.count("bytes", tmsub_size);
+		*m_out << "Installed tilemap change subsystem (" << tmsub_size << " bytes)\n";
 	}
 
 	// bank 15 could have been mutated by hacks - duplicate to bank 31 post-patch for expanded roms
-	if (m_config.boolean_or(ID_DUPLICATE_STATIC_BANK, false)) {
-		constexpr std::size_t BANK_BYTE_SIZE{ 0x4000 };
-		std::size_t source_idx{ 0x10 + BANK_BYTE_SIZE * 0x0f };
-		std::size_t target_idx{ 0x10 + BANK_BYTE_SIZE * 0x1f };
-
-		for (std::size_t i{ 0 }; i < BANK_BYTE_SIZE; ++i)
-			rom.at(target_idx + i) = rom[source_idx + i];
+	duplicate_static_bank(rom);
 
-		std::cout << "Bank 15 was duplicated to bank 31 post-patch\n";
-	}
-
-	std::cout << "Verifying generated ROM contents\n";
+	*m_out << "Verifying generated ROM contents\n";
 	try {
-		fi::IScriptLoader staticanalysisread(rom);
+		klib::prof::Scope l_prof("verify iscripts");
+		reader.verify_rom(m_config, rom, l_iscript_rg2_start);
 	}
-	catch (const std::runtime_error& ex) {
-		std::cerr << "Invalid ROM generated. Ensure all code paths end, and that each entrypoint has a textbox context\n" << ex.what();
-		return;
+	catch (const std::exception& ex) {
+		*m_err << "Invalid ROM generated. Ensure all code paths end, and that each entrypoint has a textbox context\n" << ex.what() << "\n";
+		return false;
 	}
 
-	std::cout << "Attempting to patch file " << p_out_filename << "\n";
-	klib::file::write_bytes_to_file(rom, p_out_filename);
-	std::cout << "File patched\n";
+	return true;
 }
 
 void fi::Cli::basm_to_nes(const std::string& p_basm_filename,
@@ -311,28 +474,33 @@ void fi::Cli::basm_to_nes(const std::string& p_basm_filename,
 	const std::string& p_source_rom_filename,
 	bool p_strict) {
 
-	if (p_strict)
-		std::cout << "Using strict mode - Only original ROM data region will be used\n";
+	auto rom{ load_rom_and_determine_region(p_source_rom_filename) };
 
-	std::cout << "Attempting to read ROM contents from " << p_source_rom_filename << "\n";
-	auto rom{ klib::file::read_file_as_bytes(p_source_rom_filename) };
+	if (!patch_bscripts(rom, p_basm_filename, p_strict))
+		return;
 
-	if (m_region.empty()) {
-		m_config.determine_region(rom);
-		std::cout << "ROM region resolved to '" << m_config.get_region() << "'\n";
-	}
-	else {
-		m_config.set_region(m_region);
-		std::cout << "ROM region specified as '" << m_region << "'\n";
-	}
+	write_rom_file(rom, p_nes_filename);
+}
 
-	m_config.load_config_data(appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME, rom);
+bool fi::Cli::patch_bscripts(klib::RomImage& rom,
+	const std::string& p_basm_filename, bool p_strict) {
+
+	if (p_strict)
+		*m_out << "Using strict mode - Only original ROM data region will be used\n";
 
 	fb::BScriptReader reader(m_config);
-	reader.read_asm_file(p_basm_filename, m_config);
+	{
+		klib::prof::Scope l_prof("parse bscripts");
+		reader.read_asm_file(p_basm_filename, m_config);
+	}
 
-	const auto bytes{ reader.to_bytes() };
-	std::cout << "Total script byte size (including ptr table): " <<
+	std::pair<std::vector<byte>, std::vector<byte>> bytes;
+	{
+		klib::prof::Scope l_prof("link bscripts");
+		bytes = reader.to_bytes();
+		l_prof.count("bytes", bytes.first.size() + bytes.second.size());
+	}
+	*m_out << "Total script byte size (including ptr table): " <<
 		(bytes.first.size() + bytes.second.size()) << "\n";
 
 	auto bscriptptr{ m_config.pointer(fb::c::ID_BSCRIPT_PTR) };
@@ -349,95 +517,713 @@ void fi::Cli::basm_to_nes(const std::string& p_basm_filename,
 
 	if (p_strict && !bytes.second.empty())
 		throw std::runtime_error("Strict mode was enabled but the original ROM region could not fit all data");
+	else if (m_check)
+		return true;
 
 	clear_rom_section(rom, bscriptptr.first, l_bscript_rg1_end);
 	if (!p_strict)
 		clear_rom_section(rom, l_rg2_start, l_rg2_end);
 
-	for (std::size_t i{ 0 }; i < bytes.first.size(); ++i)
-		rom.at(bscriptptr.first + i) = bytes.first[i];
-
-	for (std::size_t i{ 0 }; i < bytes.second.size(); ++i)
-		rom.at(l_rg2_start + i) = bytes.second[i];
+	klib::patch::write(rom, bscriptptr.first, bytes.first);
+	klib::patch::write(rom, l_rg2_start, bytes.second);
 
-	std::cout << "Verifying generated ROM contents\n";
+	*m_out << "Verifying generated ROM contents\n";
 	try {
-		fb::BScriptLoader staticanalysisread(m_config, rom);
+		klib::prof::Scope l_prof("verify bscripts");
+		reader.verify_rom(rom);
 	}
-	catch (const std::runtime_error& ex) {
-		std::cerr << "Invalid ROM generated. Ensure all code paths end\n" << ex.what();
-		return;
+	catch (const std::exception& ex) {
+		*m_err << "Invalid ROM generated. Ensure all code paths end\n" << ex.what() << "\n";
+		return false;
 	}
 
-	std::cout << "Attempting to patch file " << p_nes_filename << "\n";
-	klib::file::write_bytes_to_file(rom, p_nes_filename);
-	std::cout << "File patched\n";
+	return true;
 }
 
 void fi::Cli::masm_to_nes(const std::string& p_mml_filename,
 	const std::string& p_nes_filename,
 	const std::string& p_source_rom_filename) {
 
-	std::cout << "Attempting to read ROM contents from " << p_source_rom_filename << "\n";
-	auto rom{ klib::file::read_file_as_bytes(p_source_rom_filename) };
+	auto rom{ load_rom_and_determine_region(p_source_rom_filename) };
 
-	if (m_region.empty()) {
-		m_config.determine_region(rom);
-		std::cout << "ROM region resolved to '" << m_config.get_region() << "'\n";
-	}
-	else {
-		m_config.set_region(m_region);
-		std::cout << "ROM region specified as '" << m_region << "'\n";
-	}
+	patch_mscripts(rom, p_mml_filename);
 
-	m_config.load_config_data(appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME, rom);
+	write_rom_file(rom, p_nes_filename);
+}
 
+void fi::Cli::patch_mscripts(klib::RomImage& rom, const std::string& p_mml_filename) {
 	fm::MMLReader reader(m_config);
 
-	std::cout << "Attempting to parse assembly file " << p_mml_filename << "\n";
-	reader.read_mml_file(p_mml_filename, m_config);
+	*m_out << "Attempting to parse assembly file " << p_mml_filename << "\n";
+	{
+		klib::prof::Scope l_prof("parse mscripts");
+		reader.read_mml_file(p_mml_filename, m_config);
+	}
 
+	klib::prof::Scope l_link_prof("link mscripts");
 	auto bytes{ reader.get_bytes() };
+	l_link_prof.count("bytes", bytes.size());
 
 	const auto& musicptr{ m_config.pointer(fm::c::ID_MUSIC_PTR) };
 
 	try_patch_msg("Music", bytes.size(),
 		m_config.constant(fm::c::ID_MUSIC_DATA_END) - musicptr.first);
 
-	for (std::size_t i{ 0 }; i < bytes.size(); ++i)
-		rom.at(musicptr.first + i) = bytes[i];
-
-	std::cout << "Attempting to patch file " << p_nes_filename << "\n";
-	klib::file::write_bytes_to_file(rom, p_nes_filename);
-	std::cout << "File patched\n";
+	if (!m_check)
+		klib::patch::write(rom, musicptr.first, bytes);
 }
 
 void fi::Cli::misc_to_nes(const std::string& p_txt_filename,
 	const std::string& p_nes_filename,
 	const std::string& p_source_rom_filename) {
 	auto rom{ load_rom_and_determine_region(p_source_rom_filename) };
+
+	*m_out << "Attempting to ptach " << p_nes_filename << "\n";
+	int itemcnt{ patch_misc(rom, p_txt_filename) };
+
+	const auto& l_out_filename{ m_patch_file.empty() ? p_nes_filename : m_patch_file };
+
+	if (save_rom(rom, p_nes_filename))
+		*m_out << std::format("Misc data ({} items) written to file ", itemcnt) << l_out_filename << "!\n";
+	else
+		*m_out << std::format("Misc data ({} items) already in file ", itemcnt) << l_out_filename << ", file unchanged\n";
+}
+
+int fi::Cli::patch_misc(klib::RomImage& rom, const std::string& p_txt_filename) {
 	fv::MiscWriter reader(rom, m_config);
 
-	std::cout << "Attempting to parse " << p_txt_filename << "\n";
-	reader.load_txt_file(p_txt_filename);
+	*m_out << "Attempting to parse " << p_txt_filename << "\n";
+	{
+		klib::prof::Scope l_prof("parse misc data");
+		reader.load_txt_file(p_txt_filename);
+	}
 
-	std::cout << "Attempting to ptach " << p_nes_filename << "\n";
+	klib::prof::Scope l_patch_prof("patch misc data");
 	int itemcnt{ reader.patch_rom(rom, m_config) };
+	l_patch_prof.count("items", static_cast<std::size_t>(itemcnt));
+	*m_out << std::format("Patched {} misc data items\n", itemcnt);
 
 	// bank 15 was mutated - duplicate to bank 31 post-patch for expanded roms
-	if (m_config.boolean_or(ID_DUPLICATE_STATIC_BANK, false)) {
-		constexpr std::size_t BANK_BYTE_SIZE{ 0x4000 };
-		std::size_t source_idx{ 0x10 + BANK_BYTE_SIZE * 0x0f };
-		std::size_t target_idx{ 0x10 + BANK_BYTE_SIZE * 0x1f };
+	duplicate_static_bank(rom);
+
+	return itemcnt;
+}
+
+bool fi::Cli::run_build_stage(klib::RomImage& rom, fi::ScriptMode p_mode,
+	const std::string& p_filename) {
+	if (p_mode == fi::ScriptMode::IScriptBuild)
+		return patch_iscripts(rom, p_filename, m_strict);
+	else if (p_mode == fi::ScriptMode::BScriptBuild)
+		return patch_bscripts(rom, p_filename, m_strict);
+	else if (p_mode == fi::ScriptMode::MScriptBuild)
+		patch_mscripts(rom, p_filename);
+	else if (p_mode == fi::ScriptMode::MmlBuild)
+		patch_mml(rom, p_filename);
+	else if (p_mode == fi::ScriptMode::MiscBuild)
+		patch_misc(rom, p_filename);
+	else
+		throw std::runtime_error("Invalid build stage");
+
+	return true;
+}
+
+void fi::Cli::run_extract_stage(klib::RomView rom, fi::ScriptMode p_mode,
+	const std::string& p_filename) {
+	// fail early if output file already exists and we do not overwrite
+	if (!m_overwrite && klib::file::file_exists(p_filename))
+		throw std::runtime_error(std::format("Output file {} exists, and overwrite-flag is not set", p_filename));
+
+	if (p_mode == fi::ScriptMode::IScriptExtract)
+		extract_iscripts(rom, p_filename, m_shop_comments);
+	else if (p_mode == fi::ScriptMode::BScriptExtract)
+		extract_bscripts(rom, p_filename);
+	else if (p_mode == fi::ScriptMode::MScriptExtract)
+		extract_mscripts(rom, p_filename);
+	else if (p_mode == fi::ScriptMode::MmlExtract)
+		extract_mml(rom, p_filename);
+	else if (p_mode == fi::ScriptMode::MiscExtract)
+		extract_misc(rom, p_filename);
+	else
+		throw std::runtime_error("Invalid extraction stage");
+}
+
+void fi::Cli::watch_build(fi::ScriptMode p_mode,
+	const std::string& p_in_filename,
+	const std::string& p_nes_filename,
+	const std::string& p_source_rom_filename) {
+	constexpr auto POLL_INTERVAL{ std::chrono::milliseconds(250) };
+
+	// every rebuild starts from the pristine source image, not from our own output
+	const auto source_rom{ load_rom_and_determine_region(p_source_rom_filename) };
+
+	// the input file first, then the config files
+	const std::vector<std::string> watched_files{ p_in_filename,
+		appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME };
+
+	const auto get_timestamps{ [&watched_files]() {
+		std::vector<std::filesystem::file_time_type> result;
+		for (const auto& filename : watched_files)
+			result.push_back(klib::file::last_write_time(filename));
+		return result;
+	} };
+
+	const auto rebuild{ [&]() {
+		m_patch_usage.clear();
+
+		try {
+			auto rom{ source_rom };
+			// the patch source is still the mapped source file, but earlier rebuilds
+			// may have written the output outside of this journal
+			m_journal.clear();
+			m_journal_base.clear();
+
+			if (run_build_stage(rom, p_mode, p_in_filename)) {
+				write_rom_file(rom, p_nes_filename);
+			}
+		}
+		catch (const std::exception& ex) {
+			*m_err << "Build failed: " << ex.what() << "\n";
+		}
+
+		flush_profile();
+	} };
+
+	auto timestamps{ get_timestamps() };
+	rebuild();
+
+	*m_out << std::format("\nWatching {} for changes (press Ctrl+C to stop)\n", p_in_filename);
+
+	while (true) {
+		std::this_thread::sleep_for(POLL_INTERVAL);
+
+		auto new_timestamps{ get_timestamps() };
+		if (new_timestamps == timestamps)
+			continue;
+
+		// editors often save in several steps - wait until the files settle
+		for (auto settled{ get_timestamps() }; settled != new_timestamps; settled = get_timestamps()) {
+			new_timestamps = settled;
+			std::this_thread::sleep_for(POLL_INTERVAL);
+		}
+
+		// only reload the configuration if one of the xml files changed
+		const bool l_config_changed{ !std::equal(begin(timestamps) + 1, end(timestamps),
+			begin(new_timestamps) + 1) };
+		timestamps = new_timestamps;
+
+		if (l_config_changed) {
+			*m_out << "\nConfiguration changed - reloading\n";
+
+			try {
+				reload_config(source_rom);
+			}
+			catch (const std::exception& ex) {
+				*m_err << "Configuration reload failed, keeping the previous configuration: " << ex.what() << "\n";
+				flush_profile();
+				continue;
+			}
+		}
+		else
+			*m_out << "\nChange detected in " << p_in_filename << " - rebuilding\n";
+
+		rebuild();
+	}
+}
+
+void fi::Cli::check_build(fi::ScriptMode p_mode,
+	const std::string& p_in_filename,
+	const std::string& p_source_rom_filename) {
+	std::vector<std::string> l_diagnostics;
+
+	const auto add_diagnostic{ [&l_diagnostics](const std::string& p_message,
+		std::size_t p_line, std::size_t p_column) {
+		l_diagnostics.push_back(std::format(
+			"{{ \"severity\": \"error\", \"line\": {}, \"column\": {}, \"message\": \"{}\" }}",
+			p_line, p_column, klib::str::json_escape(p_message)));
+	} };
+
+	// the stage runs against a private copy of the ROM, and stops before patching it
+	try {
+		auto rom{ load_rom_and_determine_region(p_source_rom_filename) };
+		run_build_stage(rom, p_mode, p_in_filename);
+	}
+	catch (const klib::str::ParseError& ex) {
+		add_diagnostic(ex.message(), ex.line(), ex.column());
+	}
+	catch (const std::exception& ex) {
+		add_diagnostic(ex.what(), 0, 0);
+	}
+
+	std::cout << get_check_json(p_in_filename, l_diagnostics) << std::flush;
+}
+
+std::string fi::Cli::get_check_json(const std::string& p_filename,
+	const std::vector<std::string>& p_diagnostics) const {
+	std::string result{ std::format("{{\n  \"file\": \"{}\",\n  \"ok\": {},\n  \"diagnostics\": [",
+		klib::str::json_escape(p_filename), p_diagnostics.empty() ? "true" : "false") };
+
+	for (std::size_t i{ 0 }; i < p_diagnostics.size(); ++i)
+		result += std::format("{}\n    {}", i == 0 ? "" : ",", p_diagnostics[i]);
+
+	result += p_diagnostics.empty() ? "],\n  \"usage\": [" : "\n  ],\n  \"usage\": [";
+
+	for (std::size_t i{ 0 }; i < m_patch_usage.size(); ++i) {
+		const auto& usage{ m_patch_usage[i] };
+
+		result += std::format("{}\n    {{ \"data\": \"{}\", \"size\": {}, \"max_size\": {} }}",
+			i == 0 ? "" : ",", klib::str::json_escape(usage.data_type), usage.size, usage.max_size);
+	}
+
+	result += m_patch_usage.empty() ? "]\n}\n" : "\n  ]\n}\n";
+
+	return result;
+}
+
+void fi::Cli::batch_to_nes(const std::string& p_manifest_filename,
+	const std::string& p_nes_filename,
+	const std::string& p_source_rom_filename) {
+
+	// parse the whole manifest up front so we fail before touching the ROM
+	*m_out << "Attempting to parse batch manifest " << p_manifest_filename << "\n";
+	const auto stages{ parse_batch_manifest(p_manifest_filename) };
+
+	if (stages.empty())
+		throw std::runtime_error(std::format("Batch manifest {} contains no build stages", p_manifest_filename));
+
+	auto rom{ load_rom_and_determine_region(p_source_rom_filename) };
+
+	// index of the first size report belonging to each stage
+	std::vector<std::size_t> stage_usage_start;
+
+	for (std::size_t i{ 0 }; i < stages.size(); ++i) {
+		const auto& [mode, filename] { stages[i] };
+		*m_out << std::format("\nBatch stage {} of {}: {}\n", i + 1, stages.size(), filename);
+
+		stage_usage_start.push_back(m_patch_usage.size());
+		m_journal.begin_stage();
+
+		if (!run_build_stage(rom, mode, filename)) {
+			*m_err << std::format("\nBatch stage {} failed - {} was not patched\n", i + 1, p_nes_filename);
+			return;
+		}
+	}
+
+	*m_out << "\nBatch summary:\n";
+	for (std::size_t i{ 0 }; i < stages.size(); ++i) {
+		*m_out << std::format("  Stage {}: {}\n", i + 1, stages[i].second);
+
+		std::size_t l_usage_end{ i + 1 < stages.size() ?
+			stage_usage_start[i + 1] : m_patch_usage.size() };
+
+		for (std::size_t j{ stage_usage_start[i] }; j < l_usage_end; ++j) {
+			const auto& usage{ m_patch_usage[j] };
+			*m_out << std::format("    {}: {} of {} bytes ({:.2f}%)\n",
+				usage.data_type, usage.size, usage.max_size,
+				100.0f * static_cast<float>(usage.size) / static_cast<float>(usage.max_size));
+		}
+	}
+
+	for (const auto& overlap : m_journal.overlaps())
+		*m_err << std::format("Warning: stage {} ({}) overwrote {} bytes in {} range(s) from offset 0x{:x} written by stage {} ({})\n",
+			overlap.second_stage + 1, stages[overlap.second_stage].second, overlap.size, overlap.range_count,
+			overlap.offset, overlap.first_stage + 1, stages[overlap.first_stage].second);
+
+	*m_out << "\n";
+	write_rom_file(rom, p_nes_filename);
+}
+
+std::vector<std::pair<fi::ScriptMode, std::string>> fi::Cli::parse_batch_manifest(
+	const std::string& p_manifest_filename) const {
+	std::vector<std::pair<fi::ScriptMode, std::string>> result;
+
+	const auto lines{ klib::file::read_file_as_strings(p_manifest_filename) };
+
+	for (std::size_t i{ 0 }; i < lines.size(); ++i) {
+		const auto stage{ parse_stage_command(lines[i]) };
+		if (stage.first.empty())
+			continue;
+
+		fi::ScriptMode mode;
+
+		try {
+			mode = get_mode(stage.first);
+		}
+		catch (const std::runtime_error& ex) {
+			throw std::runtime_error(std::format("Batch manifest line {}: {}", i + 1, ex.what()));
+		}
+
+		if (!is_build_mode(mode))
+			throw std::runtime_error(std::format("Batch manifest line {}: '{}' is not a build command", i + 1, stage.first));
+		else if (stage.second.empty())
+			throw std::runtime_error(std::format("Batch manifest line {}: missing input file", i + 1));
+
+		result.push_back(std::make_pair(mode, stage.second));
+	}
+
+	return result;
+}
+
+// split a manifest or serve line into (command, file argument)
+std::pair<std::string, std::string> fi::Cli::parse_stage_command(const std::string& p_line) const {
+	const std::string line{ klib::str::trim(klib::str::strip_comment(p_line)) };
+
+	// first token is the command, the rest of the line is the file argument
+	const auto cmd_end{ line.find_first_of(" \t") };
+	if (cmd_end == std::string::npos)
+		return std::make_pair(line, std::string());
+
+	std::string filename{ klib::str::trim(line.substr(cmd_end)) };
+	if (filename.size() >= 2 && filename.front() == '"' && filename.back() == '"')
+		filename = filename.substr(1, filename.size() - 2);
+
+	return std::make_pair(line.substr(0, cmd_end), filename);
+}
+
+void fi::Cli::serve(const std::string& p_source_rom_filename,
+	const std::string& p_nes_filename) {
+
+	// replies are line-framed, so everything the stages print is captured and
+	// relayed as @log lines, and error messages are kept on one line
+	std::ostream* l_out{ m_out };
+	std::ostream* l_err{ m_err };
+	std::ostringstream l_log;
+	m_out = &l_log;
+	m_err = &l_log;
+
+	const auto flush_log{ [&]() {
+		std::istringstream l_lines(l_log.str());
+		std::string l_line;
+		while (std::getline(l_lines, l_line))
+			*l_out << appc::SERVE_RESPONSE_LOG << " " << l_line << "\n";
+		l_log.str(std::string());
+	} };
+
+	const auto escape_line{ [](std::string_view p_text) {
+		std::string result;
+		for (char c : p_text) {
+			if (c == '\\')
+				result += "\\\\";
+			else if (c == '\n')
+				result += "\\n";
+			else if (c == '\r')
+				result += "\\r";
+			else
+				result += c;
+		}
+		return result;
+	} };
+
+	try {
+		// the resolved config, opcode tables and working ROM image stay resident between requests
+		auto rom{ load_rom_and_determine_region(p_source_rom_filename) };
+		flush_profile();
+		flush_log();
+		*l_out << appc::SERVE_RESPONSE_OK << std::endl;
+
+		std::string line;
+		while (std::getline(std::cin, line)) {
+			const auto request{ parse_stage_command(line) };
+			if (request.first.empty())
+				continue;
+			else if (request.first == appc::SERVE_CMD_QUIT)
+				break;
+
+			m_patch_usage.clear();
+
+			try {
+				if (request.first == appc::SERVE_CMD_RELOAD) {
+					*m_out << "Attempting to read " << p_source_rom_filename << "\n";
+					rom = klib::file::map_rom_image(p_source_rom_filename);
+					start_journal(rom, p_source_rom_filename);
+					reload_config(rom);
+				}
+				else {
+					const auto mode{ get_mode(request.first) };
+
+					if (request.second.empty())
+						throw std::runtime_error(std::format("Missing file argument for command '{}'", request.first));
+
+					if (is_build_mode(mode)) {
+						// patch a copy so a failed stage leaves the working image untouched
+						auto l_rom{ rom };
+
+						if (!run_build_stage(l_rom, mode, request.second))
+							throw std::runtime_error("Invalid ROM generated - output file was not patched");
+
+						rom = std::move(l_rom);
+
+						write_rom_file(rom, p_nes_filename);
+					}
+					else if (is_extract_mode(mode))
+						run_extract_stage(rom, mode, request.second);
+					else
+						throw std::runtime_error(std::format("Command '{}' is not supported in serve mode", request.first));
+				}
+
+				flush_profile();
+				flush_log();
+
+				for (const auto& usage : m_patch_usage)
+					*l_out << std::format("{} {} {} {}\n", appc::SERVE_RESPONSE_USAGE,
+						usage.size, usage.max_size, usage.data_type);
+
+				*l_out << appc::SERVE_RESPONSE_OK << std::endl;
+			}
+			catch (const std::exception& ex) {
+				flush_profile();
+				flush_log();
+				*l_out << appc::SERVE_RESPONSE_ERROR << " " << escape_line(ex.what()) << std::endl;
+			}
+		}
+	}
+	catch (...) {
+		flush_log();
+		m_out = l_out;
+		m_err = l_err;
+		throw;
+	}
+
+	m_out = l_out;
+	m_err = l_err;
+}
+
+void fi::Cli::extract_all(const std::string& p_nes_filename,
+	const std::string& p_out_file_prefix, bool p_overwrite) {
+
+	std::vector<std::string> filenames;
+	for (const auto& output : EXTRACT_ALL_OUTPUTS)
+		filenames.push_back(std::format("{}.{}", p_out_file_prefix, output.first));
+
+	// fail early if any output file already exists and we do not overwrite
+	if (!p_overwrite)
+		for (const auto& filename : filenames)
+			if (klib::file::file_exists(filename))
+				throw std::runtime_error(std::format("Output file {} exists, and overwrite-flag is not set", filename));
+
+	const auto rom_file{ map_rom_and_determine_region(p_nes_filename) };
+	const klib::RomView rom_data{ rom_file.bytes() };
+
+	// the decoders only read the shared ROM image and config, so they can run side by side
+	*m_out << "Extracting iScripts, bScripts, MML and misc data in parallel\n";
+
+	auto stages{ start_extraction(rom_data, std::launch::async) };
+
+	// wait for every stage before writing anything
+	std::vector<std::string> outputs;
+	std::string errors;
+
+	for (std::size_t i{ 0 }; i < stages.size(); ++i) {
+		try {
+			outputs.push_back(stages[i].get());
+		}
+		catch (const std::exception& ex) {
+			errors += std::format("\n  {}: {}", filenames[i], ex.what());
+		}
+	}
+
+	if (!errors.empty())
+		throw std::runtime_error("Extraction failed, no files were written:" + errors);
+
+	for (std::size_t i{ 0 }; i < outputs.size(); ++i) {
+		if (klib::file::write_string_to_file(outputs[i], filenames[i]))
+			*m_out << "Wrote " << filenames[i] << "!\n";
+		else
+			*m_out << filenames[i] << " unchanged\n";
+	}
+
+	*m_out << "Extraction complete!\n";
+}
+
+// one future per entry in EXTRACT_ALL_OUTPUTS; the image viewed by p_rom_data must outlive them
+std::vector<std::future<std::string>> fi::Cli::start_extraction(
+	klib::RomView p_rom_data, std::launch p_policy) {
+
+	// populate the opcode table before any worker reads it
+	const auto& opcodes{ load_iscript_opcodes().opcodes };
+
+	std::vector<std::future<std::string>> result;
+
+	result.push_back(std::async(p_policy, [this, p_rom_data, &opcodes]() {
+		klib::prof::Scope l_prof("extract iscripts");
+		fi::IScriptLoader loader(p_rom_data, opcodes);
+		loader.parse_rom(m_config, m_iscript_workers);
+		l_prof.count("instructions", loader.m_instructions.size());
+		l_prof.count("strings", loader.m_strings.size());
+
+		fi::AsmWriter asmw(opcodes);
+		return asmw.get_asm_string(m_config,
+			loader.m_instructions, loader.ptr_table, loader.m_jump_targets,
+			loader.m_strings, loader.m_shops, m_shop_comments);
+		}));
+
+	result.push_back(std::async(p_policy, [this, p_rom_data]() {
+		klib::prof::Scope l_prof("extract bscripts");
+		fb::BScriptLoader loader(m_config, p_rom_data);
+		loader.parse_rom();
+		l_prof.count("instructions", loader.m_instrs.size());
+
+		fb::BScriptWriter asmw(m_config);
+		return asmw.get_asm_string(loader);
+		}));
+
+	result.push_back(std::async(p_policy, [this, p_rom_data]() {
+		klib::prof::Scope l_prof("extract mml");
+		fm::MScriptLoader loader(m_config, p_rom_data);
+
+		fm::MMLSongCollection coll(get_global_transpose(p_rom_data));
+		coll.extract_bytecode_collection(loader);
+		l_prof.count("songs", coll.songs.size());
+		return coll.to_string();
+		}));
+
+	result.push_back(std::async(p_policy, [this, p_rom_data]() {
+		klib::prof::Scope l_prof("extract misc data");
+		fv::MiscWriter writer(p_rom_data, m_config, m_strict);
+		writer.load_rom(p_rom_data, m_config);
+		return writer.get_txt_string();
+		}));
+
+	return result;
+}
+
+void fi::Cli::corpus(const std::string& p_rom_directory,
+	const std::string& p_out_directory) {
+
+	std::vector<std::string> rom_files;
+	for (const auto& entry : std::filesystem::directory_iterator(p_rom_directory))
+		if (entry.is_regular_file() &&
+			klib::str::to_lower(entry.path().extension().string()) == ".nes")
+			rom_files.push_back(entry.path().string());
+
+	std::sort(begin(rom_files), end(rom_files));
+
+	if (rom_files.empty())
+		throw std::runtime_error(std::format("No .nes files found in {}", p_rom_directory));
+
+	std::filesystem::create_directories(p_out_directory);
+
+	const std::size_t l_worker_count{ std::min<std::size_t>(rom_files.size(),
+		std::max(1u, std::thread::hardware_concurrency())) };
+
+	*m_out << std::format("Processing {} ROMs with {} workers\n", rom_files.size(), l_worker_count);
+
+	std::vector<fi::CorpusResult> results(rom_files.size());
+	std::atomic<std::size_t> next_rom{ 0 };
 
-		for (std::size_t i{ 0 }; i < BANK_BYTE_SIZE; ++i)
-			rom.at(target_idx + i) = rom[source_idx + i];
+	const auto worker{ [&]() {
+		for (std::size_t i{ next_rom++ }; i < rom_files.size(); i = next_rom++) {
+			const std::filesystem::path rom_path{ rom_files[i] };
+			const auto out_prefix{ (std::filesystem::path(p_out_directory) / rom_path.stem()).string() };
 
-		std::cout << "Bank 15 was duplicated to bank 31 post-patch\n";
+			// every job gets its own config, opcode tables and log
+			std::ostringstream log;
+			fi::Cli job(*this);
+			job.m_out = &log;
+			job.m_err = &log;
+			// share the cores left over when there are fewer ROMs than workers
+			job.m_iscript_workers = std::max<std::size_t>(1,
+				std::thread::hardware_concurrency() / l_worker_count);
+
+			results[i] = job.run_corpus_job(rom_files[i], out_prefix);
+			results[i].rom = rom_path.filename().string();
+
+			klib::file::write_string_to_file(log.str(), out_prefix + ".log");
+		}
+	} };
+
+	std::vector<std::thread> workers;
+	for (std::size_t i{ 0 }; i < l_worker_count; ++i)
+		workers.emplace_back(worker);
+	for (auto& thread : workers)
+		thread.join();
+
+	// summary table
+	std::string summary{ std::format("{:<40} {:<12}", "ROM", "Region") };
+	for (const auto& output : EXTRACT_ALL_OUTPUTS)
+		summary += std::format(" {:<14}", output.first);
+	summary += "\n";
+
+	std::string errors;
+	std::size_t l_identical_count{ 0 };
+
+	for (const auto& result : results) {
+		summary += std::format("{:<40} {:<12}", result.rom, result.region);
+		for (const auto& stage : result.stages)
+			summary += std::format(" {:<14}", stage);
+		summary += "\n";
+
+		if (result.error.empty())
+			++l_identical_count;
+		else
+			errors += std::format("{}: {}\n", result.rom, result.error);
+	}
+
+	summary += std::format("\n{} of {} ROMs round-tripped byte-identically\n",
+		l_identical_count, results.size());
+
+	if (!errors.empty())
+		summary += "\nIssues:\n" + errors;
+
+	const auto summary_file{ (std::filesystem::path(p_out_directory) / "corpus_summary.txt").string() };
+	klib::file::write_string_to_file(summary, summary_file);
+
+	*m_out << "\n" << summary << "\nSummary written to " << summary_file << "\n";
+}
+
+// extract all formats from one ROM, rebuild each of them against the
+// original ROM image and count how many bytes changed
+fi::CorpusResult fi::Cli::run_corpus_job(const std::string& p_rom_filename,
+	const std::string& p_out_prefix) {
+	fi::CorpusResult result;
+	result.stages.resize(EXTRACT_ALL_OUTPUTS.size(), "-");
+
+	klib::RomImage rom;
+
+	// the job was copied from the main CLI before any region was resolved,
+	// so its config still holds all region definitions
+	try {
+		rom = load_rom_and_determine_region(p_rom_filename);
+		result.region = m_config.get_region();
+	}
+	catch (const std::exception& ex) {
+		result.region = "unknown";
+		result.error = ex.what();
+		return result;
+	}
+
+	auto stages{ start_extraction(rom, std::launch::deferred) };
+
+	for (std::size_t i{ 0 }; i < stages.size(); ++i) {
+		const auto& [extension, mode] { EXTRACT_ALL_OUTPUTS[i] };
+		const auto filename{ std::format("{}.{}", p_out_prefix, extension) };
+
+		try {
+			klib::file::write_string_to_file(stages[i].get(), filename);
+
+			auto l_rom{ rom };
+			if (!run_build_stage(l_rom, mode, filename))
+				throw std::runtime_error("rebuilt ROM did not verify");
+
+			std::size_t l_diff_count{ 0 };
+			for (std::size_t j{ 0 }; j < rom.size(); ++j)
+				if (rom[j] != l_rom[j])
+					++l_diff_count;
+
+			result.stages[i] = (l_diff_count == 0 ? "identical" :
+				std::format("{} bytes", l_diff_count));
+
+			if (l_diff_count != 0 && result.error.empty())
+				result.error = std::format("{} round-trip changed {} bytes", extension, l_diff_count);
+		}
+		catch (const std::exception& ex) {
+			result.stages[i] = "FAILED";
+			if (result.error.empty())
+				result.error = std::format("{}: {}", extension, ex.what());
+			*m_err << "Stage " << extension << " failed: " << ex.what() << "\n";
+		}
 	}
 
-	klib::file::write_bytes_to_file(rom, p_nes_filename);
-	std::cout << std::format("Misc data ({} items) written to file ", itemcnt) << p_nes_filename << "!\n";
+	return result;
 }
 
 void fi::Cli::nes_to_asm(const std::string& p_nes_filename,
@@ -445,45 +1231,47 @@ void fi::Cli::nes_to_asm(const std::string& p_nes_filename,
 
 	// show params
 	if (p_shop_comments)
-		std::cout << "Will show shop data as comments where they are referenced\n";
+		*m_out << "Will show shop data as comments where they are referenced\n";
 	if (p_overwrite)
-		std::cout << "Will overwrite output assembly file if it already exists\n";
+		*m_out << "Will overwrite output assembly file if it already exists\n";
 
 	// fail early if asm file already exists and we do not overwrite
 	if (!p_overwrite && klib::file::file_exists(p_asm_filename))
 		throw std::runtime_error(std::format("Assembly file {} exists, and overwrite-flag is not set", p_asm_filename));
 
-	std::cout << "Attempting to read " << p_nes_filename << "\n";
-	const auto& rom_data{ klib::file::read_file_as_bytes(p_nes_filename) };
+	const auto rom_file{ map_rom_and_determine_region(p_nes_filename) };
+	const klib::RomView rom_data{ rom_file.bytes() };
 
-	if (m_region.empty()) {
-		m_config.determine_region(rom_data);
-		std::cout << "ROM region resolved to '" << m_config.get_region() << "'\n";
-	}
-	else {
-		m_config.set_region(m_region);
-		std::cout << "ROM region specified as '" << m_region << "'\n";
-	}
+	extract_iscripts(rom_data, p_asm_filename, p_shop_comments);
+}
 
-	m_config.load_config_data(appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME, rom_data);
-	fi::load_iscript_opcodes_from_config(m_config.bmap_dense(fi::c::ID_ISCRIPT_OPCODES),
-		m_config.str_map(fi::c::ID_ISCRIPT_OPCODE_IMPLS));
+void fi::Cli::extract_iscripts(klib::RomView rom_data,
+	const std::string& p_asm_filename, bool p_shop_comments) {
+	const auto& opcodes{ load_iscript_opcodes().opcodes };
 
-	fi::IScriptLoader loader(rom_data);
+	fi::IScriptLoader loader(rom_data, opcodes);
 
-	std::cout << "Attempting to parse ROM scripting layer\n";
-	loader.parse_rom(m_config);
+	*m_out << "Attempting to parse ROM scripting layer\n";
+	{
+		klib::prof::Scope l_prof("disassemble iscripts");
+		loader.parse_rom(m_config, m_iscript_workers);
+		l_prof.count("instructions", loader.m_instructions.size());
+		l_prof.count("strings", loader.m_strings.size());
+		l_prof.count("entrypoints", loader.ptr_table.size());
+	}
 
-	std::cout << "Detected " << loader.ptr_table.size() << " script entrypoints\n";
+	*m_out << "Detected " << loader.ptr_table.size() << " script entrypoints\n";
 
-	fi::AsmWriter asmw;
+	fi::AsmWriter asmw(opcodes);
 
-	std::cout << "Generating output file " << p_asm_filename << "\n";
-	asmw.generate_asm_file(m_config, p_asm_filename,
+	*m_out << "Generating output file " << p_asm_filename << "\n";
+	klib::prof::Scope l_prof("generate iscript asm");
+	if (!asmw.generate_asm_file(m_config, p_asm_filename,
 		loader.m_instructions, loader.ptr_table, loader.m_jump_targets,
-		loader.m_strings, loader.m_shops, m_shop_comments);
+		loader.m_strings, loader.m_shops, p_shop_comments))
+		*m_out << "Output file unchanged\n";
 
-	std::cout << "Extraction complete!\n";
+	*m_out << "Extraction complete!\n";
 }
 
 void fi::Cli::nes_to_basm(const std::string& p_nes_filename,
@@ -491,76 +1279,76 @@ void fi::Cli::nes_to_basm(const std::string& p_nes_filename,
 
 	// show params
 	if (p_overwrite)
-		std::cout << "Will overwrite output assembly file if it already exists\n";
+		*m_out << "Will overwrite output assembly file if it already exists\n";
 
 	// fail early if asm file already exists and we do not overwrite
 	if (!p_overwrite && klib::file::file_exists(p_basm_filename))
 		throw std::runtime_error(std::format("Assembly file {} exists, and overwrite-flag is not set", p_basm_filename));
 
-	std::cout << "Attempting to read " << p_nes_filename << "\n";
-	const auto rom_data{ klib::file::read_file_as_bytes(p_nes_filename) };
+	const auto rom_file{ map_rom_and_determine_region(p_nes_filename) };
+	const klib::RomView rom_data{ rom_file.bytes() };
 
-	if (m_region.empty()) {
-		m_config.determine_region(rom_data);
-		std::cout << "ROM region resolved to '" << m_config.get_region() << "'\n";
-	}
-	else {
-		m_config.set_region(m_region);
-		std::cout << "ROM region specified as '" << m_region << "'\n";
-	}
-
-	m_config.load_config_data(appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME, rom_data);
+	extract_bscripts(rom_data, p_basm_filename);
+}
 
+void fi::Cli::extract_bscripts(klib::RomView rom_data,
+	const std::string& p_basm_filename) {
 	fb::BScriptLoader loader(m_config, rom_data);
 
-	std::cout << "Attempting to parse ROM behavior script layer\n";
-	loader.parse_rom();
+	*m_out << "Attempting to parse ROM behavior script layer\n";
+	{
+		klib::prof::Scope l_prof("disassemble bscripts");
+		loader.parse_rom();
+		l_prof.count("instructions", loader.m_instrs.size());
+	}
 
 	fb::BScriptWriter asmw(m_config);
 
-	std::cout << "Generating output file " << p_basm_filename << "\n";
-	asmw.write_asm(p_basm_filename, loader);
+	*m_out << "Generating output file " << p_basm_filename << "\n";
+	klib::prof::Scope l_prof("generate bscript asm");
+	if (!asmw.write_asm(p_basm_filename, loader))
+		*m_out << "Output file unchanged\n";
 
-	std::cout << "Extraction complete!\n";
+	*m_out << "Extraction complete!\n";
 }
 
 void fi::Cli::nes_to_masm(const std::string& p_nes_filename,
 	const std::string& p_mml_filename, bool p_overwrite) {
 
-	std::cout << std::format("Note value emission {}\n",
+	*m_out << std::format("Note value emission {}\n",
 		m_notes ? "enabled" : "disabled");
 
 	// fail early if output file already exists and we do not overwrite
 	if (!p_overwrite && klib::file::file_exists(p_mml_filename))
 		throw std::runtime_error(std::format("music asm file {} exists, and overwrite-flag is not set", p_mml_filename));
 
-	std::cout << "Attempting to read " << p_nes_filename << "\n";
-	const auto& rom_data{ klib::file::read_file_as_bytes(p_nes_filename) };
+	const auto rom_file{ map_rom_and_determine_region(p_nes_filename) };
+	const klib::RomView rom_data{ rom_file.bytes() };
 
-	if (m_region.empty()) {
-		m_config.determine_region(rom_data);
-		std::cout << "ROM region resolved to '" << m_config.get_region() << "'\n";
-	}
-	else {
-		m_config.set_region(m_region);
-		std::cout << "ROM region specified as '" << m_region << "'\n";
-	}
-
-	m_config.load_config_data(appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME, rom_data);
+	extract_mscripts(rom_data, p_mml_filename);
+}
 
+void fi::Cli::extract_mscripts(klib::RomView rom_data,
+	const std::string& p_mml_filename) {
 	fm::MScriptLoader loader(m_config, rom_data);
-	loader.parse_rom();
+	{
+		klib::prof::Scope l_prof("disassemble mscripts");
+		loader.parse_rom();
+		l_prof.count("instructions", loader.m_instrs.size());
+	}
 
-	std::cout << "Detected " << loader.get_song_count() << " music tracks\n";
+	*m_out << "Detected " << loader.get_song_count() << " music tracks\n";
 
+	klib::prof::Scope l_prof("generate mscript asm");
 	fm::MMLWriter l_writer(m_config);
-	l_writer.generate_mml_file(m_out_file, loader.m_instrs, loader.m_opcodes,
+	if (!l_writer.generate_mml_file(p_mml_filename, loader.m_instrs, loader.m_opcodes,
 		loader.m_ptr_table,
 		loader.m_jump_targets,
 		loader.m_chan_pitch_offsets,
-		m_notes);
+		m_notes))
+		*m_out << "Output file unchanged\n";
 
-	std::cout << "Extraction complete!\n";
+	*m_out << "Extraction complete!\n";
 }
 
 void fi::Cli::nes_to_misc(const std::string& p_nes_filename,
@@ -568,19 +1356,27 @@ void fi::Cli::nes_to_misc(const std::string& p_nes_filename,
 	bool p_overwrite) {
 
 	if (m_strict)
-		std::cout << "Will output misc data for all sprites (not only enemies and bosses)\n";
+		*m_out << "Will output misc data for all sprites (not only enemies and bosses)\n";
 
 	// fail early if output file already exists and we do not overwrite
 	if (!p_overwrite && klib::file::file_exists(p_txt_filename))
 		throw std::runtime_error(std::format("txt file {} exists, and overwrite-flag is not set", p_txt_filename));
 
-	const auto rom_data{ load_rom_and_determine_region(p_nes_filename) };
+	const auto rom_file{ map_rom_and_determine_region(p_nes_filename) };
+	const klib::RomView rom_data{ rom_file.bytes() };
 
+	extract_misc(rom_data, p_txt_filename);
+}
+
+void fi::Cli::extract_misc(klib::RomView rom_data,
+	const std::string& p_txt_filename) {
+	klib::prof::Scope l_prof("extract misc data");
 	fv::MiscWriter writer(rom_data, m_config, m_strict);
 	writer.load_rom(rom_data, m_config);
-	writer.write_txt_file(p_txt_filename);
-
-	std::cout << std::format("Extraction to {} complete!\n", p_txt_filename);
+	if (writer.write_txt_file(p_txt_filename))
+		*m_out << std::format("Extraction to {} complete!\n", p_txt_filename);
+	else
+		*m_out << std::format("Extraction to {} complete! (unchanged)\n", p_txt_filename);
 }
 
 void fi::Cli::nes_to_mml(const std::string& p_nes_filename,
@@ -591,15 +1387,25 @@ void fi::Cli::nes_to_mml(const std::string& p_nes_filename,
 	if (!p_overwrite && klib::file::file_exists(p_mml_filename))
 		throw std::runtime_error(std::format("mml file {} exists, and overwrite-flag is not set", p_mml_filename));
 
-	auto rom_data{ load_rom_and_determine_region(p_nes_filename) };
+	const auto rom_file{ map_rom_and_determine_region(p_nes_filename) };
+	const klib::RomView rom_data{ rom_file.bytes() };
+
+	extract_mml(rom_data, p_mml_filename);
+}
+
+void fi::Cli::extract_mml(klib::RomView rom_data,
+	const std::string& p_mml_filename) {
+	klib::prof::Scope l_prof("extract mml");
 	fm::MScriptLoader loader(m_config, rom_data);
 
 	fm::MMLSongCollection coll(get_global_transpose(rom_data));
 	coll.extract_bytecode_collection(loader);
+	l_prof.count("songs", coll.songs.size());
 
-	klib::file::write_string_to_file(coll.to_string(), p_mml_filename);
-
-	std::cout << "MML extracted to " << p_mml_filename << "!\n";
+	if (klib::file::write_string_to_file(coll.to_string(), p_mml_filename))
+		*m_out << "MML extracted to " << p_mml_filename << "!\n";
+	else
+		*m_out << "MML extracted to " << p_mml_filename << "! (unchanged)\n";
 }
 
 void fi::Cli::mml_to_nes(const std::string& p_mml_filename,
@@ -607,27 +1413,34 @@ void fi::Cli::mml_to_nes(const std::string& p_mml_filename,
 	const std::string& p_source_rom_filename) {
 
 	auto rom{ load_rom_and_determine_region(p_source_rom_filename) };
+
+	patch_mml(rom, p_mml_filename);
+
+	write_rom_file(rom, p_nes_filename);
+}
+
+void fi::Cli::patch_mml(klib::RomImage& rom, const std::string& p_mml_filename) {
 	auto coll{ load_mml_file(p_mml_filename) };
 
+	klib::prof::Scope l_prof("compile mml");
 	auto bytes{ coll.to_bytecode(m_config) };
+	l_prof.count("songs", coll.songs.size());
+	l_prof.count("bytes", bytes.size());
 
 	const auto& musicptr{ m_config.pointer(fm::c::ID_MUSIC_PTR) };
 
 	try_patch_msg("Music", bytes.size(),
 		m_config.constant(fm::c::ID_MUSIC_DATA_END) - musicptr.first);
 
-	for (std::size_t i{ 0 }; i < bytes.size(); ++i)
-		rom.at(musicptr.first + i) = bytes[i];
-
-	std::cout << "Attempting to patch file " << p_nes_filename << "\n";
-	klib::file::write_bytes_to_file(rom, p_nes_filename);
-	std::cout << "File patched\n";
+	if (!m_check)
+		klib::patch::write(rom, musicptr.first, bytes);
 }
 
 void fi::Cli::rom_to_midi(const std::string& p_nes_filename,
 	const std::string& p_out_file_prefix) {
 
-	auto rom_data{ load_rom_and_determine_region(p_nes_filename) };
+	const auto rom_file{ map_rom_and_determine_region(p_nes_filename) };
+	const klib::RomView rom_data{ rom_file.bytes() };
 	fm::MScriptLoader loader(m_config, rom_data);
 	fm::MMLSongCollection coll(get_global_transpose(rom_data));
 	coll.extract_bytecode_collection(loader);
@@ -643,7 +1456,8 @@ void fi::Cli::mml_to_midi(const std::string& p_mml_filename,
 void fi::Cli::rom_to_lilypond(const std::string& p_nes_filename,
 	const std::string& p_out_file_prefix) {
 
-	auto rom_data{ load_rom_and_determine_region(p_nes_filename) };
+	const auto rom_file{ map_rom_and_determine_region(p_nes_filename) };
+	const klib::RomView rom_data{ rom_file.bytes() };
 	fm::MScriptLoader loader(m_config, rom_data);
 	fm::MMLSongCollection coll(get_global_transpose(rom_data));
 	coll.extract_bytecode_collection(loader);
@@ -658,39 +1472,43 @@ void fi::Cli::mml_to_lilypond(const std::string& p_mml_filename,
 
 void fi::Cli::save_midi_files(fm::MMLSongCollection& coll,
 	const std::string& p_out_file_prefix) const {
-	std::cout << "Attempting to write midi files...\n";
+	*m_out << "Attempting to write midi files...\n";
 
 	auto midis{ coll.to_midi() };
 
 	for (std::size_t i{ 0 }; i < midis.size(); ++i) {
 		std::string l_filename{ std::format("{}-{:02}.mid", p_out_file_prefix, i + 1) };
 		midis[i].write(l_filename);
-		std::cout << "Wrote " << l_filename << "!\n";
+		*m_out << "Wrote " << l_filename << "!\n";
 	}
 }
 
 void fi::Cli::save_lilypond_files(fm::MMLSongCollection& coll,
 	const std::string& p_out_file_prefix) const {
-	std::cout << std::format("LilyPond percussion staff {}\n\n",
+	*m_out << std::format("LilyPond percussion staff {}\n\n",
 		m_lilypond_percussion ? "enabled" : "disabled");
 
-	std::cout << "Attempting to write LilyPond files...\n";
+	*m_out << "Attempting to write LilyPond files...\n";
 
 	auto lps{ coll.to_lilypond(m_lilypond_percussion) };
 
 	for (std::size_t i{ 0 }; i < lps.size(); ++i) {
 		std::string l_filename{ std::format("{}-{:02}.ly", p_out_file_prefix, i + 1) };
-		klib::file::write_string_to_file(lps[i], l_filename);
-		std::cout << "Wrote " << l_filename << "!\n";
+		if (klib::file::write_string_to_file(lps[i], l_filename))
+			*m_out << "Wrote " << l_filename << "!\n";
+		else
+			*m_out << l_filename << " unchanged\n";
 	}
 }
 
 void fi::Cli::dump_config(const std::string& p_nes_filename,
 	const std::string& p_dump_filename) {
-	const auto rom_data{ load_rom_and_determine_region(p_nes_filename) };
+	const auto rom_file{ map_rom_and_determine_region(p_nes_filename) };
 
-	klib::file::write_string_to_file(m_config.to_string(), p_dump_filename);
-	std::cout << "Wrote resolved configuration dump to " << p_dump_filename << "!\n";
+	if (klib::file::write_string_to_file(m_config.to_string(), p_dump_filename))
+		*m_out << "Wrote resolved configuration dump to " << p_dump_filename << "!\n";
+	else
+		*m_out << "Resolved configuration dump " << p_dump_filename << " unchanged\n";
 }
 
 void fi::Cli::parse_arguments(int arg_start, int argc, char** argv) {
@@ -710,33 +1528,164 @@ void fi::Cli::parse_arguments(int arg_start, int argc, char** argv) {
 			else
 				m_region = argv[++i];
 		}
+		else if (argvi == appc::CLI_PROFILE_JSON.first ||
+			argvi == appc::CLI_PROFILE_JSON.second) {
+			if (i + 1 >= argc)
+				throw std::runtime_error("Profile JSON option was used, but no output file was specified");
+			else
+				m_profile_json = argv[++i];
+		}
+		else if (argvi == appc::CLI_PATCH_OUT.first ||
+			argvi == appc::CLI_PATCH_OUT.second) {
+			if (i + 1 >= argc)
+				throw std::runtime_error("Patch output option was used, but no patch file was specified");
+			else
+				m_patch_file = argv[++i];
+
+			const auto l_extension{ klib::str::to_lower(std::filesystem::path(m_patch_file).extension().string()) };
+			if (l_extension != ".ips" && l_extension != ".bps")
+				throw std::runtime_error(std::format("Patch file {} must have the extension .ips or .bps", m_patch_file));
+		}
+		else if (argvi == appc::CLI_TRACE.first ||
+			argvi == appc::CLI_TRACE.second) {
+			if (i + 1 >= argc)
+				throw std::runtime_error("Trace option was used, but no output file was specified");
+			else
+				m_trace_file = argv[++i];
+		}
 		else
 			set_flag(argvi);
 	}
 }
 
-std::vector<byte> fi::Cli::load_rom_and_determine_region(
+klib::file::MappedFile fi::Cli::map_rom_and_determine_region(
+	const std::string& p_nes_filename) {
+
+	*m_out << "Attempting to read " << p_nes_filename << "\n";
+	klib::file::MappedFile rom_file(p_nes_filename);
+
+	determine_region_and_load_config(rom_file.bytes());
+
+	return rom_file;
+}
+
+klib::RomImage fi::Cli::load_rom_and_determine_region(
 	const std::string& p_nes_filename) {
 
-	std::cout << "Attempting to read " << p_nes_filename << "\n";
-	const auto rom_data{ klib::file::read_file_as_bytes(p_nes_filename) };
+	*m_out << "Attempting to read " << p_nes_filename << "\n";
+	auto result{ klib::file::map_rom_image(p_nes_filename) };
 
-	if (m_region.empty()) {
-		m_config.determine_region(rom_data);
-		std::cout << "ROM region resolved to '" << m_config.get_region() << "'\n";
+	determine_region_and_load_config(result);
+	start_journal(result, p_nes_filename);
+
+	return result;
+}
+
+void fi::Cli::start_journal(const klib::RomImage& p_rom, const std::string& p_filename) {
+	m_journal.clear();
+	m_journal_base = klib::file::is_stdio(p_filename) ? std::string() : p_filename;
+
+	if (m_patch_file.empty())
+		m_patch_source.reset();
+	// builds write to the image itself, so patches are made against a second
+	// mapping that is never written to; stdin can only be read once, so it is copied
+	else if (klib::file::is_stdio(p_filename))
+		m_patch_source = std::make_shared<const klib::RomImage>(p_rom);
+	else
+		m_patch_source = std::make_shared<const klib::RomImage>(klib::file::map_rom_image(p_filename));
+}
+
+void fi::Cli::determine_region_and_load_config(klib::RomView p_rom) {
+	{
+		klib::prof::Scope l_prof("region detection");
+
+		if (m_region.empty()) {
+			m_config.determine_region(p_rom);
+			*m_out << "ROM region resolved to '" << m_config.get_region() << "'\n";
+		}
+		else {
+			m_config.set_region(m_region);
+			*m_out << "ROM region specified as '" << m_region << "'\n";
+		}
 	}
-	else {
-		m_config.set_region(m_region);
-		std::cout << "ROM region specified as '" << m_region << "'\n";
+
+	klib::prof::Scope l_prof("load config data");
+	m_config.load_config_data(appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME, p_rom);
+}
+
+void fi::Cli::write_rom_file(const klib::RomImage& p_rom, const std::string& p_nes_filename) const {
+	*m_out << "Attempting to patch file " << p_nes_filename << "\n";
+
+	if (save_rom(p_rom, p_nes_filename))
+		*m_out << (m_patch_file.empty() ? "File patched\n" : "Patch file written\n");
+	else
+		*m_out << (m_patch_file.empty() ? "File unchanged\n" : "Patch file unchanged\n");
+}
+
+bool fi::Cli::save_rom(const klib::RomImage& p_rom, const std::string& p_nes_filename) const {
+	if (m_patch_file.empty()) {
+		std::error_code ec;
+
+		// the file the image was mapped from only differs from it in the journaled ranges
+		if (!m_journal_base.empty() && !klib::file::is_stdio(p_nes_filename) &&
+			std::filesystem::equivalent(m_journal_base, p_nes_filename, ec))
+			return klib::file::write_ranges_to_file(p_rom.bytes(), m_journal.ranges(), p_nes_filename);
+		else
+			return klib::file::write_bytes_to_file(p_rom.bytes(), p_nes_filename);
 	}
 
-	m_config.load_config_data(appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME, rom_data);
+	klib::prof::Scope l_prof("create patch", m_patch_file);
+	l_prof.count("journaled bytes", m_journal.size());
+
+	const bool l_ips{ klib::str::to_lower(
+		std::filesystem::path(m_patch_file).extension().string()) == ".ips" };
+	const auto l_patch{ l_ips ?
+		klib::patch::create_ips(m_patch_source->bytes(), p_rom.bytes(), m_journal) :
+		klib::patch::create_bps(m_patch_source->bytes(), p_rom.bytes(), m_journal) };
+	l_prof.count("bytes", l_patch.size());
 
-	return rom_data;
+	*m_out << std::format("Writing {} patch {} ({} bytes, {} bytes journaled) instead of {}\n",
+		l_ips ? "IPS" : "BPS", m_patch_file, l_patch.size(), m_journal.size(), p_nes_filename);
+
+	return klib::file::write_bytes_to_file(l_patch, m_patch_file);
+}
+
+void fi::Cli::reload_config(klib::RomView p_rom) {
+	// a failed reload keeps the configuration we had
+	const fe::Config l_config{ m_config };
+	auto l_iscript_opcode_info{ std::move(m_iscript_opcode_info) };
+
+	m_config.clear();
+	m_iscript_opcode_info.reset();
+
+	try {
+		{
+			klib::prof::Scope l_prof("load region definitions");
+			m_config.load_definitions(appc::CONFIG_XML, appc::CONFIG_OVERRIDE_FILE_NAME);
+		}
+		determine_region_and_load_config(p_rom);
+	}
+	catch (const std::exception&) {
+		m_config = l_config;
+		m_iscript_opcode_info = std::move(l_iscript_opcode_info);
+		throw;
+	}
+}
+
+const fi::ScriptOpcodeInfo& fi::Cli::load_iscript_opcodes(void) {
+	if (!m_iscript_opcode_info.has_value()) {
+		klib::prof::Scope l_prof("load opcode table");
+		m_iscript_opcode_info = fi::load_iscript_opcodes_from_config(
+			m_config.bmap_dense(fi::c::ID_ISCRIPT_OPCODES),
+			m_config.str_map(fi::c::ID_ISCRIPT_OPCODE_IMPLS));
+		l_prof.count("opcodes", m_iscript_opcode_info.value().opcodes.size());
+	}
+
+	return m_iscript_opcode_info.value();
 }
 
 fm::MMLSongCollection fi::Cli::load_mml_file(const std::string& p_mml_file) const {
-	std::cout << "Attempting to parse mml file " << p_mml_file << "\n";
+	*m_out << "Attempting to parse mml file " << p_mml_file << "\n";
 
 	std::string mml_string;
 	{
@@ -746,72 +1695,129 @@ fm::MMLSongCollection fi::Cli::load_mml_file(const std::string& p_mml_file) cons
 			mml_string += std::format("{}\n", klib::str::strip_comment(str));
 	}
 
+	klib::prof::Scope l_tokenize_prof("tokenize mml");
 	fm::Tokenizer tokenizer(mml_string);
 	const auto tokens{ tokenizer.tokenize() };
+	l_tokenize_prof.count("bytes", mml_string.size());
+	l_tokenize_prof.count("tokens", tokens.size());
 
+	klib::prof::Scope l_parse_prof("parse mml");
 	fm::Parser parser(tokens);
 
 	auto coll{ parser.parse() };
 	coll.sort();
+	l_parse_prof.count("songs", coll.songs.size());
 
 	return coll;
 }
 
 void fi::Cli::set_mode(const std::string& p_mode) {
+	m_script_mode = get_mode(p_mode);
+}
+
+fi::ScriptMode fi::Cli::get_mode(const std::string& p_mode) const {
 	if (check_mode(p_mode, appc::CMD_BUILD)) {
-		m_script_mode = fi::ScriptMode::IScriptBuild;
+		return fi::ScriptMode::IScriptBuild;
 	}
 	else if (check_mode(p_mode, appc::CMD_EXTRACT)) {
-		m_script_mode = fi::ScriptMode::IScriptExtract;
+		return fi::ScriptMode::IScriptExtract;
 	}
 	else if (check_mode(p_mode, appc::CMD_BUILD_BSCRIPTS)) {
-		m_script_mode = fi::ScriptMode::BScriptBuild;
+		return fi::ScriptMode::BScriptBuild;
 	}
 	else if (check_mode(p_mode, appc::CMD_EXTRACT_BSCRIPTS)) {
-		m_script_mode = fi::ScriptMode::BScriptExtract;
+		return fi::ScriptMode::BScriptExtract;
 	}
 	else if (check_mode(p_mode, appc::CMD_BUILD_MUSIC)) {
-		m_script_mode = fi::ScriptMode::MScriptBuild;
+		return fi::ScriptMode::MScriptBuild;
 	}
 	else if (check_mode(p_mode, appc::CMD_EXTRACT_MUSIC)) {
-		m_script_mode = fi::ScriptMode::MScriptExtract;
+		return fi::ScriptMode::MScriptExtract;
 	}
 	else if (check_mode(p_mode, appc::CMD_BUILD_MML)) {
-		m_script_mode = fi::ScriptMode::MmlBuild;
+		return fi::ScriptMode::MmlBuild;
 	}
 	else if (check_mode(p_mode, appc::CMD_EXTRACT_MML)) {
-		m_script_mode = fi::ScriptMode::MmlExtract;
+		return fi::ScriptMode::MmlExtract;
 	}
 	else if (check_mode(p_mode, appc::CMD_MML_TO_MIDI)) {
-		m_script_mode = fi::ScriptMode::MmlToMidi;
+		return fi::ScriptMode::MmlToMidi;
 	}
 	else if (check_mode(p_mode, appc::CMD_ROM_TO_MIDI)) {
-		m_script_mode = fi::ScriptMode::RomToMidi;
+		return fi::ScriptMode::RomToMidi;
 	}
 	else if (check_mode(p_mode, appc::CMD_MML_TO_LILYPOND)) {
-		m_script_mode = fi::ScriptMode::MmlToLilyPond;
+		return fi::ScriptMode::MmlToLilyPond;
 	}
 	else if (check_mode(p_mode, appc::CMD_ROM_TO_LILYPOND)) {
-		m_script_mode = fi::ScriptMode::RomToLilyPond;
+		return fi::ScriptMode::RomToLilyPond;
 	}
 	else if (check_mode(p_mode, appc::CMD_BUILD_MISC)) {
-		m_script_mode = fi::ScriptMode::MiscBuild;
+		return fi::ScriptMode::MiscBuild;
 	}
 	else if (check_mode(p_mode, appc::CMD_EXTRACT_MISC)) {
-		m_script_mode = fi::ScriptMode::MiscExtract;
+		return fi::ScriptMode::MiscExtract;
 	}
 	else if (check_mode(p_mode, appc::CMD_DUMP_CONFIG)) {
-		m_script_mode = fi::ScriptMode::DumpConfig;
+		return fi::ScriptMode::DumpConfig;
+	}
+	else if (check_mode(p_mode, appc::CMD_EXTRACT_ALL)) {
+		return fi::ScriptMode::ExtractAll;
+	}
+	else if (check_mode(p_mode, appc::CMD_CORPUS)) {
+		return fi::ScriptMode::Corpus;
+	}
+	else if (check_mode(p_mode, appc::CMD_BATCH)) {
+		return fi::ScriptMode::Batch;
+	}
+	else if (check_mode(p_mode, appc::CMD_SERVE)) {
+		return fi::ScriptMode::Serve;
 	}
 	else throw std::runtime_error("Unknown commad " + p_mode);
 }
 
+// stdin can only be read once and stdout carries a single file, so '-' is only
+// accepted where the command reads one ROM or writes one file
+void fi::Cli::check_stdio_arguments(void) const {
+	const bool l_rom_input{ is_extract_mode(m_script_mode) ||
+		m_script_mode == fi::ScriptMode::DumpConfig ||
+		m_script_mode == fi::ScriptMode::ExtractAll ||
+		m_script_mode == fi::ScriptMode::RomToMidi ||
+		m_script_mode == fi::ScriptMode::RomToLilyPond };
+	const bool l_rom_output{ !m_watch && (is_build_mode(m_script_mode) ||
+		m_script_mode == fi::ScriptMode::Batch) };
+
+	if (klib::file::is_stdio(m_in_file) && !l_rom_input)
+		throw std::runtime_error("Standard input ('-') can not be used as the input file of this command");
+	else if (klib::file::is_stdio(m_out_file) && !l_rom_output &&
+		!is_extract_mode(m_script_mode) && m_script_mode != fi::ScriptMode::DumpConfig)
+		throw std::runtime_error("Standard output ('-') can not be used as the output file of this command");
+	else if (klib::file::is_stdio(m_source_rom) && !l_rom_output)
+		throw std::runtime_error("Standard input ('-') can not be used as the source ROM of this command");
+}
+
+bool fi::Cli::is_build_mode(fi::ScriptMode p_mode) const {
+	return p_mode == fi::ScriptMode::IScriptBuild ||
+		p_mode == fi::ScriptMode::BScriptBuild ||
+		p_mode == fi::ScriptMode::MScriptBuild ||
+		p_mode == fi::ScriptMode::MmlBuild ||
+		p_mode == fi::ScriptMode::MiscBuild;
+}
+
+bool fi::Cli::is_extract_mode(fi::ScriptMode p_mode) const {
+	return p_mode == fi::ScriptMode::IScriptExtract ||
+		p_mode == fi::ScriptMode::BScriptExtract ||
+		p_mode == fi::ScriptMode::MScriptExtract ||
+		p_mode == fi::ScriptMode::MmlExtract ||
+		p_mode == fi::ScriptMode::MiscExtract;
+}
+
 bool fi::Cli::check_mode(const std::string& p_mode,
-	const std::pair<std::string, std::string>& p_cmds) {
+	const std::pair<std::string, std::string>& p_cmds) const {
 	return (p_mode == p_cmds.first || p_mode == p_cmds.second);
 }
 
-std::vector<int> fi::Cli::get_global_transpose(const std::vector<byte>& p_rom) const {
+std::vector<int> fi::Cli::get_global_transpose(klib::RomView p_rom) const {
 	std::vector<int> result;
 
 	auto transp{ m_config.constant(fm::c::ID_CHAN_PITCH_OFFSET) };
@@ -845,12 +1851,52 @@ void fi::Cli::toggle_flag(std::size_t p_flag_idx) {
 		m_notes = !m_notes;
 	else if (p_flag_idx == 4)
 		m_lilypond_percussion = !m_lilypond_percussion;
+	else if (p_flag_idx == 5)
+		m_watch = !m_watch;
+	else if (p_flag_idx == 6)
+		m_profile = !m_profile;
+	else if (p_flag_idx == 7)
+		m_config_cache = !m_config_cache;
+	else if (p_flag_idx == 8)
+		m_check = !m_check;
+	else if (p_flag_idx == 9)
+		m_iscript_workers = m_iscript_workers > 1 ? 1 :
+		std::max(1u, std::thread::hardware_concurrency());
 }
 
-void fi::Cli::clear_rom_section(std::vector<byte>& rom,
+// per-user cache directory, or empty if none can be determined
+std::string fi::Cli::get_config_cache_dir(void) const {
+#ifdef _WIN32
+	const auto l_base_dir{ get_environment_variable("LOCALAPPDATA") };
+#else
+	auto l_base_dir{ get_environment_variable("XDG_CACHE_HOME") };
+	if (l_base_dir.empty()) {
+		const auto l_home_dir{ get_environment_variable("HOME") };
+		if (!l_home_dir.empty())
+			l_base_dir = (std::filesystem::path(l_home_dir) / ".cache").string();
+	}
+#endif
+
+	if (l_base_dir.empty())
+		return std::string();
+	else
+		return (std::filesystem::path(l_base_dir) / appc::CONFIG_CACHE_DIR).string();
+}
+
+void fi::Cli::clear_rom_section(klib::RomImage& rom,
 	std::size_t p_start, std::size_t p_end) const {
-	for (std::size_t i{ p_start }; i < p_end; ++i)
-		rom.at(i) = 0xff;
+	if (p_end > p_start)
+		klib::patch::fill(rom, p_start, p_end - p_start, 0xff);
+}
+
+void fi::Cli::duplicate_static_bank(klib::RomImage& rom) const {
+	if (!m_config.boolean_or(ID_DUPLICATE_STATIC_BANK, false))
+		return;
+
+	constexpr std::size_t BANK_BYTE_SIZE{ 0x4000 };
+	klib::patch::copy(rom, 0x10 + BANK_BYTE_SIZE * 0x0f, 0x10 + BANK_BYTE_SIZE * 0x1f, BANK_BYTE_SIZE);
+
+	*m_out << "Bank 15 was duplicated to bank 31 post-patch\n";
 }
 
 // sad that this is needed in 2026
@@ -861,7 +1907,7 @@ void fi::Cli::output_oe_on_windows(void) const {
 	SetConsoleOutputCP(CP_UTF8);
 #endif
 
-	std::cout << "ø";
+	*m_out << "ø";
 
 #ifdef _WIN32
 	SetConsoleOutputCP(old_cp);
@@ -1,9 +1,17 @@
 #ifndef FI_CLI_H
 #define FI_CLI_H
 
+#include <future>
+#include <memory>
+#include <optional>
+#include <ostream>
 #include <vector>
 #include <string>
 #include "./../../fe/Config.h"
+#include "./../../common/klib/Kfile.h"
+#include "./../../common/klib/Kpatch.h"
+#include "./../../common/klib/Krom.h"
+#include "./../Opcode.h"
 #include "./../../fm/song/MMLSongCollection.h"
 
 namespace fi {
@@ -15,19 +23,49 @@ namespace fi {
 		MScriptBuild, MScriptExtract,
 		BScriptBuild, BScriptExtract,
 		MiscBuild, MiscExtract,
-		DumpConfig
+		DumpConfig, ExtractAll, Corpus, Batch, Serve
+	};
+
+	// size report for a single data section patched into the ROM
+	struct PatchUsage {
+		std::string data_type;
+		std::size_t size, max_size;
+	};
+
+	// round-trip outcome for one ROM in corpus mode
+	struct CorpusResult {
+		std::string rom, region, error;
+		// one cell per extracted format
+		std::vector<std::string> stages;
 	};
 
 	class Cli {
 
 		fi::ScriptMode m_script_mode;
 
-		std::string m_in_file, m_out_file, m_source_rom, m_region;
+		std::string m_in_file, m_out_file, m_source_rom, m_region, m_profile_json,
+			m_trace_file, m_patch_file;
 		bool m_strict, m_shop_comments, m_overwrite, m_notes,
-			m_lilypond_percussion;
+			m_lilypond_percussion, m_watch, m_profile, m_config_cache, m_check;
+		// threads used to disassemble iScripts
+		std::size_t m_iscript_workers;
 		fe::Config m_config;
+		std::vector<fi::PatchUsage> m_patch_usage;
+		// ROM writes since the source image was loaded, and that image when making patches;
+		// the source image is shared by copies of this object, which only read it
+		klib::patch::Journal m_journal;
+		std::shared_ptr<const klib::RomImage> m_patch_source;
+		// the file that matches the working image outside the journaled ranges, if any
+		std::string m_journal_base;
+		std::optional<fi::ScriptOpcodeInfo> m_iscript_opcode_info;
+		// all diagnostics go here, so concurrent jobs can keep separate logs
+		std::ostream* m_out;
+		std::ostream* m_err;
 
 		void set_mode(const std::string& p_mode);
+		fi::ScriptMode get_mode(const std::string& p_mode) const;
+		bool is_build_mode(fi::ScriptMode p_mode) const;
+		bool is_extract_mode(fi::ScriptMode p_mode) const;
 		void toggle_flag(std::size_t p_flag_idx);
 		void set_flag(const std::string& p_flag);
 		void print_header(void) const;
@@ -36,38 +74,60 @@ namespace fi {
 
 		void output_oe_on_windows(void) const;
 
+		void execute(void);
+		void check_stdio_arguments(void) const;
+		void report_profile(void) const;
+		// reports and then drops the phases recorded so far, for commands that keep running
+		void flush_profile(void) const;
+
 		// main logic
+		void try_patch_msg(const std::string& p_data_type,
+			std::size_t p_data_size, std::size_t p_data_max_size);
 		void asm_to_nes(const std::string& p_asm_filename,
 			const std::string& p_nes_filename,
 			const std::string& p_source_rom_filename,
 			bool p_strict);
+		bool patch_iscripts(klib::RomImage& rom,
+			const std::string& p_asm_filename, bool p_strict);
 		void nes_to_asm(const std::string& p_nes_filename,
 			const std::string& p_asm_filename,
 			bool p_shop_comments, bool p_overwrite);
+		void extract_iscripts(klib::RomView rom_data,
+			const std::string& p_asm_filename, bool p_shop_comments);
 
 		// bscripts
 		void basm_to_nes(const std::string& p_basm_filename,
 			const std::string& p_nes_filename,
 			const std::string& p_source_rom_filename,
 			bool p_strict);
+		bool patch_bscripts(klib::RomImage& rom,
+			const std::string& p_basm_filename, bool p_strict);
 		void nes_to_basm(const std::string& p_nes_filename,
 			const std::string& p_basm_filename, bool p_overwrite);
+		void extract_bscripts(klib::RomView rom_data,
+			const std::string& p_basm_filename);
 
 		// music (asm)
 		void masm_to_nes(const std::string& p_mml_filename,
 			const std::string& p_nes_filename,
 			const std::string& p_source_rom_filename);
+		void patch_mscripts(klib::RomImage& rom, const std::string& p_mml_filename);
 		void nes_to_masm(const std::string& p_nes_filename,
 			const std::string& p_mml_filename,
 			bool p_overwrite);
+		void extract_mscripts(klib::RomView rom_data,
+			const std::string& p_mml_filename);
 
 		// music (mml)
 		void mml_to_nes(const std::string& p_mml_filename,
 			const std::string& p_nes_filename,
 			const std::string& p_source_rom_filename);
+		void patch_mml(klib::RomImage& rom, const std::string& p_mml_filename);
 		void nes_to_mml(const std::string& p_nes_filename,
 			const std::string& p_mml_filename,
 			bool p_overwrite);
+		void extract_mml(klib::RomView rom_data,
+			const std::string& p_mml_filename);
 
 		// to-midi
 		void rom_to_midi(const std::string& p_nes_filename,
@@ -85,25 +145,85 @@ namespace fi {
 		void misc_to_nes(const std::string& p_asm_filename,
 			const std::string& p_nes_filename,
 			const std::string& p_source_rom_filename);
+		int patch_misc(klib::RomImage& rom, const std::string& p_txt_filename);
 		void nes_to_misc(const std::string& p_nes_filename,
 			const std::string& p_txt_filename,
 			bool p_overwrite);
+		void extract_misc(klib::RomView rom_data,
+			const std::string& p_txt_filename);
+
+		// all extractions from one shared ROM image
+		void extract_all(const std::string& p_nes_filename,
+			const std::string& p_out_file_prefix, bool p_overwrite);
+		std::vector<std::future<std::string>> start_extraction(
+			klib::RomView p_rom_data, std::launch p_policy);
+
+		// corpus mode - round-trip every ROM in a directory on a worker pool
+		void corpus(const std::string& p_rom_directory,
+			const std::string& p_out_directory);
+		fi::CorpusResult run_corpus_job(const std::string& p_rom_filename,
+			const std::string& p_out_prefix);
+
+		// batch build - all stages patch the same in-memory ROM
+		void batch_to_nes(const std::string& p_manifest_filename,
+			const std::string& p_nes_filename,
+			const std::string& p_source_rom_filename);
+		std::vector<std::pair<fi::ScriptMode, std::string>> parse_batch_manifest(
+			const std::string& p_manifest_filename) const;
+		std::pair<std::string, std::string> parse_stage_command(const std::string& p_line) const;
+		bool run_build_stage(klib::RomImage& rom, fi::ScriptMode p_mode,
+			const std::string& p_filename);
+		void run_extract_stage(klib::RomView rom, fi::ScriptMode p_mode,
+			const std::string& p_filename);
+
+		// watch mode - rebuild a single stage against a cached source ROM on change
+		void watch_build(fi::ScriptMode p_mode,
+			const std::string& p_in_filename,
+			const std::string& p_nes_filename,
+			const std::string& p_source_rom_filename);
+
+		// check mode - parse, link and size-check a single stage, and report
+		// the result as JSON without writing any file
+		void check_build(fi::ScriptMode p_mode,
+			const std::string& p_in_filename,
+			const std::string& p_source_rom_filename);
+		std::string get_check_json(const std::string& p_filename,
+			const std::vector<std::string>& p_diagnostics) const;
+
+		// resident mode - serve build and extract requests from stdin
+		void serve(const std::string& p_source_rom_filename,
+			const std::string& p_nes_filename);
 
 		// debug
 		void dump_config(const std::string& p_nes_filename,
 			const std::string& p_dump_filename);
 
 		// common
-		std::vector<byte> load_rom_and_determine_region(const std::string& p_nes_filename);
+		// extraction reads the mapped file directly; builds patch a private copy of it
+		klib::file::MappedFile map_rom_and_determine_region(const std::string& p_nes_filename);
+		// the image is a copy-on-write mapping of the file
+		klib::RomImage load_rom_and_determine_region(const std::string& p_nes_filename);
+		void determine_region_and_load_config(klib::RomView p_rom);
+		// keeps the current configuration if the reload fails
+		void reload_config(klib::RomView p_rom);
+		// p_rom must not have been written to yet; it was loaded from p_filename
+		void start_journal(const klib::RomImage& p_rom, const std::string& p_filename);
+		// the whole image is replaced atomically; an identical ROM is left untouched
+		void write_rom_file(const klib::RomImage& p_rom, const std::string& p_nes_filename) const;
+		// writes the patch file instead if one was requested; false if the output was unchanged
+		bool save_rom(const klib::RomImage& p_rom, const std::string& p_nes_filename) const;
+		const fi::ScriptOpcodeInfo& load_iscript_opcodes(void);
 		fm::MMLSongCollection load_mml_file(const std::string& p_mml_file) const;
 		void save_midi_files(fm::MMLSongCollection& coll,
 			const std::string& p_out_file_prefix) const;
 		void save_lilypond_files(fm::MMLSongCollection& coll,
 			const std::string& p_out_file_prefix) const;
 		bool check_mode(const std::string& p_mode,
-			const std::pair<std::string, std::string>& p_cmds);
-		std::vector<int> get_global_transpose(const std::vector<byte>& p_rom) const;
-		void clear_rom_section(std::vector<byte>& rom, std::size_t p_start, std::size_t p_end) const;
+			const std::pair<std::string, std::string>& p_cmds) const;
+		std::vector<int> get_global_transpose(klib::RomView p_rom) const;
+		std::string get_config_cache_dir(void) const;
+		void clear_rom_section(klib::RomImage& rom, std::size_t p_start, std::size_t p_end) const;
+		void duplicate_static_bank(klib::RomImage& rom) const;
 
 	public:
 		Cli(int argc, char** argv);
@@ -14,6 +14,8 @@ namespace fi {
 		constexpr char APP_URL[]{ "https://github.com/kaimitai/FaxIScripts" };
 		constexpr char CONFIG_XML[]{ "eoe_config.xml" };
 		constexpr char CONFIG_OVERRIDE_FILE_NAME[]{ "eoe_config_override.xml" };
+		// subdirectory of the per-user cache directory
+		constexpr char CONFIG_CACHE_DIR[]{ "faxiscripts" };
 
 		inline const std::pair<std::string, std::string> CMD_EXTRACT{ "extract" , "x" };
 		inline const std::pair<std::string, std::string> CMD_BUILD{ "build" , "b" };
@@ -30,13 +32,30 @@ namespace fi {
 		inline const std::pair<std::string, std::string> CMD_EXTRACT_MISC{ "extract-misc" , "xmisc" };
 		inline const std::pair<std::string, std::string> CMD_BUILD_MISC{ "build-misc" , "bmisc" };
 		inline const std::pair<std::string, std::string> CMD_DUMP_CONFIG{ "dump-config" , "dc" };
+		inline const std::pair<std::string, std::string> CMD_EXTRACT_ALL{ "extract-all" , "xa" };
+		inline const std::pair<std::string, std::string> CMD_CORPUS{ "corpus" , "rt" };
+		inline const std::pair<std::string, std::string> CMD_BATCH{ "batch" , "bt" };
+		inline const std::pair<std::string, std::string> CMD_SERVE{ "serve" , "sv" };
+
+		// serve mode protocol
+		constexpr char SERVE_CMD_RELOAD[]{ "reload" };
+		constexpr char SERVE_CMD_QUIT[]{ "quit" };
+		constexpr char SERVE_RESPONSE_OK[]{ "@ok" };
+		constexpr char SERVE_RESPONSE_ERROR[]{ "@error" };
+		constexpr char SERVE_RESPONSE_USAGE[]{ "@usage" };
+		constexpr char SERVE_RESPONSE_LOG[]{ "@log" };
 
 		inline const std::vector<std::pair<std::string, std::string>> CLI_FLAGS{
 			{"--no-shop-comments", "-p"},
 			{"--original-size", "-o"},
 			{"--force", "-f"},
 			{"--no-notes", "-n"},
-			{"--lilypond-percussion", "-lp"}
+			{"--lilypond-percussion", "-lp"},
+			{"--watch", "-w"},
+			{"--profile", "-pf"},
+			{"--no-config-cache", "-nc"},
+			{"--check", "-c"},
+			{"--parallel", "-pl"}
 		};
 
 		inline const std::pair<std::string, std::string> CLI_SOURCE_ROM
@@ -45,6 +64,15 @@ namespace fi {
 		inline const std::pair<std::string, std::string> CLI_REGION
 		{ "--region", "-r" };
 
+		inline const std::pair<std::string, std::string> CLI_PROFILE_JSON
+		{ "--profile-json", "-pj" };
+
+		inline const std::pair<std::string, std::string> CLI_TRACE
+		{ "--trace", "-t" };
+
+		inline const std::pair<std::string, std::string> CLI_PATCH_OUT
+		{ "--patch-out", "-po" };
+
 	}
 }
 
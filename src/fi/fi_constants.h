@@ -5,6 +5,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include "./../fe/ConfigKey.h"
 
 using byte = unsigned char;
 
@@ -12,24 +13,24 @@ namespace fi {
 
 	namespace c {
 
-		constexpr char ID_ISCRIPT_OPCODES[]{ "iscript_opcodes" };
-		constexpr char ID_ISCRIPT_OPCODE_IMPLS[]{ "iscript_opcode_impls" };
-		constexpr char ID_ISCRIPT_PTR_LO[]{ "iscript_ptr_lo" };
-		constexpr char ID_ISCRIPT_MIN_COUNT[]{ "iscript_min_count" };
-		constexpr char ID_ISCRIPT_PTR_HI_REF_OFFSET[]{ "iscript_ptr_hi_ref_offset" };
-		constexpr char ID_ISCRIPT_RG1_END[]{ "iscript_data_rg1_end" };
-		constexpr char ID_ISCRIPT_RG2_START[]{ "iscript_data_rg2_start" };
-		constexpr char ID_ISCRIPT_RG2_END[]{ "iscript_data_rg2_end" };
-
-		constexpr char ID_STRING_DATA_START[]{ "string_data_start" };
-		constexpr char ID_STRING_DATA_END[]{ "string_data_end" };
-		constexpr char ID_STRING_CHAR_MAP[]{ "iscript_string_characters" };
-		constexpr char ID_STRING_RESERVED[]{ "reserved_script_string_indexes" };
-
-		constexpr char ID_DEFINES_TEXTBOX[]{ "defines_textbox" };
-		constexpr char ID_DEFINES_ITEM[]{ "defines_item" };
-		constexpr char ID_DEFINES_QUEST[]{ "defines_quest" };
-		constexpr char ID_DEFINES_RANK[]{ "defines_rank" };
+		inline const fe::ConfigKey ID_ISCRIPT_OPCODES{ "iscript_opcodes" };
+		inline const fe::ConfigKey ID_ISCRIPT_OPCODE_IMPLS{ "iscript_opcode_impls" };
+		inline const fe::ConfigKey ID_ISCRIPT_PTR_LO{ "iscript_ptr_lo" };
+		inline const fe::ConfigKey ID_ISCRIPT_MIN_COUNT{ "iscript_min_count" };
+		inline const fe::ConfigKey ID_ISCRIPT_PTR_HI_REF_OFFSET{ "iscript_ptr_hi_ref_offset" };
+		inline const fe::ConfigKey ID_ISCRIPT_RG1_END{ "iscript_data_rg1_end" };
+		inline const fe::ConfigKey ID_ISCRIPT_RG2_START{ "iscript_data_rg2_start" };
+		inline const fe::ConfigKey ID_ISCRIPT_RG2_END{ "iscript_data_rg2_end" };
+
+		inline const fe::ConfigKey ID_STRING_DATA_START{ "string_data_start" };
+		inline const fe::ConfigKey ID_STRING_DATA_END{ "string_data_end" };
+		inline const fe::ConfigKey ID_STRING_CHAR_MAP{ "iscript_string_characters" };
+		inline const fe::ConfigKey ID_STRING_RESERVED{ "reserved_script_string_indexes" };
+
+		inline const fe::ConfigKey ID_DEFINES_TEXTBOX{ "defines_textbox" };
+		inline const fe::ConfigKey ID_DEFINES_ITEM{ "defines_item" };
+		inline const fe::ConfigKey ID_DEFINES_QUEST{ "defines_quest" };
+		inline const fe::ConfigKey ID_DEFINES_RANK{ "defines_rank" };
 
 		constexpr char SECTION_DEFINES[]{ "[defines]" };
 		constexpr char SECTION_STRINGS[]{ "[reserved_strings]" };
@@ -16,7 +16,7 @@ fm::MMLWriter::MMLWriter(const fe::Config& p_config) {
 		p_config.bmap(c::ID_DEFINES_ENVELOPE)));
 }
 
-void fm::MMLWriter::generate_mml_file(const std::string& p_filename,
+bool fm::MMLWriter::generate_mml_file(const std::string& p_filename,
 	const std::map<std::size_t, fm::MusicInstruction>& p_instructions,
 	const std::map<byte, fm::MusicOpcode>& p_opcodes,
 	const std::vector<std::size_t>& p_entrypoints,
@@ -156,7 +156,7 @@ void fm::MMLWriter::generate_mml_file(const std::string& p_filename,
 		}
 	}
 
-	klib::file::write_string_to_file(af, p_filename);
+	return klib::file::write_string_to_file(af, p_filename);
 }
 
 
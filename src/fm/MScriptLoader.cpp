@@ -1,9 +1,10 @@
 #include "MScriptLoader.h"
 #include "fm_constants.h"
 #include "fm_util.h"
+#include "./../common/klib/Kprofile.h"
 
 fm::MScriptLoader::MScriptLoader(const fe::Config& p_config,
-	const std::vector<byte>& p_rom) :
+	klib::RomView p_rom) :
 	m_rom{ p_rom },
 	m_music_ptr{ p_config.pointer(c::ID_MUSIC_PTR) },
 	m_music_count{ 4 * fm::util::get_music_count(p_config, p_rom) },
@@ -28,8 +29,11 @@ fm::MScriptLoader::MScriptLoader(const fe::Config& p_config,
 void fm::MScriptLoader::parse_rom(void) {
 	clear_parsed_data();
 
-	for (std::size_t ep : m_ptr_table)
-		parse_blob_from_entrypoint(ep, m_music_ptr.second);
+	for (std::size_t i{ 0 }; i < m_ptr_table.size(); ++i) {
+		klib::prof::Scope l_prof("MScriptLoader::parse_blob_from_entrypoint");
+		l_prof.detail("song {} channel {}", i / 4 + 1, i % 4);
+		parse_blob_from_entrypoint(m_ptr_table[i], m_music_ptr.second);
+	}
 }
 
 void fm::MScriptLoader::parse_channel(std::size_t p_song_no, std::size_t p_chan_no) {
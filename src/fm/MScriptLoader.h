@@ -6,6 +6,7 @@
 #include <set>
 #include <vector>
 #include "./../fe/Config.h"
+#include "./../common/klib/Krom.h"
 #include "MusicOpcode.h"
 
 using byte = unsigned char;
@@ -19,7 +20,7 @@ namespace fm {
 		// TODO: Change visibility
 	public:
 
-		const std::vector<byte> m_rom;
+		const klib::RomView m_rom;
 		std::vector<std::size_t> m_ptr_table;
 		std::map<byte, fm::MusicOpcode> m_opcodes;
 		std::map<std::size_t, fm::MusicInstruction> m_instrs;
@@ -34,7 +35,7 @@ namespace fm {
 		uint16_t read_short(std::size_t& offset) const;
 
 		MScriptLoader(const fe::Config& p_config,
-			const std::vector<byte>& p_rom);
+			klib::RomView p_rom);
 		void parse_rom(void);
 		void parse_channel(std::size_t p_song_no, std::size_t p_chan_no);
 
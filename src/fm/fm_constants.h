@@ -6,6 +6,7 @@
 #include <vector>
 #include <set>
 #include "./song/Fraction.h"
+#include "./../fe/ConfigKey.h"
 
 using byte = unsigned char;
 
@@ -13,16 +14,16 @@ namespace fm {
 
 	namespace c {
 
-		constexpr char ID_MUSIC_PTR[]{ "music_ptr" };
-		constexpr char ID_MUSIC_DATA_END[]{ "music_data_end" };
-		constexpr char ID_MSCRIPT_OPCODES[]{ "mscript_opcodes" };
-		constexpr char ID_CHAN_PITCH_OFFSET[]{ "music_channel_pitch_offset" };
+		inline const fe::ConfigKey ID_MUSIC_PTR{ "music_ptr" };
+		inline const fe::ConfigKey ID_MUSIC_DATA_END{ "music_data_end" };
+		inline const fe::ConfigKey ID_MSCRIPT_OPCODES{ "mscript_opcodes" };
+		inline const fe::ConfigKey ID_CHAN_PITCH_OFFSET{ "music_channel_pitch_offset" };
 
-		constexpr char ID_DEFINES_ENVELOPE[]{ "mscript_defines_env" };
+		inline const fe::ConfigKey ID_DEFINES_ENVELOPE{ "mscript_defines_env" };
 
-		constexpr char ID_MSCRIPT_START_OCTAVE[]{ "music_first_octave" };
-		constexpr char ID_MSCRIPT_START_NOTE[]{ "music_first_note" };
-		constexpr char ID_MSCRIPT_START_BYTE[]{ "music_first_byte_value" };
+		inline const fe::ConfigKey ID_MSCRIPT_START_OCTAVE{ "music_first_octave" };
+		inline const fe::ConfigKey ID_MSCRIPT_START_NOTE{ "music_first_note" };
+		inline const fe::ConfigKey ID_MSCRIPT_START_BYTE{ "music_first_byte_value" };
 
 		constexpr char ID_MSCRIPT_ENTRYPOINT[]{ ".song" };
 
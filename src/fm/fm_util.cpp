@@ -238,7 +238,7 @@ std::string fm::util::mml_arg_to_string(fm::MmlArgDomain p_domain,
 
 }
 
-std::size_t fm::util::get_music_count(const fe::Config& p_config, const std::vector<byte>& p_rom) {
+std::size_t fm::util::get_music_count(const fe::Config& p_config, klib::RomView p_rom) {
 	auto musicptr{ p_config.pointer(c::ID_MUSIC_PTR) };
 	std::size_t result{ 0 };
 	std::size_t lowest_target{ 0x10000 };
@@ -5,6 +5,7 @@
 #include <string>
 #include "./../fe/Config.h"
 #include "MusicOpcode.h"
+#include "./../common/klib/Krom.h"
 #include "./../common/klib/Kstring.h"
 #include "./song/mml_constants.h"
 
@@ -29,7 +30,7 @@ namespace fm {
 		std::string mml_arg_to_string(fm::MmlArgDomain p_domain,
 			int p_value);
 
-		std::size_t get_music_count(const fe::Config& p_config, const std::vector<byte>& p_rom);
+		std::size_t get_music_count(const fe::Config& p_config, klib::RomView p_rom);
 	}
 
 }
@@ -3,6 +3,7 @@
 #include "./../../fi/cli/application_constants.h"
 #include "mml_constants.h"
 #include "Fraction.h"
+#include "./../../common/klib/Kprofile.h"
 #include <format>
 
 fm::MMLSongCollection::MMLSongCollection(void) :
@@ -195,6 +196,9 @@ std::vector<byte> fm::MMLSongCollection::to_bytecode(const fe::Config& p_config)
 	for (std::size_t i{ 0 }; i < songs.size(); ++i)
 		for (std::size_t c{ 0 }; c < songs[i].channels.size(); ++c) {
 			try {
+				klib::prof::Scope l_prof("MMLChannel::to_bytecode");
+				l_prof.detail("song {} channel {}", i + 1, c);
+
 				auto c_instrs{ songs[i].channels[c].to_bytecode() };
 				ptr_table.push_back(c_instrs.entrypt_idx + instr_offset);
 
@@ -159,10 +159,9 @@ fm::MMLChannel fm::Parser::parse_channel(const std::string& name,
 			Token str = advance();
 
 			if (str.type != TokenType::String) {
-				throw std::runtime_error(
-					std::format("Invalid argument to directive {}: {} (line {} col {}",
-						t.text, str.text, t.line, t.column)
-				);
+				throw klib::str::ParseError(
+					std::format("Invalid argument to directive {}: {}", t.text, str.text),
+					t.line, t.column);
 
 
 			}
@@ -219,7 +218,7 @@ fm::MMLChannel fm::Parser::parse_channel(const std::string& name,
 
 		if (check(TokenType::Tie)) {
 			const auto& tietoken{ peek() };
-			throw std::runtime_error(std::format("Tie '&' cannot appear without a preceding note (line {} col {})", tietoken.line, tietoken.column));
+			throw klib::str::ParseError("Tie '&' cannot appear without a preceding note", tietoken.line, tietoken.column);
 		}
 
 		if (check(TokenType::LabelDef)) {
@@ -270,7 +269,7 @@ fm::MmlEvent fm::Parser::parse_identifier_event() {
 	if (idname == c::OPCODE_JSR) {
 		Token reflabel = advance();
 		if (reflabel.type != TokenType::LabelRef)
-			throw std::runtime_error(std::format("JSR not followed by label name (line {}, col {})", reflabel.line, reflabel.column));
+			throw klib::str::ParseError("JSR not followed by label name", reflabel.line, reflabel.column);
 
 		JSREvent ev;
 		ev.label_name = reflabel.text;
@@ -321,17 +320,16 @@ fm::MmlEvent fm::Parser::parse_identifier_event() {
 		return ev;
 	}
 
-	throw std::runtime_error(std::format("Unknown identifier {} (line {} col {})", idname, t.line, t.column));
+	throw klib::str::ParseError(std::format("Unknown identifier {}", idname), t.line, t.column);
 }
 
 int fm::Parser::consume_number(const std::string& p_label, int p_min, int p_max) {
 	Token tok = advance();
 
 	if (tok.type != TokenType::Number || tok.number < p_min || tok.number > p_max)
-		throw std::runtime_error(
-			std::format("Argument for {} must be a number between {} and {} (line {} col {})",
-				p_label, p_min, p_max, tok.line, tok.column)
-		);
+		throw klib::str::ParseError(
+			std::format("Argument for {} must be a number between {} and {}", p_label, p_min, p_max),
+			tok.line, tok.column);
 
 	return tok.number;
 }
@@ -527,11 +525,11 @@ fm::MmlEvent fm::Parser::parse_length_event(void) {
 		i++;
 
 	if (i == start)
-		throw std::runtime_error(std::format("Missing length after 'l' (line {} col {})", t.line, t.column));
+		throw klib::str::ParseError("Missing length after 'l'", t.line, t.column);
 
 	int length = std::stoi(s.substr(start, i - start));
 	if (length <= 0)
-		throw std::runtime_error(std::format("Default length must be > 0 (line {} col {})", t.line, t.column));
+		throw klib::str::ParseError("Default length must be > 0", t.line, t.column);
 
 	if (raw)
 		ev.raw = length;
@@ -593,7 +591,7 @@ std::size_t fm::Parser::find_loop_end_token(std::size_t p_index) const {
 	}
 
 	const auto& tok{ tokens.at(p_index) };
-	throw std::runtime_error(std::format("Matching end-loop token not found (line {} col {})", tok.line, tok.column));
+	throw klib::str::ParseError("Matching end-loop token not found", tok.line, tok.column);
 }
 
 fm::MmlEvent fm::Parser::parse_end_loop_or_pop_addr_event(void) {
@@ -701,8 +699,5 @@ fm::ChannelType fm::Parser::string_to_channel_type(const std::string& str) const
 void fm::Parser::validate_type(const Token& token,
 	fm::TokenType p_type) const {
 	if (token.type != p_type)
-		throw std::runtime_error(
-			std::format("Unexpected token at line {} col {}",
-				token.line, token.column)
-		);
+		throw klib::str::ParseError("Unexpected token", token.line, token.column);
 }
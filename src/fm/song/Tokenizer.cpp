@@ -3,6 +3,7 @@
 #include "Tokenizer.h"
 #include "mml_constants.h"
 #include "./../fm_util.h"
+#include "./../../common/klib/Kstring.h"
 
 fm::Tokenizer::Tokenizer(const std::string& p_str) :
 	text{ p_str },
@@ -217,7 +218,7 @@ fm::Token fm::Tokenizer::create_volume_set() {
 	tok.number = std::stoi(value.substr(1));
 
 	if (tok.number < 0 || tok.number > 15)
-		throw std::runtime_error(std::format("Volume must be in the range 0-15 (line {} col {})", tok.line, tok.column));
+		throw klib::str::ParseError("Volume must be in the range 0-15", tok.line, tok.column);
 
 	return tok;
 }
@@ -456,7 +457,7 @@ fm::Token fm::Tokenizer::create_song_transpose() {
 	// 2. verify that the next is _
 	char c = peek();
 	if (c != '_')
-		throw std::runtime_error(std::format("Song transpose command must start with s_ (line {} col {})", tok.line, tok.column));
+		throw klib::str::ParseError("Song transpose command must start with s_", tok.line, tok.column);
 
 	advance(); // consume _
 
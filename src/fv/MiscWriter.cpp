@@ -1,11 +1,12 @@
 #include "MiscWriter.h"
 #include "./../common/klib/Kfile.h"
+#include "./../common/klib/Kpatch.h"
 #include "./../common/klib/Kstring.h"
 #include "./../fi/cli/application_constants.h"
 #include "fv_constants.h"
 #include <format>
 
-fv::MiscWriter::MiscWriter(const std::vector<byte>& p_rom, const fe::Config& p_config,
+fv::MiscWriter::MiscWriter(klib::RomView p_rom, const fe::Config& p_config,
 	bool p_incl_all_sprites) :
 	title_screen_str_offset{ p_config.constant(c::ID_TITLE_STRING_OFFSET) },
 	title_screen_str_end_offset{ p_config.constant(c::ID_TITLE_STRING_END_OFFSET) },
@@ -49,7 +50,7 @@ fv::MiscWriter::MiscWriter(const std::vector<byte>& p_rom, const fe::Config& p_c
 
 	// generate reverse maps for patching purposes
 	title_screen_chars_rev = klib::str::invert_map(title_screen_chars);
-	iscript_chars_rev = klib::str::invert_map(iscript_chars);
+	iscript_chars_rev = p_config.bmap_reverse(c::ID_ISCRIPT_CHARS);
 	item_chars_rev = klib::str::invert_map(item_chars);
 	mantra_chars_rev = klib::str::invert_map(mantra_chars);
 
@@ -110,7 +111,7 @@ fv::MiscWriter::MiscWriter(const std::vector<byte>& p_rom, const fe::Config& p_c
 	};
 }
 
-void fv::MiscWriter::load_rom(const std::vector<byte>& p_rom, const fe::Config& p_config) {
+void fv::MiscWriter::load_rom(klib::RomView p_rom, const fe::Config& p_config) {
 
 	extract_title_screen_strings(p_rom);
 
@@ -167,7 +168,7 @@ void fv::MiscWriter::load_rom(const std::vector<byte>& p_rom, const fe::Config&
 		add_item(p_rom, p_config, fv::MiscCategory::WingBoots, fv::MiscField::Seconds, i);
 }
 
-int fv::MiscWriter::patch_rom(std::vector<byte>& p_rom, const fe::Config& p_config) {
+int fv::MiscWriter::patch_rom(klib::RomImage& p_rom, const fe::Config& p_config) {
 	int result{ 0 };
 
 	for (const auto& kv : items)
@@ -189,7 +190,7 @@ int fv::MiscWriter::patch_rom(std::vector<byte>& p_rom, const fe::Config& p_conf
 }
 
 // special case - encode all title screen strings at once - they are not really individually static
-int fv::MiscWriter::patch_title_strings(std::vector<byte>& p_rom) {
+int fv::MiscWriter::patch_title_strings(klib::RomImage& p_rom) {
 	int strcount{ 0 };
 	std::vector<byte> bytes;
 
@@ -224,14 +225,13 @@ int fv::MiscWriter::patch_title_strings(std::vector<byte>& p_rom) {
 		throw std::runtime_error(std::format("Title screen string byte size is {}, but can not exceed {} bytes",
 			bytes.size(), max_byte_len));
 	else {
-		for (std::size_t i{ 0 }; i < bytes.size(); ++i)
-			p_rom.at(i + title_screen_str_offset) = bytes[i];
+		klib::patch::write(p_rom, title_screen_str_offset, bytes);
 	}
 
 	return static_cast<int>(faxstrings.size());
 }
 
-void fv::MiscWriter::patch_item(std::vector<byte>& p_rom, const fe::Config& p_config,
+void fv::MiscWriter::patch_item(klib::RomImage& p_rom, const fe::Config& p_config,
 	fv::MiscCategory p_category, fv::MiscField p_field,
 	std::size_t p_index, const fv::MiscItem item) {
 
@@ -249,11 +249,14 @@ void fv::MiscWriter::patch_item(std::vector<byte>& p_rom, const fe::Config& p_co
 	std::size_t offset{ get_rom_offset(p_config, p_category, p_field, p_index) };
 	auto itemtype{ get_type(p_category, p_field) };
 
-	if (itemtype == fv::MiscType::Bit8 || itemtype == fv::MiscType::Binary8)
-		p_rom.at(offset) = static_cast<byte>(item.numeric_value);
+	if (itemtype == fv::MiscType::Bit8 || itemtype == fv::MiscType::Binary8) {
+		const byte bytes[]{ static_cast<byte>(item.numeric_value) };
+		klib::patch::write(p_rom, offset, bytes);
+	}
 	else if (itemtype == fv::MiscType::Bit16) {
-		p_rom.at(offset) = static_cast<byte>(item.numeric_value % 256);
-		p_rom.at(offset + 1) = static_cast<byte>(item.numeric_value / 256);
+		const byte bytes[]{ static_cast<byte>(item.numeric_value % 256),
+			static_cast<byte>(item.numeric_value / 256) };
+		klib::patch::write(p_rom, offset, bytes);
 	}
 	else {
 		// we have a string
@@ -274,12 +277,11 @@ void fv::MiscWriter::patch_item(std::vector<byte>& p_rom, const fe::Config& p_co
 				item.string_value.get_string(), ex.what()));
 		}
 
-		for (std::size_t i{ 0 }; i < strbytes.size(); ++i)
-			p_rom.at(offset + i) = strbytes[i];
+		klib::patch::write(p_rom, offset, strbytes);
 	}
 }
 
-void fv::MiscWriter::add_item(const std::vector<byte>& p_rom, const fe::Config& p_config,
+void fv::MiscWriter::add_item(klib::RomView p_rom, const fe::Config& p_config,
 	fv::MiscCategory p_category, fv::MiscField p_field,
 	std::size_t p_index) {
 	add_item(p_category, p_field, p_index,
@@ -458,7 +460,11 @@ std::string fv::MiscWriter::get_line_comment(fv::MiscCategory p_category, fv::Mi
 	return result;
 }
 
-void fv::MiscWriter::write_txt_file(const std::string& p_filename) const {
+bool fv::MiscWriter::write_txt_file(const std::string& p_filename) const {
+	return klib::file::write_string_to_file(get_txt_string(), p_filename);
+}
+
+std::string fv::MiscWriter::get_txt_string(void) const {
 	std::string txt{
 		std::format(" ; Faxanadu miscellaneous data file extracted by {} v{}\n ; {}\n",
 			fi::appc::APP_NAME, fi::appc::APP_VERSION, fi::appc::APP_URL)
@@ -479,7 +485,7 @@ void fv::MiscWriter::write_txt_file(const std::string& p_filename) const {
 		}
 	}
 
-	klib::file::write_string_to_file(txt, p_filename);
+	return txt;
 }
 
 std::size_t fv::MiscWriter::get_data_size(fv::MiscType misctype, std::size_t p_count) const {
@@ -497,7 +503,7 @@ std::size_t fv::MiscWriter::get_data_size(fv::MiscType misctype, std::size_t p_c
 	return base_byte_size * p_count;
 }
 
-fv::MiscItem fv::MiscWriter::read_misc_item(const std::vector<byte>& p_rom, std::size_t p_offset,
+fv::MiscItem fv::MiscWriter::read_misc_item(klib::RomView p_rom, std::size_t p_offset,
 	fv::MiscType type) const {
 	int numeric_value{ 0 };
 	fi::FaxString string_value;
@@ -627,9 +633,9 @@ std::string fv::MiscWriter::to_value_string(fv::MiscType p_type, const fv::MiscI
 }
 
 // special case; variable length strings
-void fv::MiscWriter::extract_title_screen_strings(const std::vector<byte>& p_rom) {
-	auto cursor{ begin(p_rom) + title_screen_str_offset };
-	auto strings_end{ begin(p_rom) + title_screen_str_end_offset };
+void fv::MiscWriter::extract_title_screen_strings(klib::RomView p_rom) {
+	auto cursor{ p_rom.begin() + title_screen_str_offset };
+	auto strings_end{ p_rom.begin() + title_screen_str_end_offset };
 	std::vector<fi::FaxString> faxstrings;
 
 	while (true) {
@@ -638,7 +644,7 @@ void fv::MiscWriter::extract_title_screen_strings(const std::vector<byte>& p_rom
 			break;
 		else {
 			std::size_t stringlength{ static_cast<std::size_t>(iter - cursor) };
-			faxstrings.push_back(extract_fax_string(p_rom, cursor - begin(p_rom), title_screen_chars, stringlength,
+			faxstrings.push_back(extract_fax_string(p_rom, cursor - p_rom.begin(), title_screen_chars, stringlength,
 				false, false, 0x00));
 			cursor = iter + 1;
 		}
@@ -652,7 +658,7 @@ void fv::MiscWriter::extract_title_screen_strings(const std::vector<byte>& p_rom
 		add_item(fv::MiscCategory::TitleString, fv::MiscField::Text, i, fv::MiscItem(0, faxstrings[i]));
 }
 
-fi::FaxString fv::MiscWriter::extract_fax_string(const std::vector<byte>& p_rom,
+fi::FaxString fv::MiscWriter::extract_fax_string(klib::RomView p_rom,
 	std::size_t p_offset,
 	const std::map<byte, std::string>& charmap,
 	std::size_t max_length,
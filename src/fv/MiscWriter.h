@@ -8,6 +8,7 @@
 #include <vector>
 #include "./../fe/Config.h"
 #include "./../fi/FaxString.h"
+#include "./../common/klib/Krom.h"
 
 using byte = unsigned char;
 
@@ -53,11 +54,11 @@ namespace fv {
 			std::map<std::size_t, MiscItem>> items;
 		void add_item(fv::MiscCategory p_category, fv::MiscField p_field,
 			std::size_t p_index, const fv::MiscItem item);
-		void add_item(const std::vector<byte>& p_rom, const fe::Config& p_config,
+		void add_item(klib::RomView p_rom, const fe::Config& p_config,
 			fv::MiscCategory p_category, fv::MiscField p_field,
 			std::size_t p_index);
 
-		MiscItem read_misc_item(const std::vector<byte>& p_rom, std::size_t p_offset, fv::MiscType type) const;
+		MiscItem read_misc_item(klib::RomView p_rom, std::size_t p_offset, fv::MiscType type) const;
 		std::size_t get_rom_offset(const fe::Config& p_config,
 			fv::MiscCategory p_category, fv::MiscField p_field, std::size_t p_index) const;
 		std::size_t get_data_size(fv::MiscType misctype, std::size_t p_count) const;
@@ -71,10 +72,10 @@ namespace fv {
 			std::size_t p_index, const fv::MiscItem item) const;
 		std::string to_value_string(fv::MiscType, const fv::MiscItem item) const;
 
-		void patch_item(std::vector<byte>& p_rom, const fe::Config& p_config,
+		void patch_item(klib::RomImage& p_rom, const fe::Config& p_config,
 			fv::MiscCategory p_category, fv::MiscField p_field,
 			std::size_t p_index, const fv::MiscItem item);
-		int patch_title_strings(std::vector<byte>& p_rom);
+		int patch_title_strings(klib::RomImage& p_rom);
 
 		std::string get_magic_def_string(byte p_seed) const;
 		byte get_magic_defense(byte p_seed, byte p_weapon_no) const;
@@ -83,9 +84,9 @@ namespace fv {
 
 		byte get_istring_padding(void) const;
 
-		void extract_title_screen_strings(const std::vector<byte>& p_rom);
+		void extract_title_screen_strings(klib::RomView p_rom);
 
-		fi::FaxString extract_fax_string(const std::vector<byte>& p_rom,
+		fi::FaxString extract_fax_string(klib::RomView p_rom,
 			std::size_t p_offset,
 			const std::map<byte, std::string>& charmap,
 			std::size_t max_length,
@@ -101,13 +102,14 @@ namespace fv {
 		) const;
 
 	public:
-		MiscWriter(const std::vector<byte>& p_rom, const fe::Config& p_config,
+		MiscWriter(klib::RomView p_rom, const fe::Config& p_config,
 			bool p_incl_all_sprites = false);
-		void load_rom(const std::vector<byte>& p_rom, const fe::Config& p_config);
-		int patch_rom(std::vector<byte>& p_rom, const fe::Config& p_config);
+		void load_rom(klib::RomView p_rom, const fe::Config& p_config);
+		int patch_rom(klib::RomImage& p_rom, const fe::Config& p_config);
 
 		void load_txt_file(const std::string& p_txt_file);
-		void write_txt_file(const std::string& p_filename) const;
+		bool write_txt_file(const std::string& p_filename) const;
+		std::string get_txt_string(void) const;
 	};
 
 }
@@ -4,6 +4,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include "./../fe/ConfigKey.h"
 
 using byte = unsigned char;
 
@@ -12,48 +13,48 @@ namespace fv {
 	namespace c {
 
 		// xml identifiers
-		constexpr char ID_ISCRIPT_CHARS[]{ "iscript_string_characters" };
-		constexpr char ID_TITLE_STRING_OFFSET[]{ "title_string_offset" };
-		constexpr char ID_TITLE_STRING_END_OFFSET[]{ "title_string_end_offset" };
-		constexpr char ID_STATUS_STRING_COUNT[]{ "status_string_count" };
-		constexpr char ID_STATUS_STRING_OFFSET[]{ "status_string_offset" };
-		constexpr char ID_ITEM_STRING_COUNT[]{ "item_string_count" };
-		constexpr char ID_ITEM_STRING_OFFSET[]{ "item_string_offset" };
-		constexpr char ID_PASSWORD_STRING_COUNT[]{ "password_string_count" };
-		constexpr char ID_PASSWORD_STRING_OFFSET[]{ "password_string_offset" };
-
-		constexpr char ID_RANK_COUNT[]{ "rank_count" };
-		constexpr char ID_RANK_STRING_LENGTH[]{ "rank_string_length" };
-		constexpr char ID_RANK_STRING_OFFSET[]{ "rank_string_offset" };
-		constexpr char ID_RANK_DATA_OFFSET[]{ "rank_data_offset" };
-
-		constexpr char ID_SPRITE_COUNT[]{ "sprite_count" };
-		constexpr char ID_SPRITE_LABELS[]{ "sprite_labels" };
-		constexpr char ID_SPRITE_DROP_TABLE_OFFSET[]{ "sprite_drop_table_offset" };
-		constexpr char ID_SPRITE_DROP_TABLE_COUNT[]{ "sprite_drop_table_count" };
-		constexpr char ID_SPRITE_TYPE_OFFSET[]{ "sprite_type_offset" };
-		constexpr char ID_SPRITE_HP_OFFSET[]{ "sprite_hp_offset" };
-		constexpr char ID_SPRITE_HP_COUNT[]{ "sprite_hp_count" };
-		constexpr char ID_SPRITE_XP_OFFSET[]{ "sprite_xp_offset" };
-		constexpr char ID_SPRITE_XP_COUNT[]{ "sprite_xp_count" };
-		constexpr char ID_SPRITE_DROP_IDX_OFFSET[]{ "sprite_drop_idx_offset" };
-		constexpr char ID_SPRITE_DROP_IDX_COUNT[]{ "sprite_drop_idx_count" };
-		constexpr char ID_SPRITE_DAMAGE_OFFSET[]{ "sprite_damage_offset" };
-		constexpr char ID_SPRITE_DAMAGE_COUNT[]{ "sprite_damage_count" };
-		constexpr char ID_SPRITE_DEFENSE_OFFSET[]{ "sprite_defense_offset" };
-		constexpr char ID_SPRITE_DEFENSE_COUNT[]{ "sprite_defense_count" };
-
-		constexpr char ID_WEAPON_COUNT[]{ "weapon_count" };
-		constexpr char ID_MAGIC_COUNT[]{ "magic_count" };
-		constexpr char ID_ARMOR_COUNT[]{ "armor_count" };
-		constexpr char ID_WEAPON_DAMAGE_OFFSET[]{ "weapon_damage_offset" };
-		constexpr char ID_WEAPON_GLOVE_DAMAGE_OFFSET[]{ "weapon_glove_damage_offset" };
-		constexpr char ID_MAGIC_DAMAGE_OFFSET[]{ "magic_damage_offset" };
-		constexpr char ID_MAGIC_COST_OFFSET[]{ "magic_cost_offset" };
-		constexpr char ID_ARMOR_DEFENSE_OFFSET[]{ "armor_defense_offset" };
-
-		constexpr char ID_WING_BOOTS_TIME_COUNT[]{ "wing_boots_time_count" };
-		constexpr char ID_WING_BOOTS_TIME_OFFSET[]{ "wing_boots_time_offset" };
+		inline const fe::ConfigKey ID_ISCRIPT_CHARS{ "iscript_string_characters" };
+		inline const fe::ConfigKey ID_TITLE_STRING_OFFSET{ "title_string_offset" };
+		inline const fe::ConfigKey ID_TITLE_STRING_END_OFFSET{ "title_string_end_offset" };
+		inline const fe::ConfigKey ID_STATUS_STRING_COUNT{ "status_string_count" };
+		inline const fe::ConfigKey ID_STATUS_STRING_OFFSET{ "status_string_offset" };
+		inline const fe::ConfigKey ID_ITEM_STRING_COUNT{ "item_string_count" };
+		inline const fe::ConfigKey ID_ITEM_STRING_OFFSET{ "item_string_offset" };
+		inline const fe::ConfigKey ID_PASSWORD_STRING_COUNT{ "password_string_count" };
+		inline const fe::ConfigKey ID_PASSWORD_STRING_OFFSET{ "password_string_offset" };
+
+		inline const fe::ConfigKey ID_RANK_COUNT{ "rank_count" };
+		inline const fe::ConfigKey ID_RANK_STRING_LENGTH{ "rank_string_length" };
+		inline const fe::ConfigKey ID_RANK_STRING_OFFSET{ "rank_string_offset" };
+		inline const fe::ConfigKey ID_RANK_DATA_OFFSET{ "rank_data_offset" };
+
+		inline const fe::ConfigKey ID_SPRITE_COUNT{ "sprite_count" };
+		inline const fe::ConfigKey ID_SPRITE_LABELS{ "sprite_labels" };
+		inline const fe::ConfigKey ID_SPRITE_DROP_TABLE_OFFSET{ "sprite_drop_table_offset" };
+		inline const fe::ConfigKey ID_SPRITE_DROP_TABLE_COUNT{ "sprite_drop_table_count" };
+		inline const fe::ConfigKey ID_SPRITE_TYPE_OFFSET{ "sprite_type_offset" };
+		inline const fe::ConfigKey ID_SPRITE_HP_OFFSET{ "sprite_hp_offset" };
+		inline const fe::ConfigKey ID_SPRITE_HP_COUNT{ "sprite_hp_count" };
+		inline const fe::ConfigKey ID_SPRITE_XP_OFFSET{ "sprite_xp_offset" };
+		inline const fe::ConfigKey ID_SPRITE_XP_COUNT{ "sprite_xp_count" };
+		inline const fe::ConfigKey ID_SPRITE_DROP_IDX_OFFSET{ "sprite_drop_idx_offset" };
+		inline const fe::ConfigKey ID_SPRITE_DROP_IDX_COUNT{ "sprite_drop_idx_count" };
+		inline const fe::ConfigKey ID_SPRITE_DAMAGE_OFFSET{ "sprite_damage_offset" };
+		inline const fe::ConfigKey ID_SPRITE_DAMAGE_COUNT{ "sprite_damage_count" };
+		inline const fe::ConfigKey ID_SPRITE_DEFENSE_OFFSET{ "sprite_defense_offset" };
+		inline const fe::ConfigKey ID_SPRITE_DEFENSE_COUNT{ "sprite_defense_count" };
+
+		inline const fe::ConfigKey ID_WEAPON_COUNT{ "weapon_count" };
+		inline const fe::ConfigKey ID_MAGIC_COUNT{ "magic_count" };
+		inline const fe::ConfigKey ID_ARMOR_COUNT{ "armor_count" };
+		inline const fe::ConfigKey ID_WEAPON_DAMAGE_OFFSET{ "weapon_damage_offset" };
+		inline const fe::ConfigKey ID_WEAPON_GLOVE_DAMAGE_OFFSET{ "weapon_glove_damage_offset" };
+		inline const fe::ConfigKey ID_MAGIC_DAMAGE_OFFSET{ "magic_damage_offset" };
+		inline const fe::ConfigKey ID_MAGIC_COST_OFFSET{ "magic_cost_offset" };
+		inline const fe::ConfigKey ID_ARMOR_DEFENSE_OFFSET{ "armor_defense_offset" };
+
+		inline const fe::ConfigKey ID_WING_BOOTS_TIME_COUNT{ "wing_boots_time_count" };
+		inline const fe::ConfigKey ID_WING_BOOTS_TIME_OFFSET{ "wing_boots_time_offset" };
 
 		constexpr char CAT_TITLE_STRING[]{ "TitleString" };
 		constexpr char CAT_STATUS_STRING[]{ "StatusString" };